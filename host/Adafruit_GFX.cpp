@@ -0,0 +1,49 @@
+// ==================== Adafruit_GFX.cpp (host stand-in for the native build) ====================
+#include "Adafruit_GFX.h"
+
+void Adafruit_GFX::writeFillRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color)
+{
+  for (int16_t j = 0; j < h; ++j)
+    for (int16_t i = 0; i < w; ++i)
+      writePixel(x + i, y + j, color);
+}
+
+void Adafruit_GFX::setRotation(uint8_t r)
+{
+  rotation = r & 3;
+  const bool landscape = rotation & 1;
+  _width = landscape ? HEIGHT : WIDTH;
+  _height = landscape ? WIDTH : HEIGHT;
+}
+
+void Adafruit_GFX::fillRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color)
+{
+  startWrite();
+  writeFillRect(x, y, w, h, color);
+  endWrite();
+}
+
+size_t Adafruit_GFX::write(uint8_t c)
+{
+  if (!gfxFont || c < gfxFont->first || c > gfxFont->last)
+    return 1;
+  const GFXglyph &g = gfxFont->glyph[c - gfxFont->first];
+  const uint8_t *bits = gfxFont->bitmap + g.bitmapOffset;
+  uint8_t byte = 0;
+  int bit = 0;
+  startWrite();
+  for (int gy = 0; gy < g.height; ++gy)
+  {
+    for (int gx = 0; gx < g.width; ++gx, ++bit)
+    {
+      if ((bit & 7) == 0)
+        byte = bits[bit >> 3];
+      if (byte & 0x80)
+        writePixel(cursor_x + g.xOffset + gx, cursor_y + g.yOffset + gy, textcolor);
+      byte <<= 1;
+    }
+  }
+  endWrite();
+  cursor_x += g.xAdvance;
+  return 1;
+}
@@ -0,0 +1,96 @@
+// ==================== Adafruit_ILI9341.cpp (host stand-in for the native build) ====================
+#include "Adafruit_ILI9341.h"
+
+namespace
+{
+// Keep in step with SPI_WINDOW_BYTES in TraceRenderer.h
+constexpr uint32_t WINDOW_BYTES = 11; // CASET + 4, PASET + 4, RAMWR
+constexpr uint8_t CMD_VSCRSADD = 0x37;
+} // namespace
+
+void Adafruit_ILI9341::put(int x, int y, uint16_t color)
+{
+  if (x >= 0 && y >= 0 && x < _width && y < _height)
+    mFb[y * _width + x] = color;
+}
+
+uint16_t Adafruit_ILI9341::pixel(int16_t x, int16_t y) const
+{
+  if (x < 0 || y < 0 || x >= _width || y >= _height)
+    return 0;
+  return mFb[y * _width + x];
+}
+
+void Adafruit_ILI9341::scrollTo(uint16_t y)
+{
+  mScroll = y;
+  mLog.commands++;
+  mLog.bytes += 3; // VSCRSADD + 2
+}
+
+void Adafruit_ILI9341::setScrollMargins(uint16_t top, uint16_t bottom)
+{
+  mLog.commands++;
+  mLog.bytes += 7; // VSCRDEF + 6
+}
+
+void Adafruit_ILI9341::sendCommand(uint8_t cmd, uint8_t *data, uint8_t n)
+{
+  if (cmd == CMD_VSCRSADD && n == 2)
+    mScroll = (uint16_t)(data[0] << 8 | data[1]);
+  mLog.commands++;
+  mLog.bytes += 1 + n;
+}
+
+void Adafruit_ILI9341::setAddrWindow(uint16_t x, uint16_t y, uint16_t w, uint16_t h)
+{
+  mWinX = x;
+  mWinY = y;
+  mWinW = w ? w : 1;
+  mWinH = h;
+  mWinPos = 0;
+  mLog.windows++;
+  mLog.bytes += WINDOW_BYTES;
+}
+
+void Adafruit_ILI9341::writePixels(uint16_t *colors, uint32_t len, bool block, bool bigEndian)
+{
+  for (uint32_t i = 0; i < len; ++i, ++mWinPos)
+    put(mWinX + (int)(mWinPos % mWinW), mWinY + (int)(mWinPos / mWinW), colors[i]);
+  mLog.pixels += len;
+  mLog.bytes += (uint64_t)mPixelBytes * len;
+}
+
+void Adafruit_ILI9341::writeColor(uint16_t color, uint32_t len)
+{
+  for (uint32_t i = 0; i < len; ++i, ++mWinPos)
+    put(mWinX + (int)(mWinPos % mWinW), mWinY + (int)(mWinPos / mWinW), color);
+  mLog.pixels += len;
+  mLog.bytes += (uint64_t)mPixelBytes * len;
+}
+
+void Adafruit_ILI9341::drawPixel(int16_t x, int16_t y, uint16_t color)
+{
+  startWrite();
+  writePixel(x, y, color);
+  endWrite();
+}
+
+void Adafruit_ILI9341::writePixel(int16_t x, int16_t y, uint16_t color)
+{
+  if (x < 0 || y < 0 || x >= _width || y >= _height)
+    return;
+  setAddrWindow(x, y, 1, 1);
+  writeColor(color, 1);
+}
+
+void Adafruit_ILI9341::writeFillRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color)
+{
+  // Clipped like the real driver, then one window
+  int x0 = max<int>(x, 0), y0 = max<int>(y, 0);
+  int x1 = min<int>(x + w, _width), y1 = min<int>(y + h, _height);
+  if (x1 <= x0 || y1 <= y0)
+    return;
+  setAddrWindow(x0, y0, x1 - x0, y1 - y0);
+  writeColor(color, (uint32_t)(x1 - x0) * (y1 - y0));
+}
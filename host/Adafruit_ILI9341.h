@@ -0,0 +1,82 @@
+// ==================== Adafruit_ILI9341.h (host stand-in for the native build) ====================
+// A fake panel: pixels land in an in-memory framebuffer and every transfer is
+// tallied in an SpiLog (transactions, address windows, pixels, bytes on the
+// wire), using the same byte costs as TraceRenderer.h's SPI model. Hardware
+// scrolling is recorded but not applied to the framebuffer. The fake
+// ILI9488 (Adafruit_ILI9488.h) is this one at its size and pixel format.
+#pragma once
+#include <Adafruit_GFX.h>
+
+#define ILI9341_TFTWIDTH 240
+#define ILI9341_TFTHEIGHT 320
+
+#define ILI9341_BLACK 0x0000
+#define ILI9341_BLUE 0x001F
+#define ILI9341_RED 0xF800
+#define ILI9341_GREEN 0x07E0
+#define ILI9341_CYAN 0x07FF
+#define ILI9341_MAGENTA 0xF81F
+#define ILI9341_YELLOW 0xFFE0
+#define ILI9341_WHITE 0xFFFF
+#define ILI9341_ORANGE 0xFD20
+
+struct SpiLog
+{
+  uint32_t transactions = 0; // startWrite() .. endWrite()
+  uint32_t windows = 0;      // CASET/PASET/RAMWR address windows
+  uint32_t pixels = 0;       // pixels clocked out
+  uint32_t commands = 0;     // other commands (scroll)
+  uint64_t bytes = 0;
+
+  void clear() { *this = SpiLog(); }
+};
+
+class Adafruit_ILI9341 : public Adafruit_GFX
+{
+public:
+  Adafruit_ILI9341(int8_t cs, int8_t dc, int8_t mosi, int8_t sclk, int8_t rst = -1, int8_t miso = -1)
+      : Adafruit_GFX(ILI9341_TFTWIDTH, ILI9341_TFTHEIGHT) {}
+  Adafruit_ILI9341(int8_t cs, int8_t dc, int8_t rst = -1)
+      : Adafruit_GFX(ILI9341_TFTWIDTH, ILI9341_TFTHEIGHT) {}
+
+  void begin(uint32_t freq = 0) {}
+  void sendCommand(uint8_t cmd, uint8_t *data = nullptr, uint8_t n = 0);
+  void setRotation(uint8_t m) override { Adafruit_GFX::setRotation(m); }
+  void scrollTo(uint16_t y);
+  void setScrollMargins(uint16_t top, uint16_t bottom);
+
+  // Adafruit_SPITFT transfer API
+  void startWrite() override { mLog.transactions++; }
+  void endWrite() override {}
+  void setAddrWindow(uint16_t x, uint16_t y, uint16_t w, uint16_t h);
+  void writePixels(uint16_t *colors, uint32_t len, bool block = true, bool bigEndian = false);
+  void writeColor(uint16_t color, uint32_t len);
+  void dmaWait() {}
+
+  void drawPixel(int16_t x, int16_t y, uint16_t color) override;
+  void writePixel(int16_t x, int16_t y, uint16_t color) override;
+  void writeFillRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color) override;
+
+  // Host-side inspection
+  const SpiLog &spiLog() const { return mLog; }
+  void clearSpiLog() { mLog.clear(); }
+  uint16_t pixel(int16_t x, int16_t y) const;
+  const uint16_t *framebuffer() const { return mFb; } // width() x height(), row-major
+  uint16_t scrollOffset() const { return mScroll; }
+
+protected:
+  // Another panel's size (unrotated) and bytes per pixel on the wire
+  Adafruit_ILI9341(int16_t w, int16_t h, uint8_t pixelBytes) : Adafruit_GFX(w, h), mPixelBytes(pixelBytes) {}
+
+private:
+  static constexpr int FB_MAX_PIXELS = 480 * 320; // the largest panel faked
+
+  void put(int x, int y, uint16_t color);
+
+  uint16_t mFb[FB_MAX_PIXELS] = {};
+  uint8_t mPixelBytes = 2;
+  SpiLog mLog;
+  int mWinX = 0, mWinY = 0, mWinW = 0, mWinH = 0;
+  uint32_t mWinPos = 0; // next pixel in the window
+  uint16_t mScroll = 0;
+};
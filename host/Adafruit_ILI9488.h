@@ -0,0 +1,22 @@
+// ==================== Adafruit_ILI9488.h (host stand-in for the native build) ====================
+// The fake ILI9341 at the ILI9488's 320x480 (unrotated) and 3 bytes per
+// pixel, for -DSCOPE_DISPLAY_ILI9488 host builds. It has no scroll helpers,
+// as the driver has none; the scroll commands arrive through sendCommand().
+#pragma once
+#include <Adafruit_ILI9341.h>
+
+#define ILI9488_TFTWIDTH 320
+#define ILI9488_TFTHEIGHT 480
+
+class Adafruit_ILI9488 : public Adafruit_ILI9341
+{
+public:
+  Adafruit_ILI9488(int8_t cs, int8_t dc, int8_t mosi, int8_t sclk, int8_t rst = -1, int8_t miso = -1)
+      : Adafruit_ILI9341((int16_t)ILI9488_TFTWIDTH, (int16_t)ILI9488_TFTHEIGHT, (uint8_t)3) {}
+  Adafruit_ILI9488(int8_t cs, int8_t dc, int8_t rst = -1)
+      : Adafruit_ILI9341((int16_t)ILI9488_TFTWIDTH, (int16_t)ILI9488_TFTHEIGHT, (uint8_t)3) {}
+
+private:
+  using Adafruit_ILI9341::scrollTo;
+  using Adafruit_ILI9341::setScrollMargins;
+};
@@ -0,0 +1,137 @@
+// ==================== Arduino.h (host stand-in for the native build) ====================
+// Just the slice of the Arduino core this sketch uses, so src/ compiles on a
+// PC. Time comes from the host clock; delay() advances a virtual clock instead
+// of sleeping, so boot splashes and polling loops don't stall a benchmark.
+#pragma once
+#include <stdint.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <algorithm>
+#include <string>
+
+using std::max;
+using std::min;
+
+#define constrain(amt, low, high) ((amt) < (low) ? (low) : ((amt) > (high) ? (high) : (amt)))
+#define PROGMEM
+#define IRAM_ATTR
+
+#define LOW 0
+#define HIGH 1
+#define INPUT 0x01
+#define OUTPUT 0x03
+#define INPUT_PULLUP 0x05
+#define RISING 0x01
+#define FALLING 0x02
+#define CHANGE 0x03
+
+uint32_t millis();
+uint32_t micros();
+void delay(uint32_t ms);
+void delayMicroseconds(uint32_t us);
+void yield();
+
+void pinMode(uint8_t pin, uint8_t mode);
+int digitalRead(uint8_t pin);
+void digitalWrite(uint8_t pin, uint8_t val);
+uint16_t analogRead(uint8_t pin);
+#define digitalPinToInterrupt(p) (p)
+void attachInterrupt(uint8_t pin, void (*isr)(), int mode);
+void attachInterruptArg(uint8_t pin, void (*isr)(void *), void *arg, int mode);
+
+// Host-side pin model: what digitalRead() returns (buttons idle high; setting
+// a new level runs the pin's attachInterruptArg() handler) and what
+// digitalWrite() last set (e.g. the VU LEDs)
+void hostSetPinInput(uint8_t pin, int level);
+int hostPinOutput(uint8_t pin);
+
+inline bool isDigit(int c) { return c >= '0' && c <= '9'; }
+
+// -------------------- strings / printing --------------------
+class __FlashStringHelper;
+#define F(s) (reinterpret_cast<const __FlashStringHelper *>(s))
+
+class String
+{
+public:
+  String(const char *s = "") : mStr(s) {}
+  size_t length() const { return mStr.size(); }
+  char operator[](size_t i) const { return mStr[i]; }
+  String &operator+=(char c)
+  {
+    mStr += c;
+    return *this;
+  }
+  bool operator==(const char *s) const { return mStr == s; }
+  bool operator!=(const char *s) const { return mStr != s; }
+  long toInt() const { return atol(mStr.c_str()); }
+  const char *c_str() const { return mStr.c_str(); }
+  void trim();
+
+private:
+  std::string mStr;
+};
+
+class Print
+{
+public:
+  virtual ~Print() {}
+  virtual size_t write(uint8_t c) = 0;
+  virtual size_t write(const uint8_t *buf, size_t n);
+
+  size_t print(const char *s) { return write((const uint8_t *)s, strlen(s)); }
+  size_t print(const __FlashStringHelper *s) { return print((const char *)s); }
+  size_t print(const String &s) { return print(s.c_str()); }
+  size_t print(char c) { return write((uint8_t)c); }
+  size_t print(long v, int base = 10);
+  size_t print(unsigned long v, int base = 10);
+  size_t print(int v, int base = 10) { return print((long)v, base); }
+  size_t print(unsigned v, int base = 10) { return print((unsigned long)v, base); }
+  size_t print(double v, int digits = 2);
+  size_t printf(const char *fmt, ...);
+
+  size_t println() { return print("\r\n"); }
+  template <class T>
+  size_t println(T v) { return print(v) + println(); }
+  template <class T>
+  size_t println(T v, int fmt) { return print(v, fmt) + println(); }
+};
+
+class Stream : public Print
+{
+public:
+  virtual int available() = 0;
+  virtual int read() = 0;
+  virtual int peek() = 0;
+  String readStringUntil(char terminator);
+};
+
+// Output goes to stdout; input is whatever the host code injected.
+class HardwareSerial : public Stream
+{
+public:
+  void begin(unsigned long) {}
+  void updateBaudRate(unsigned long) {}
+  void setTxBufferSize(size_t) {}
+  void flush() { fflush(stdout); }
+  int availableForWrite() { return 1 << 16; } // stdout never backs up
+  int available() override { return (int)(mRx.size() - mRxPos); }
+  int read() override;
+  int peek() override;
+  size_t write(uint8_t c) override;
+  using Print::write;
+  operator bool() const { return true; }
+
+  void inject(const char *text) { mRx += text; }
+  void setEcho(bool on) { mEcho = on; } // false silences output (benchmarks)
+
+private:
+  std::string mRx;
+  size_t mRxPos = 0;
+  bool mEcho = true;
+};
+
+extern HardwareSerial Serial;
@@ -0,0 +1,151 @@
+// ==================== HostArduino.cpp (host stand-in for the Arduino core) ====================
+#include <Arduino.h>
+#include <stdarg.h>
+#include <chrono>
+
+// -------------------- time --------------------
+namespace
+{
+const auto T0 = std::chrono::steady_clock::now();
+uint64_t gVirtualUs = 0; // time "spent" in delay()
+
+uint64_t nowUs()
+{
+  const auto dt = std::chrono::steady_clock::now() - T0;
+  return (uint64_t)std::chrono::duration_cast<std::chrono::microseconds>(dt).count() + gVirtualUs;
+}
+
+int gPinIn[64];
+int gPinOut[64];
+bool gPinsInit = false;
+void (*gPinIsr[64])(void *);
+void *gPinIsrArg[64];
+
+void initPins()
+{
+  if (gPinsInit)
+    return;
+  for (int i = 0; i < 64; ++i)
+    gPinIn[i] = HIGH; // buttons have pull-ups
+  gPinsInit = true;
+}
+} // namespace
+
+uint32_t micros() { return (uint32_t)nowUs(); }
+uint32_t millis() { return (uint32_t)(nowUs() / 1000); }
+void delay(uint32_t ms) { gVirtualUs += (uint64_t)ms * 1000; }
+void delayMicroseconds(uint32_t us) { gVirtualUs += us; }
+void yield() {}
+
+// -------------------- pins --------------------
+void pinMode(uint8_t, uint8_t) {}
+
+int digitalRead(uint8_t pin)
+{
+  initPins();
+  return gPinIn[pin & 63];
+}
+
+void digitalWrite(uint8_t pin, uint8_t val) { gPinOut[pin & 63] = val; }
+uint16_t analogRead(uint8_t) { return 2048; }
+void attachInterrupt(uint8_t, void (*)(), int) {}
+
+void attachInterruptArg(uint8_t pin, void (*isr)(void *), void *arg, int)
+{
+  gPinIsr[pin & 63] = isr;
+  gPinIsrArg[pin & 63] = arg;
+}
+
+// Any change "interrupts", as CHANGE would on the chip
+void hostSetPinInput(uint8_t pin, int level)
+{
+  initPins();
+  const bool changed = gPinIn[pin & 63] != level;
+  gPinIn[pin & 63] = level;
+  if (changed && gPinIsr[pin & 63])
+    gPinIsr[pin & 63](gPinIsrArg[pin & 63]);
+}
+
+int hostPinOutput(uint8_t pin) { return gPinOut[pin & 63]; }
+
+// -------------------- strings / printing --------------------
+void String::trim()
+{
+  const size_t b = mStr.find_first_not_of(" \t\r\n");
+  const size_t e = mStr.find_last_not_of(" \t\r\n");
+  mStr = b == std::string::npos ? std::string() : mStr.substr(b, e - b + 1);
+}
+
+size_t Print::write(const uint8_t *buf, size_t n)
+{
+  size_t k = 0;
+  while (n--)
+    k += write(*buf++);
+  return k;
+}
+
+size_t Print::print(long v, int base)
+{
+  char b[24];
+  snprintf(b, sizeof(b), base == 16 ? "%lx" : "%ld", v);
+  return print(b);
+}
+
+size_t Print::print(unsigned long v, int base)
+{
+  char b[24];
+  snprintf(b, sizeof(b), base == 16 ? "%lx" : "%lu", v);
+  return print(b);
+}
+
+size_t Print::print(double v, int digits)
+{
+  char b[32];
+  snprintf(b, sizeof(b), "%.*f", digits, v);
+  return print(b);
+}
+
+size_t Print::printf(const char *fmt, ...)
+{
+  char b[256];
+  va_list a;
+  va_start(a, fmt);
+  vsnprintf(b, sizeof(b), fmt, a);
+  va_end(a);
+  return print(b);
+}
+
+String Stream::readStringUntil(char terminator)
+{
+  String s;
+  for (int c = read(); c >= 0 && c != terminator; c = read())
+    s += (char)c;
+  return s;
+}
+
+int HardwareSerial::read()
+{
+  if (mRxPos >= mRx.size())
+    return -1;
+  const int c = (uint8_t)mRx[mRxPos++];
+  if (mRxPos == mRx.size())
+  {
+    mRx.clear();
+    mRxPos = 0;
+  }
+  return c;
+}
+
+int HardwareSerial::peek()
+{
+  return mRxPos < mRx.size() ? (uint8_t)mRx[mRxPos] : -1;
+}
+
+size_t HardwareSerial::write(uint8_t c)
+{
+  if (mEcho)
+    putchar(c);
+  return 1;
+}
+
+HardwareSerial Serial;
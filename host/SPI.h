@@ -0,0 +1,3 @@
+// ==================== SPI.h (host stand-in for the native build) ====================
+// The fake panel in Adafruit_ILI9341.h accounts for SPI traffic itself.
+#pragma once
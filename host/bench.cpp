@@ -0,0 +1,222 @@
+// ==================== bench.cpp (host frame-time benchmark) ====================
+// Drives the sketch's capture -> render -> VU path against the fake panel and
+// the scripted source for each (Fs, Px/Sample) pair and render mode, and
+// prints per-frame SPI traffic and host time per stage. Compare runs before
+// and after a render-path change; the SPI columns are exact, the timings are
+// host CPU time and only meaningful relative to each other.
+//
+//   pio run -e native && .pio/build/native/program [--frames N] [--mode spans|bands|pixels|phosphor] [--ch a|ab|a-b|xy] [--csv] [--ppm out.ppm]
+//
+// Left out of `pio test -e native`, which links src/ and host/ into every
+// test program and takes main() from the test.
+#ifndef PIO_UNIT_TESTING
+#include <Arduino.h>
+#include "SampleSource.h"
+#include "FrameQueue.h"
+#include "ScopeLayout.h" // and the panel, from DisplayTraits.h
+#include "Fft.h"
+
+// -------------------- main.cpp internals driven directly --------------------
+using ScopeFrame = SampleFrame<FFT_MAX, 2 * PLOT_W>;
+enum RenderMode : uint8_t; // RENDER_SPANS, RENDER_BANDS, RENDER_PIXELS, RENDER_PHOSPHOR
+enum TraceMode : uint8_t;  // TRACE_A, TRACE_AB, TRACE_A_MINUS_B, TRACE_XY
+
+extern ScopePanel tft;
+extern ScriptedSource gAdcSource;
+extern RenderMode gRenderMode;
+
+void setup();
+void setSampleFreq(uint32_t newFs);
+void setTimebase(uint8_t pxs, uint16_t spp);
+void setTraceMode(TraceMode m);
+void restartCapture();
+bool captureFrame(ScopeFrame &f);
+void renderFrame(const ScopeFrame &f);
+void updateVU(const Measurements &m);
+void clearPlotAndHistory();
+
+// -------------------- settings --------------------
+namespace
+{
+constexpr const char *MODE_NAMES[] = {"spans", "bands", "pixels", "phosphor"};
+constexpr int MODE_COUNT = sizeof(MODE_NAMES) / sizeof(MODE_NAMES[0]);
+constexpr const char *TRACE_MODE_NAMES[] = {"a", "ab", "a-b", "xy"};
+constexpr int TRACE_MODE_COUNT = sizeof(TRACE_MODE_NAMES) / sizeof(TRACE_MODE_NAMES[0]);
+
+constexpr uint32_t FS_LIST[] = {1000, 5000, 20000, 100000, 500000};
+constexpr uint8_t PXS_LIST[] = {1, 2, 5, 10};
+constexpr int WARMUP_FRAMES = 3; // the first frames after a change draw the whole trace
+constexpr int MAX_CAPTURE_TRIES = 1000;
+
+// Tone steps, a burst and noise, so triggered and untriggered frames both occur
+const ScriptedSource::Step SCRIPT[] = {
+    {SyntheticSource::WAVE_SINE, 440.0f, 900, 2048, 0, 200},
+    {SyntheticSource::WAVE_SQUARE, 1000.0f, 1500, 2048, 20, 200},
+    {SyntheticSource::WAVE_TRIANGLE, 97.0f, 1800, 2048, 40, 200},
+    {SyntheticSource::WAVE_SINE, 3000.0f, 400, 2048, 8, 200},
+    {SyntheticSource::WAVE_SAW, 50.0f, 1200, 2048, 0, 100},
+    {SyntheticSource::WAVE_NOISE, 0.0f, 300, 2048, 0, 100}};
+
+struct Totals
+{
+  uint64_t pixels = 0, windows = 0, bytes = 0;
+  uint64_t captureUs = 0, renderUs = 0, vuUs = 0;
+  uint32_t renderMaxUs = 0;
+  int frames = 0;
+};
+
+ScopeFrame gFrame;
+
+bool captureOne()
+{
+  restartCapture();
+  for (int i = 0; i < MAX_CAPTURE_TRIES; ++i)
+    if (captureFrame(gFrame))
+      return true;
+  return false;
+}
+
+Totals runCase(int frames)
+{
+  Totals t;
+  for (int i = 0; i < WARMUP_FRAMES + frames; ++i)
+  {
+    const uint32_t c0 = micros();
+    if (!captureOne())
+      break;
+    const uint32_t c1 = micros();
+    tft.clearSpiLog();
+    renderFrame(gFrame);
+    const uint32_t c2 = micros();
+    updateVU(gFrame.meas);
+    const uint32_t c3 = micros();
+    if (i < WARMUP_FRAMES)
+      continue;
+
+    const SpiLog &log = tft.spiLog();
+    t.pixels += log.pixels;
+    t.windows += log.windows;
+    t.bytes += log.bytes;
+    t.captureUs += c1 - c0;
+    t.renderUs += c2 - c1;
+    t.vuUs += c3 - c2;
+    t.renderMaxUs = max(t.renderMaxUs, c2 - c1);
+    t.frames++;
+  }
+  return t;
+}
+
+void printHeader(bool csv)
+{
+  if (csv)
+    printf("fs,pxs,mode,frames,px_frame,win_frame,bytes_frame,spi_us,capture_us,render_us,render_max_us,vu_us\n");
+  else
+    printf("%7s %3s %-6s %8s %7s %9s %8s %9s %9s %9s %6s\n", "Fs", "pxs", "mode", "px/frm", "win/frm",
+           "bytes/frm", "SPI us", "capt us", "rend us", "rend max", "vu us");
+}
+
+void printRow(bool csv, uint32_t fs, uint8_t pxs, int mode, const Totals &t)
+{
+  const uint64_t n = t.frames ? t.frames : 1;
+  const uint64_t bytes = t.bytes / n;
+  const uint64_t spiUs = bytes * 8 * 1000000ULL / ScopeDisplay::SPI_HZ;
+  if (csv)
+    printf("%u,%u,%s,%d,%llu,%llu,%llu,%llu,%llu,%llu,%u,%llu\n", (unsigned)fs, (unsigned)pxs, MODE_NAMES[mode], t.frames,
+           (unsigned long long)(t.pixels / n), (unsigned long long)(t.windows / n), (unsigned long long)bytes,
+           (unsigned long long)spiUs, (unsigned long long)(t.captureUs / n), (unsigned long long)(t.renderUs / n),
+           (unsigned)t.renderMaxUs, (unsigned long long)(t.vuUs / n));
+  else
+    printf("%7u %3u %-6s %8llu %7llu %9llu %8llu %9llu %9llu %9u %6llu\n", (unsigned)fs, (unsigned)pxs, MODE_NAMES[mode],
+           (unsigned long long)(t.pixels / n), (unsigned long long)(t.windows / n), (unsigned long long)bytes,
+           (unsigned long long)spiUs, (unsigned long long)(t.captureUs / n), (unsigned long long)(t.renderUs / n),
+           (unsigned)t.renderMaxUs, (unsigned long long)(t.vuUs / n));
+}
+
+// Binary PPM of the last frame, for eyeballing a render change
+bool savePpm(const char *path)
+{
+  FILE *fp = fopen(path, "wb");
+  if (!fp)
+    return false;
+  const int w = tft.width(), h = tft.height();
+  fprintf(fp, "P6\n%d %d\n255\n", w, h);
+  for (int i = 0; i < w * h; ++i)
+  {
+    const uint16_t c = tft.framebuffer()[i];
+    const uint8_t rgb[3] = {(uint8_t)((c >> 8) & 0xF8), (uint8_t)((c >> 3) & 0xFC), (uint8_t)(c << 3)};
+    fwrite(rgb, 1, 3, fp);
+  }
+  fclose(fp);
+  return true;
+}
+} // namespace
+
+// -------------------- main --------------------
+int main(int argc, char **argv)
+{
+  int frames = 50;
+  int onlyMode = -1;
+  int traceMode = 0;
+  bool csv = false;
+  const char *ppm = nullptr;
+  for (int i = 1; i < argc; ++i)
+  {
+    if (!strcmp(argv[i], "--frames") && i + 1 < argc)
+      frames = max(1, atoi(argv[++i]));
+    else if (!strcmp(argv[i], "--mode") && i + 1 < argc)
+    {
+      ++i;
+      for (int m = 0; m < MODE_COUNT; ++m)
+        if (!strcmp(argv[i], MODE_NAMES[m]))
+          onlyMode = m;
+    }
+    else if (!strcmp(argv[i], "--ch") && i + 1 < argc)
+    {
+      ++i;
+      for (int m = 0; m < TRACE_MODE_COUNT; ++m)
+        if (!strcmp(argv[i], TRACE_MODE_NAMES[m]))
+          traceMode = m;
+    }
+    else if (!strcmp(argv[i], "--csv"))
+      csv = true;
+    else if (!strcmp(argv[i], "--ppm") && i + 1 < argc)
+      ppm = argv[++i];
+    else
+    {
+      fprintf(stderr, "usage: %s [--frames N] [--mode spans|bands|pixels|phosphor] [--ch a|ab|a-b|xy] [--csv] [--ppm out.ppm]\n", argv[0]);
+      return 2;
+    }
+  }
+
+  gAdcSource.setScript(SCRIPT, sizeof(SCRIPT) / sizeof(SCRIPT[0]));
+  Serial.setEcho(false); // keep the sketch's own prints out of the table
+  setup();
+  setTraceMode((TraceMode)traceMode); // dual modes clamp the top Fs to half
+
+  printHeader(csv);
+  for (int mode = 0; mode < MODE_COUNT; ++mode)
+  {
+    if (onlyMode >= 0 && mode != onlyMode)
+      continue;
+    gRenderMode = (RenderMode)mode;
+    clearPlotAndHistory();
+    for (uint32_t fs : FS_LIST)
+    {
+      for (uint8_t pxs : PXS_LIST)
+      {
+        setSampleFreq(fs);
+        setTimebase(pxs, 1);
+        gAdcSource.rewind();
+        printRow(csv, fs, pxs, mode, runCase(frames));
+      }
+    }
+  }
+
+  if (ppm && !savePpm(ppm))
+  {
+    fprintf(stderr, "could not write %s\n", ppm);
+    return 1;
+  }
+  return 0;
+}
+#endif
@@ -0,0 +1,371 @@
+// ==================== scope_rx.cpp (host receiver for the binary sample stream) ====================
+// Pulls the COBS-framed sample stream ('stream on', see SampleStream.h) off
+// the serial port and writes it to WAV and/or CSV, printing packet, loss and
+// CRC-error counts once a second. --loopback runs the encoder and decoder
+// against each other in memory, over a link that drops, corrupts and
+// interleaves text, and checks every surviving sample and counter.
+//
+//   pio run -e native_rx
+//   .pio/build/native_rx/program --port /dev/ttyUSB0 --baud 2000000 --wav out.wav --seconds 10
+//   .pio/build/native_rx/program --loopback
+#include <Arduino.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <termios.h>
+#include <unistd.h>
+#include <vector>
+#include "SampleStream.h"
+#include "SampleSource.h"
+
+// -------------------- output files --------------------
+namespace
+{
+volatile sig_atomic_t gStop = 0;
+
+void put16(FILE *fp, uint16_t v)
+{
+  fputc(v & 0xFF, fp);
+  fputc(v >> 8, fp);
+}
+
+void put32(FILE *fp, uint32_t v)
+{
+  put16(fp, (uint16_t)v);
+  put16(fp, (uint16_t)(v >> 16));
+}
+
+// 16-bit mono PCM; the header is patched with the final sizes on close
+class WavWriter
+{
+public:
+  bool open(const char *path, uint32_t fs)
+  {
+    mFp = fopen(path, "wb");
+    if (!mFp)
+      return false;
+    fwrite("RIFF\0\0\0\0WAVEfmt ", 1, 16, mFp);
+    put32(mFp, 16);
+    put16(mFp, 1); // PCM
+    put16(mFp, 1); // mono
+    put32(mFp, fs);
+    put32(mFp, fs * 2);
+    put16(mFp, 2);
+    put16(mFp, 16);
+    fwrite("data\0\0\0\0", 1, 8, mFp);
+    return true;
+  }
+
+  bool isOpen() const { return mFp != nullptr; }
+
+  // 12-bit codes centred on mid-scale and scaled to full 16-bit range
+  void write(const int16_t *codes, size_t n)
+  {
+    for (size_t i = 0; i < n; ++i)
+      put16(mFp, (uint16_t)(int16_t)((codes[i] - 2048) * 16));
+    mSamples += (uint32_t)n;
+  }
+
+  void close()
+  {
+    if (!mFp)
+      return;
+    fseek(mFp, 4, SEEK_SET);
+    put32(mFp, 36 + mSamples * 2);
+    fseek(mFp, 40, SEEK_SET);
+    put32(mFp, mSamples * 2);
+    fclose(mFp);
+    mFp = nullptr;
+  }
+
+private:
+  FILE *mFp = nullptr;
+  uint32_t mSamples = 0;
+};
+
+struct Outputs
+{
+  const char *wavPath = nullptr;
+  FILE *csv = nullptr;
+  WavWriter wav;
+  uint64_t samples = 0;
+  uint32_t fs = 0;
+
+  void packet(const StreamPacket &p)
+  {
+    if (fs && p.fs != fs)
+      fprintf(stderr, "note: Fs changed %u -> %u Hz (WAV header keeps the first)\n", (unsigned)fs, (unsigned)p.fs);
+    fs = p.fs;
+    if (wavPath && !wav.isOpen() && !wav.open(wavPath, p.fs))
+    {
+      fprintf(stderr, "could not write %s\n", wavPath);
+      wavPath = nullptr;
+    }
+    if (wav.isOpen())
+      wav.write(p.samples, p.count);
+    if (csv)
+      for (uint16_t i = 0; i < p.count; ++i)
+        fprintf(csv, "%u,%llu,%d\n", (unsigned)p.seq, (unsigned long long)(samples + i), p.samples[i]);
+    samples += p.count;
+  }
+
+  void close()
+  {
+    wav.close();
+    if (csv)
+      fclose(csv);
+  }
+};
+
+void printCounters(const StreamCounters &c, uint64_t samples)
+{
+  fprintf(stderr, "packets %u  samples %llu  lost %u  corrupt %u  discontinuities %u\n", (unsigned)c.packets,
+          (unsigned long long)samples, (unsigned)c.lost, (unsigned)c.corrupt, (unsigned)c.discontinuities);
+}
+
+// -------------------- serial port --------------------
+speed_t baudConstant(long baud)
+{
+  static const struct
+  {
+    long baud;
+    speed_t code;
+  } TABLE[] = {{9600, B9600}, {57600, B57600}, {115200, B115200}, {230400, B230400}, {460800, B460800},
+               {921600, B921600}, {1000000, B1000000}, {1500000, B1500000}, {2000000, B2000000},
+               {3000000, B3000000}, {4000000, B4000000}};
+  for (const auto &t : TABLE)
+    if (t.baud == baud)
+      return t.code;
+  return 0;
+}
+
+bool setBaud(int fd, long baud)
+{
+  const speed_t code = baudConstant(baud);
+  termios tio;
+  if (!code || tcgetattr(fd, &tio) != 0)
+    return false;
+  cfmakeraw(&tio);
+  tio.c_cflag |= CLOCAL | CREAD;
+  tio.c_cc[VMIN] = 0;
+  tio.c_cc[VTIME] = 1; // reads return after 100 ms idle
+  cfsetispeed(&tio, code);
+  cfsetospeed(&tio, code);
+  return tcsetattr(fd, TCSANOW, &tio) == 0;
+}
+
+void sendLine(int fd, const char *line)
+{
+  if (write(fd, line, strlen(line)) < 0)
+    perror("write");
+  tcdrain(fd);
+}
+
+int runSerial(const char *port, long baud, long bootBaud, int seconds, Outputs &out)
+{
+  const int fd = open(port, O_RDWR | O_NOCTTY);
+  if (fd < 0)
+  {
+    perror(port);
+    return 1;
+  }
+  // The sketch boots at bootBaud; ask it to switch, then follow it
+  if (baud != bootBaud && setBaud(fd, bootBaud))
+  {
+    char cmd[32];
+    snprintf(cmd, sizeof(cmd), "baud %ld\n", baud);
+    sendLine(fd, cmd);
+    usleep(100000);
+  }
+  if (!setBaud(fd, baud))
+  {
+    fprintf(stderr, "unsupported baud rate %ld\n", baud);
+    close(fd);
+    return 1;
+  }
+  tcflush(fd, TCIFLUSH);
+  sendLine(fd, "stream on\n");
+
+  SampleStreamDecoder dec;
+  uint8_t buf[4096];
+  const uint32_t start = millis();
+  uint32_t lastReport = start;
+  while (!gStop && (seconds <= 0 || millis() - start < (uint32_t)seconds * 1000))
+  {
+    const ssize_t n = read(fd, buf, sizeof(buf));
+    if (n < 0 && errno != EINTR)
+    {
+      perror("read");
+      break;
+    }
+    for (ssize_t i = 0; i < n; ++i)
+      if (dec.push(buf[i]))
+        out.packet(dec.packet());
+    if (millis() - lastReport >= 1000)
+    {
+      printCounters(dec.counters(), out.samples);
+      lastReport = millis();
+    }
+  }
+
+  sendLine(fd, "stream off\n");
+  close(fd);
+  printCounters(dec.counters(), out.samples);
+  return 0;
+}
+
+// -------------------- loopback --------------------
+// Encoder -> lossy in-memory link -> decoder. Returns the number of failures.
+int runLoopback(Outputs &out)
+{
+  constexpr int PACKETS = 3000;
+  constexpr uint32_t FS = 48000;
+  SyntheticSource gen(SyntheticSource::WAVE_NOISE, 0.0f, 2047, 2048); // every code, zero bytes included
+  gen.begin(FS);
+
+  SampleStreamEncoder enc;
+  SampleStreamDecoder dec;
+  std::vector<std::vector<int16_t>> sent(PACKETS);
+  uint8_t frame[STREAM_FRAME_MAX];
+  uint32_t dropped = 0, damaged = 0, marked = 1; // the first packet is always marked
+
+  for (int i = 0; i < PACKETS; ++i)
+  {
+    // Odd, full, single and all-zero packets all occur
+    const uint16_t n = (uint16_t)(i % 5 == 0 ? STREAM_MAX_SAMPLES : 1 + (i * 37) % STREAM_MAX_SAMPLES);
+    std::vector<int16_t> &s = sent[i];
+    s.resize(n);
+    if (i % 211 == 0)
+      std::fill(s.begin(), s.end(), 0);
+    else
+      gen.read(s.data(), n, 0);
+
+    if (i % 500 == 123)
+    {
+      enc.markDiscontinuity();
+      ++marked;
+    }
+    size_t len = enc.encode(s.data(), n, FS, frame);
+
+    if (i % 53 == 7) // lost on the wire
+    {
+      ++dropped;
+      s.clear();
+      continue;
+    }
+    if (i % 71 == 3) // one byte hit, never into a delimiter
+    {
+      frame[len / 2] = (uint8_t)(frame[len / 2] ^ 0x5A) ? (uint8_t)(frame[len / 2] ^ 0x5A) : 0x01;
+      ++damaged;
+      s.clear();
+    }
+    else if (i % 100 == 50) // status text printed just before this frame
+    {
+      for (const char *t = "Fs set to 48000\r\n"; *t; ++t)
+        dec.push((uint8_t)*t);
+      ++damaged;
+      s.clear();
+    }
+    for (size_t b = 0; b < len; ++b)
+      if (dec.push(frame[b]))
+      {
+        const StreamPacket &p = dec.packet();
+        out.packet(p);
+        if (p.seq >= (uint32_t)PACKETS || sent[p.seq].size() != p.count ||
+            !std::equal(sent[p.seq].begin(), sent[p.seq].end(), p.samples))
+        {
+          fprintf(stderr, "FAIL: packet %u does not match what was sent\n", (unsigned)p.seq);
+          return 1;
+        }
+        sent[p.seq].clear();
+      }
+  }
+
+  int failures = 0;
+  for (int i = 0; i < PACKETS; ++i)
+    if (!sent[i].empty())
+    {
+      fprintf(stderr, "FAIL: packet %d never arrived\n", i);
+      ++failures;
+      break;
+    }
+  const StreamCounters &c = dec.counters();
+  auto expect = [&failures](const char *what, uint32_t got, uint32_t want)
+  {
+    if (got != want)
+    {
+      fprintf(stderr, "FAIL: %s %u, expected %u\n", what, (unsigned)got, (unsigned)want);
+      ++failures;
+    }
+  };
+  expect("packets", c.packets, PACKETS - dropped - damaged);
+  // Trailing drops are invisible until a later packet arrives; none here end the run
+  expect("lost", c.lost, dropped + damaged);
+  expect("corrupt", c.corrupt, damaged);
+  expect("discontinuities", c.discontinuities, marked);
+  printCounters(c, out.samples);
+  fprintf(stderr, failures ? "loopback FAILED\n" : "loopback OK\n");
+  return failures;
+}
+
+void onSignal(int) { gStop = 1; }
+
+void usage(const char *argv0)
+{
+  fprintf(stderr,
+          "usage: %s --port DEV [--baud N] [--boot-baud N] [--seconds S] [--wav FILE] [--csv FILE]\n"
+          "       %s --loopback [--wav FILE] [--csv FILE]\n",
+          argv0, argv0);
+}
+} // namespace
+
+// -------------------- main --------------------
+int main(int argc, char **argv)
+{
+  const char *port = nullptr;
+  long baud = 2000000, bootBaud = 115200;
+  int seconds = 0;
+  bool loopback = false;
+  Outputs out;
+  for (int i = 1; i < argc; ++i)
+  {
+    const bool more = i + 1 < argc;
+    if (!strcmp(argv[i], "--port") && more)
+      port = argv[++i];
+    else if (!strcmp(argv[i], "--baud") && more)
+      baud = atol(argv[++i]);
+    else if (!strcmp(argv[i], "--boot-baud") && more)
+      bootBaud = atol(argv[++i]);
+    else if (!strcmp(argv[i], "--seconds") && more)
+      seconds = atoi(argv[++i]);
+    else if (!strcmp(argv[i], "--wav") && more)
+      out.wavPath = argv[++i];
+    else if (!strcmp(argv[i], "--csv") && more)
+    {
+      out.csv = fopen(argv[++i], "w");
+      if (!out.csv)
+      {
+        perror(argv[i]);
+        return 1;
+      }
+      fprintf(out.csv, "seq,sample,code\n");
+    }
+    else if (!strcmp(argv[i], "--loopback"))
+      loopback = true;
+    else
+    {
+      usage(argv[0]);
+      return 2;
+    }
+  }
+  if (!loopback && !port)
+  {
+    usage(argv[0]);
+    return 2;
+  }
+
+  signal(SIGINT, onSignal);
+  const int rc = loopback ? (runLoopback(out) ? 1 : 0) : runSerial(port, baud, bootBaud, seconds, out);
+  out.close();
+  return rc;
+}
@@ -0,0 +1,87 @@
+// ==================== AdcCalibration.h (ADC linearity correction) ====================
+// At 11 dB attenuation the ESP32's ADC1 is far from the raw/4095 x 3.3 V the
+// rest of the scope assumes: it starts conducting ~100 mV above 0, tops out
+// near 3.1 V, and bends at both rails. AdcCalibration holds one 4096-entry
+// table that maps each raw code to the code an ideal ADC would have given for
+// the same input voltage, i.e. to mV * 4095 / 3300. Samples are corrected in
+// place by a single lookup as they come off the source, so everything after
+// (filters, trigger, measurements, record, axis labels) works in true volts
+// without a conversion of its own.
+//
+// The table is built from one of:
+//   eFuse    the factory characterisation burned into the chip (esp_adc_cal)
+//   user     up to MAX_POINTS (raw, mV) pairs taken against known voltages:
+//            one point shifts the nominal line, two or more are joined
+//            piecewise-linearly and the end segments extended to the rails
+//   nominal  raw codes pass untouched (also the host and synthetic builds)
+// and kept in NVS, so a user calibration survives a reboot.
+#pragma once
+#include <stdint.h>
+#include <stddef.h>
+
+constexpr int16_t ADC_CODE_MAX = 4095;
+constexpr int32_t ADC_FULL_SCALE_MV = 3300; // what ADC_CODE_MAX stands for once corrected
+
+constexpr int32_t codeToMv(int32_t code) { return (code * ADC_FULL_SCALE_MV + ADC_CODE_MAX / 2) / ADC_CODE_MAX; }
+constexpr int32_t mvToCode(int32_t mv) { return (mv * ADC_CODE_MAX + ADC_FULL_SCALE_MV / 2) / ADC_FULL_SCALE_MV; }
+
+enum CalSource : uint8_t
+{
+  CAL_NOMINAL,
+  CAL_EFUSE,
+  CAL_USER,
+  CAL_SOURCE_COUNT
+};
+
+struct CalPoint
+{
+  uint16_t raw;
+  uint16_t mv;
+};
+
+class AdcCalibration
+{
+public:
+  static constexpr int MAX_POINTS = 8;
+  static constexpr int CODES = ADC_CODE_MAX + 1;
+
+  // The stored table if there is one, else eFuse (when adcInput), else nominal
+  void begin(bool adcInput);
+
+  void useNominal();
+  bool useEfuse(); // false when the chip has no usable characterisation
+  // Adds (or, within 16 codes of an existing one, replaces) a user point and
+  // rebuilds the table from the user points alone
+  bool addPoint(uint16_t raw, uint16_t mv);
+  void clearPoints(); // back to eFuse, or nominal
+
+  // Persists the current table and points; false where there is no NVS
+  bool save() const;
+
+  // Capture side, in place on raw source samples; track feeds rawLevelQ4()
+  // (off for a second channel, so points stay those of the first)
+  void apply(int16_t *s, size_t n, bool track = true);
+
+  CalSource source() const { return mSource; }
+  const char *sourceName() const;
+  uint16_t toMv(uint16_t raw) const { return (uint16_t)codeToMv(mCode[raw & ADC_CODE_MAX]); }
+  int pointCount() const { return mPointCount; }
+  const CalPoint &point(int i) const { return mPoints[i]; }
+
+  // Mean raw input in Q4, before correction, smoothed over ~16 reads: what a
+  // user point is taken from
+  uint32_t rawLevelQ4() const { return mRawQ4; }
+
+private:
+  bool load();
+  void buildNominal();
+  bool buildEfuse();
+  void buildFromPoints();
+
+  uint16_t mCode[CODES]; // corrected code per raw code
+  bool mIdentity = true; // mCode[i] == i: apply() only watches the level
+  CalSource mSource = CAL_NOMINAL;
+  CalPoint mPoints[MAX_POINTS] = {}; // sorted by raw
+  int mPointCount = 0;
+  volatile uint32_t mRawQ4 = 0;
+};
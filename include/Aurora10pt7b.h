@@ -1,7 +1,7 @@
 #include <Arduino.h>
 #include <Adafruit_GFX.h>
 
-const uint8_t aurora_2410pt7bBitmaps[] PROGMEM = {
+constexpr uint8_t aurora_2410pt7bBitmaps[] PROGMEM = {
   0x00, 0xFF, 0xFF, 0xFC, 0x3C, 0xCF, 0x3C, 0xF3, 0x0C, 0x60, 0x18, 0xC0,
   0x31, 0x80, 0x63, 0x0F, 0xFF, 0xFF, 0xFF, 0xC3, 0x18, 0x06, 0x30, 0xFF,
   0xFF, 0xFF, 0xFC, 0x31, 0x80, 0x63, 0x00, 0xC6, 0x01, 0x8C, 0x03, 0x18,
@@ -179,7 +179,7 @@ const uint8_t aurora_2410pt7bBitmaps[] PROGMEM = {
   0x00, 0x78, 0x0F, 0x00, 0x01, 0x80, 0x30, 0x06, 0x00, 0xC1, 0xE0, 0x3C,
   0x00, 0x3C, 0x19, 0xE0, 0xF0, 0x79, 0x83, 0xC0 };
 
-const GFXglyph aurora_2410pt7bGlyphs[] PROGMEM = {
+constexpr GFXglyph aurora_2410pt7bGlyphs[] PROGMEM = {
   {     0,   1,   1,  11,    0,    0 },   // 0x20 ' '
   {     1,   2,  15,   4,    0,  -14 },   // 0x21 '!'
   {     5,   6,   4,   8,    0,  -14 },   // 0x22 '"'
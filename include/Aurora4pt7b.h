@@ -1,7 +1,7 @@
 #include <Arduino.h>
 #include <Adafruit_GFX.h>
 
-const uint8_t aurora_244pt7bBitmaps[] PROGMEM = {
+constexpr uint8_t aurora_244pt7bBitmaps[] PROGMEM = {
   0x00, 0xF4, 0xB4, 0x28, 0x53, 0xFF, 0xF2, 0x85, 0x00, 0x10, 0xFA, 0x48,
   0x87, 0xF2, 0x5F, 0x08, 0x46, 0xA5, 0x0A, 0x56, 0x20, 0x62, 0x40, 0x3D,
   0x89, 0xD0, 0xC0, 0x34, 0x88, 0x43, 0xC2, 0x11, 0x2C, 0x25, 0x7E, 0x40,
@@ -35,7 +35,7 @@ const uint8_t aurora_244pt7bBitmaps[] PROGMEM = {
   0xE0, 0xFD, 0xF8, 0x3F, 0x19, 0x01, 0xC2, 0x0C, 0xFC, 0xC1, 0x00, 0x72,
   0x60, 0x6C, 0x80 };
 
-const GFXglyph aurora_244pt7bGlyphs[] PROGMEM = {
+constexpr GFXglyph aurora_244pt7bGlyphs[] PROGMEM = {
   {     0,   1,   1,   4,    0,    0 },   // 0x20 ' '
   {     1,   1,   6,   2,    0,   -5 },   // 0x21 '!'
   {     2,   3,   2,   4,    0,   -5 },   // 0x22 '"'
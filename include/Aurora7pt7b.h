@@ -1,7 +1,7 @@
 #include <Arduino.h>
 #include <Adafruit_GFX.h>
 
-const uint8_t aurora_247pt7bBitmaps[] PROGMEM = {
+constexpr uint8_t aurora_247pt7bBitmaps[] PROGMEM = {
   0x00, 0xFF, 0xFF, 0x0C, 0xDE, 0xF6, 0x1B, 0x03, 0x60, 0x6C, 0x7F, 0xF1,
   0xB0, 0x36, 0x3F, 0xF8, 0xD8, 0x1B, 0x03, 0x60, 0x6C, 0x00, 0x0C, 0x01,
   0x80, 0xFE, 0x66, 0x3C, 0xC1, 0x98, 0x03, 0x01, 0xFC, 0x0C, 0x61, 0x8F,
@@ -99,7 +99,7 @@ const uint8_t aurora_247pt7bBitmaps[] PROGMEM = {
   0x07, 0xFF, 0xFF, 0xFC, 0xE0, 0x18, 0x18, 0x18, 0x00, 0x07, 0x18, 0x18,
   0x18, 0x00, 0xE0, 0x38, 0x80, 0x31, 0xC0 };
 
-const GFXglyph aurora_247pt7bGlyphs[] PROGMEM = {
+constexpr GFXglyph aurora_247pt7bGlyphs[] PROGMEM = {
   {     0,   1,   1,   8,    0,    0 },   // 0x20 ' '
   {     1,   2,  11,   4,    0,  -10 },   // 0x21 '!'
   {     4,   5,   3,   7,    0,  -10 },   // 0x22 '"'
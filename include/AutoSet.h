@@ -0,0 +1,43 @@
+// ==================== AutoSet.h (signal survey for auto-set) ====================
+// Looks at one short burst of samples, read straight through at the fastest
+// rate, for what auto-set needs: the levels the signal spans and its
+// dominant period. Samples stream through add() and nothing is stored.
+//
+// The first levelSamples only find the levels. After that, rising crossings
+// of the midpoint are counted, with hysteresis of an eighth of the
+// peak-to-peak so noise does not add crossings, and the period is the span
+// from the first counted crossing to the last over the number of periods in
+// between. Levels keep being tracked through the whole burst.
+#pragma once
+#include <stdint.h>
+#include <stddef.h>
+
+struct AutoSetSurvey
+{
+  uint32_t samples;  // burst length; 0 = the source gave nothing
+  uint32_t fs;       // rate the burst was read at
+  int16_t min, max;  // corrected codes
+  uint32_t periodQ8; // samples x 256; 0 = fewer than two crossings
+};
+
+class AutoSetProbe
+{
+public:
+  static constexpr int16_t MIN_HYSTERESIS = 8; // codes; about the ADC's noise
+
+  void begin(uint32_t fs, uint32_t levelSamples);
+  void add(const int16_t *s, size_t n);
+  AutoSetSurvey result() const;
+
+private:
+  uint32_t mFs = 0;
+  uint32_t mLevelSamples = 0;
+  uint32_t mPos = 0;
+  int16_t mMin = 0x7FFF, mMax = -0x7FFF;
+
+  // crossing detector, armed once the levels are known
+  int16_t mLow = 0, mHigh = 0;
+  bool mArmed = false; // went below mLow since the last crossing
+  uint32_t mFirstCrossing = 0, mLastCrossing = 0;
+  uint32_t mCrossings = 0;
+};
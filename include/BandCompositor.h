@@ -0,0 +1,48 @@
+// ==================== BandCompositor.h (off-screen plot composition) ====================
+// Builds the whole plot area in RAM one horizontal band at a time — the
+// background (PlotBackground.h), then the traces — and sends each band as a
+// single window write. Two band buffers alternate so band N+1 is composed
+// while band N is still being transmitted (non-blocking writePixels() +
+// dmaWait() on targets where Adafruit_SPITFT has DMA; elsewhere the push is
+// still one burst per band). Every frame costs the same, and the panel never
+// shows a half-erased trace.
+//
+// drawPhosphor() composes a persistence image (Phosphor.h) the same way, but
+// only sends the bands that hold counts now or did at the last push; the
+// rest of the plot already shows the background on the panel.
+#pragma once
+#include <stdint.h>
+#include "DisplayTraits.h"
+#include "ScopeLayout.h"
+#include "TraceRenderer.h" // SpiStats, TraceSpans, SPI cost model
+#include "PlotBackground.h"
+
+class Phosphor;
+
+class BandCompositor
+{
+public:
+  static constexpr int BAND_ROWS = ScopeDisplay::BAND_ROWS;
+  static constexpr int BAND_COUNT = (PLOT_H + BAND_ROWS - 1) / BAND_ROWS;
+
+  // Composes and pushes the full plot for the given traces; the first is on top.
+  // Takes the background's changes, as every row is sent.
+  void draw(ScopePanel &tft, const TraceSpans *traces, int count, PlotBackground &bg);
+
+  // Pushes the bands of a persistence image that changed since the last
+  // call, or whose background did.
+  void drawPhosphor(ScopePanel &tft, const Phosphor &ph, PlotBackground &bg);
+  // The plot was drawn over by something else: drawPhosphor() sends it all next time.
+  void invalidate();
+
+  const SpiStats &lastFrame() const { return mStats; }
+
+private:
+  void composeBackground(uint16_t *buf, int y0, int rows, const PlotBackground &bg) const;
+  void compose(uint16_t *buf, int y0, int rows, const TraceSpans *traces, int count, const PlotBackground &bg) const;
+  void push(ScopePanel &tft, uint16_t *buf, int y0, int rows);
+
+  SpiStats mStats;
+  bool mStale[BAND_COUNT] = {}; // band on the panel is more than the background
+  uint16_t mBand[2][PLOT_W * BAND_ROWS];
+};
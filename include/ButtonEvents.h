@@ -0,0 +1,109 @@
+// ==================== ButtonEvents.h (interrupt-driven button gestures) ====================
+// Each button pin raises an interrupt on every edge; the ISR only stamps the
+// edge with micros() and pushes it onto a lock-free ring, so a press is seen
+// however long the frame that is drawing when it happens. The loop drains
+// the ring with next(), which debounces on those timestamps and turns held
+// buttons into gestures:
+//
+//   PRESS   as soon as the first edge of a press is accepted
+//   REPEAT  every REPEAT_US once held past REPEAT_DELAY_US (repeat buttons)
+//   LONG    once, when held past LONG_US (long-press buttons)
+//   CLICK   on release, unless LONG already fired
+//
+// Debouncing takes the leading edge and ignores the pin for DEBOUNCE_US
+// after it; a level that settled differently during that lockout (a short
+// tap, or edges lost to a full ring) is picked up when the lockout ends.
+// Buttons are active-low with pull-ups.
+#pragma once
+#include <stdint.h>
+#include <stddef.h>
+#include <atomic>
+
+enum ButtonGesture : uint8_t
+{
+  BTN_PRESS,
+  BTN_REPEAT,
+  BTN_LONG,
+  BTN_CLICK,
+};
+
+struct ButtonEvent
+{
+  uint8_t button; // index into the config passed to begin()
+  ButtonGesture gesture;
+  uint16_t repeats; // REPEAT events so far in this hold, this one included
+};
+
+struct ButtonConfig
+{
+  uint8_t pin;
+  bool repeat;    // auto-repeat while held
+  bool longPress; // LONG after LONG_US
+};
+
+class ButtonEvents
+{
+public:
+  static constexpr int MAX_BUTTONS = 8;
+  static constexpr uint32_t DEBOUNCE_US = 20000;
+  static constexpr uint32_t REPEAT_DELAY_US = 400000;
+  static constexpr uint32_t REPEAT_US = 100000;
+  static constexpr uint32_t LONG_US = 700000;
+
+  // Sets the pins up as pulled-up inputs and attaches their interrupts
+  void begin(const ButtonConfig *cfg, int n);
+
+  // Next gesture, if any. Call until false once per loop().
+  bool next(ButtonEvent &e);
+
+  uint32_t edgesLost() const { return mLost.load(std::memory_order_relaxed); }
+
+private:
+  static constexpr uint8_t EDGE_RING = 32; // power of two
+  static constexpr uint8_t OUT_RING = 16;
+
+  struct Edge
+  {
+    uint32_t us;
+    uint8_t button;
+    bool down;
+  };
+
+  // Handed to the ISR as its argument
+  struct PinRef
+  {
+    ButtonEvents *owner;
+    uint8_t button;
+  };
+
+  struct State
+  {
+    bool down;          // debounced
+    bool longFired;
+    uint16_t repeats;
+    uint32_t acceptedUs; // last accepted edge
+    uint32_t nextRepeatUs;
+  };
+
+  static void onEdge(void *arg); // ISR
+  bool readDown(uint8_t button) const;
+
+  void service(uint32_t nowUs);
+  void accept(uint8_t button, bool down, uint32_t us);
+  void emit(uint8_t button, ButtonGesture g);
+
+  ButtonConfig mCfg[MAX_BUTTONS] = {};
+  PinRef mRefs[MAX_BUTTONS] = {};
+  State mState[MAX_BUTTONS] = {};
+  int mCount = 0;
+
+  // ISR -> loop
+  Edge mEdges[EDGE_RING] = {};
+  std::atomic<uint8_t> mEdgeHead{0}, mEdgeTail{0};
+  std::atomic<bool> mLevel[MAX_BUTTONS] = {}; // latest raw level, true = down
+  std::atomic<uint32_t> mLost{0};
+
+  // Gestures waiting for next(); loop side only
+  ButtonEvent mOut[OUT_RING] = {};
+  uint8_t mOutHead = 0, mOutTail = 0;
+};
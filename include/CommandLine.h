@@ -0,0 +1,48 @@
+// ==================== CommandLine.h (non-blocking serial command lines) ====================
+// Assembles a command line from whatever bytes have arrived, one push() per
+// byte, in a fixed buffer: nothing waits for the rest of the line and
+// nothing is allocated. A completed line is split in place into commands at
+// ';', and each command into a key and a value at '=' or the first space,
+// so "fs=20000; px 4; trig=normal" is three commands.
+#pragma once
+#include <stdint.h>
+#include <stddef.h>
+
+class CommandLine
+{
+public:
+  static constexpr size_t MAX_LEN = 96;
+
+  // True when c ended a non-empty line, which line() then holds until the
+  // next push(). Backspace edits; a line past MAX_LEN is cut off and
+  // flagged.
+  bool push(char c);
+
+  bool empty() const { return mLen == 0 || mDone; }
+  char *line() { return mBuf; }
+  bool overflowed() const { return mOverflow; }
+
+private:
+  char mBuf[MAX_LEN + 1] = {};
+  size_t mLen = 0;
+  bool mDone = false;
+  bool mOverflow = false;
+};
+
+// Next ';'-separated command of a line, trimmed, advancing s past it;
+// nullptr once the line is used up. Empty commands are skipped.
+char *nextCommand(char *&s);
+
+// One command: a key and its value, split at the first '=', or failing
+// that the first space, or failing that where a number follows the leading
+// letters ("f8000"). The key is not terminated in that last case.
+struct Command
+{
+  const char *key;
+  size_t keyLen;
+  char *value; // trimmed; "" if none
+
+  bool keyIs(const char *name) const; // case-insensitive
+};
+
+Command splitCommand(char *cmd);
@@ -0,0 +1,12 @@
+// ==================== CycleCount.h (CPU cycle timestamps) ====================
+#pragma once
+#include <Arduino.h>
+
+#if defined(ARDUINO_ARCH_ESP32)
+static inline uint32_t cycleCount() { return ESP.getCycleCount(); } // CCOUNT register
+static inline uint32_t cpuHz() { return getCpuFrequencyMhz() * 1000000UL; }
+#else
+// Host builds: micros() scaled to a nominal 240 MHz core so figures compare with the board
+static inline uint32_t cycleCount() { return micros() * 240UL; }
+static inline uint32_t cpuHz() { return 240000000UL; }
+#endif
@@ -0,0 +1,47 @@
+// ==================== Decimator.h (many samples per plot column) ====================
+// Streaming reduction of the raw sample stream for timebases longer than one
+// sample per pixel. It sits in front of the trigger, so the trigger history
+// and the frame stay one plot wide however many samples a column covers.
+//
+// Peak mode keeps the lowest and highest sample of every group, in the order
+// they occurred: a one-sample glitch still lights its column from end to end,
+// and the trigger still sees edges going the right way. Average mode is a
+// first-order CIC (boxcar sum-and-dump) giving one mean per group, trading
+// glitches for less noise.
+#pragma once
+#include <stdint.h>
+#include <stddef.h>
+
+enum DecimMode : uint8_t
+{
+  DECIM_PEAK,
+  DECIM_AVERAGE,
+  DECIM_MODE_COUNT
+};
+
+class Decimator
+{
+public:
+  // factor samples per group (>= 2); drops any partly accumulated group.
+  void configure(uint16_t factor, DecimMode mode);
+  void reset();
+
+  uint16_t factor() const { return mFactor; }
+  DecimMode mode() const { return mMode; }
+  uint8_t outputsPerGroup() const { return mMode == DECIM_PEAK ? 2 : 1; }
+  uint16_t pending() const { return mCount; } // samples in the group not yet emitted
+
+  // Reduces n samples and returns how many values went to out (at most n).
+  // A group may straddle calls.
+  size_t process(const int16_t *in, size_t n, int16_t *out);
+
+private:
+  uint16_t mFactor = 2;
+  DecimMode mMode = DECIM_PEAK;
+  uint16_t mCount = 0; // samples in the current group
+  int32_t mSum = 0;
+  int16_t mMin = 0;
+  int16_t mMax = 0;
+  uint16_t mMinAt = 0; // positions in the group, to emit the extremes in time order
+  uint16_t mMaxAt = 0;
+};
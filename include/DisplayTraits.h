@@ -0,0 +1,79 @@
+// ==================== DisplayTraits.h (panel type and geometry per target) ====================
+// What the scope needs to know about its panel, as one traits type picked at
+// compile time: the driver class, the landscape resolution, the pixel format
+// on the wire (for the SPI cost model), how much the draw modules stage per
+// transfer, and how to drive the hardware scroll. ScopeLayout.h derives the
+// plot geometry from it, so every buffer and table is sized for the target
+// and nothing about the panel is looked up at run time.
+//
+// The default is the 320x240 ILI9341; build with -DSCOPE_DISPLAY_ILI9488 for
+// a 480x320 ILI9488 (a driver on Adafruit_SPITFT that provides
+// Adafruit_ILI9488). Both take RGB565 from the sketch: the ILI9488 only
+// speaks 18-bit colour over SPI, so its driver expands each pixel to three
+// bytes on the way out.
+#pragma once
+#include <stdint.h>
+
+enum PixelFormat : uint8_t
+{
+  PIXEL_RGB565, // 2 bytes per pixel on the wire
+  PIXEL_RGB666, // 3 bytes per pixel on the wire
+};
+
+constexpr uint32_t pixelBytes(PixelFormat f) { return f == PIXEL_RGB565 ? 2 : 3; }
+
+#if defined(SCOPE_DISPLAY_ILI9488)
+#include <Adafruit_ILI9488.h>
+
+struct Ili9488Traits
+{
+  using Panel = Adafruit_ILI9488;
+  static constexpr int WIDTH = 480; // rotation 1
+  static constexpr int HEIGHT = 320;
+  static constexpr PixelFormat FORMAT = PIXEL_RGB666;
+  static constexpr uint32_t SPI_HZ = 40000000;
+  static constexpr int BURST_PIXELS = 1024; // span renderer staging, per writePixels()
+  static constexpr int BAND_ROWS = 8;       // band compositor rows per buffer (two buffers)
+
+  // Hardware scroll runs along the panel's 480-line axis (screen x here).
+  // The driver has no helpers for it, so the commands go out directly.
+  static constexpr uint16_t SCROLL_LINES = 480;
+  static void setScrollMargins(Panel &tft, uint16_t fixedLeft, uint16_t fixedRight)
+  {
+    const uint16_t area = SCROLL_LINES - fixedLeft - fixedRight;
+    uint8_t vscrdef[6] = {(uint8_t)(fixedLeft >> 8), (uint8_t)fixedLeft, (uint8_t)(area >> 8), (uint8_t)area,
+                          (uint8_t)(fixedRight >> 8), (uint8_t)fixedRight};
+    tft.sendCommand(0x33, vscrdef, sizeof(vscrdef));
+  }
+  static void scrollTo(Panel &tft, uint16_t line)
+  {
+    uint8_t vscrsadd[2] = {(uint8_t)(line >> 8), (uint8_t)line};
+    tft.sendCommand(0x37, vscrsadd, sizeof(vscrsadd));
+  }
+};
+using ScopeDisplay = Ili9488Traits;
+
+#else
+#include <Adafruit_ILI9341.h>
+
+struct Ili9341Traits
+{
+  using Panel = Adafruit_ILI9341;
+  static constexpr int WIDTH = 320; // rotation 1
+  static constexpr int HEIGHT = 240;
+  static constexpr PixelFormat FORMAT = PIXEL_RGB565;
+  static constexpr uint32_t SPI_HZ = 40000000; // the library's ESP32 default
+  static constexpr int BURST_PIXELS = 1024;    // span renderer staging, per writePixels()
+  static constexpr int BAND_ROWS = 16;         // band compositor rows per buffer (two buffers)
+
+  // Hardware scroll runs along the panel's 320-line axis (screen x here)
+  static void setScrollMargins(Panel &tft, uint16_t fixedLeft, uint16_t fixedRight)
+  {
+    tft.setScrollMargins(fixedLeft, fixedRight);
+  }
+  static void scrollTo(Panel &tft, uint16_t line) { tft.scrollTo(line); }
+};
+using ScopeDisplay = Ili9341Traits;
+#endif
+
+using ScopePanel = ScopeDisplay::Panel;
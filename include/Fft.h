@@ -0,0 +1,52 @@
+// ==================== Fft.h (fixed-point real FFT for the spectrum view) ====================
+// Q15 radix-2 FFT. A real frame of N samples is packed into N/2 complex
+// points, transformed, then split into the N/2+1 bins of the real spectrum.
+// Twiddles, bit-reversal and window tables are built by the compiler
+// (constexpr) at the largest size and strided for smaller ones, so there is
+// no table setup at boot. Stages use block floating point: the data is halved
+// only before a stage that could overflow, which keeps small signals out of
+// the truncation noise.
+#pragma once
+#include <stdint.h>
+
+constexpr int FFT_MIN = 256;
+constexpr int FFT_MAX = 2048;
+
+enum FftWindow : uint8_t
+{
+  WIN_HANN,
+  WIN_BLACKMAN,
+  WIN_FLATTOP,
+  WIN_COUNT
+};
+
+constexpr int16_t FFT_DB_FLOOR = -1200; // 0.1 dB units
+
+// Loudest of the bins that land on pixel pos when 0..Fs/2 is spread over
+// `positions` pixels (db holds the bins = n/2+1 values from run()).
+int16_t fftPeakAt(const int16_t *db, int bins, int pos, int positions);
+
+class RealFft
+{
+public:
+  // Transforms n samples (n a power of two in FFT_MIN..FFT_MAX) after removing
+  // dc and applying the window. Writes n/2+1 magnitudes to outDb in 0.1 dB
+  // relative to a full-scale (±2048 code) sine, floored at FFT_DB_FLOOR.
+  // outDb may be the samples buffer itself: input is consumed before output is written.
+  void run(const int16_t *samples, int n, int16_t dc, FftWindow w, int16_t *outDb);
+
+  // CPU cycles spent in the last run()
+  uint32_t lastCycles() const { return mCycles; }
+
+  static const char *windowName(FftWindow w);
+
+private:
+  void prepareReference(int n, FftWindow w);
+
+  int16_t mRe[FFT_MAX / 2];
+  int16_t mIm[FFT_MAX / 2];
+  uint32_t mCycles = 0;
+  int mRefN = 0;
+  FftWindow mRefWin = WIN_COUNT;
+  int32_t mRefDb = 0; // 0.1 dB level of a full-scale sine for (mRefN, mRefWin)
+};
@@ -0,0 +1,87 @@
+// ==================== FilterChain.h (fixed-point sample filters) ====================
+// Runs on every source sample before the record, trigger and measurements
+// see it (the stream sends the raw codes), in place on 12-bit codes:
+//
+//   DC tracker  one-pole low-pass of the input, always running, so the offset
+//               follows bias and thermal drift instead of being measured once
+//               at boot. With blocking on (AC coupling) it is subtracted and
+//               the signal re-centred on ADC_MID.
+//   biquad      optional 2nd-order low-pass or band-pass (RBJ cookbook)
+//   FIR         optional windowed-sinc low-pass, FIR_TAPS taps
+//
+// Samples are Q15 fractions of full scale inside the chain, and FIR taps are
+// Q15. Biquad coefficients are Q2.30 with 64-bit sums: a low corner puts
+// them within a Q15 step of 0 or 2. Coefficients are worked out in floating
+// point by configure(), only when Fs or the settings change. The DC
+// tracker's pole is a shift, 2^-k per sample, picked from Fs to keep its
+// corner near DC_CORNER_HZ.
+#pragma once
+#include <stdint.h>
+#include <stddef.h>
+
+constexpr int16_t ADC_MID = 2048;
+
+enum BiquadType : uint8_t
+{
+  BIQUAD_OFF,
+  BIQUAD_LOWPASS,
+  BIQUAD_BANDPASS,
+  BIQUAD_TYPE_COUNT
+};
+
+struct FilterSettings
+{
+  bool dcBlock = false; // AC coupling; off so traces keep the DC the volt axis shows
+  BiquadType biquad = BIQUAD_OFF;
+  uint32_t biquadHz = 1000;
+  float biquadQ = 0.7071f;
+  uint32_t firHz = 0; // FIR low-pass cutoff; 0 = off
+};
+
+class FilterChain
+{
+public:
+  static constexpr int FIR_TAPS = 31;
+  static constexpr float DC_CORNER_HZ = 2.0f;
+
+  // New coefficients for fs; filter state restarts, the DC estimate is kept.
+  void configure(const FilterSettings &s, uint32_t fs);
+  void process(int16_t *s, size_t n);
+
+  // DC of the input, and where the output's DC sits (ADC_MID when blocking)
+  int16_t inputDC() const { return (int16_t)((mDcAcc + 0x8000) >> 16); }
+  int16_t outputDC() const
+  {
+    return mSettings.dcBlock || mSettings.biquad == BIQUAD_BANDPASS ? ADC_MID : inputDC();
+  }
+  const FilterSettings &settings() const { return mSettings; }
+  // Corner frequencies actually used, after clamping to what Fs allows
+  uint32_t biquadHz() const { return mBiquadHz; }
+  uint32_t firHz() const { return mFirHz; }
+
+  // Average cost since the last call, in CPU cycles per sample
+  uint32_t takeCyclesPerSample();
+
+private:
+  void reset();
+  void designBiquad(uint32_t fs);
+  void designFir(uint32_t fs);
+
+  FilterSettings mSettings;
+  uint8_t mDcShift = 10;
+  bool mDcPrimed = false;
+  int32_t mDcAcc = (int32_t)ADC_MID << 16; // Q16 raw codes
+
+  uint32_t mBiquadHz = 0;
+  int32_t mB[3] = {}, mA[2] = {}; // Q2.30
+  int32_t mX1 = 0, mX2 = 0, mY1 = 0, mY2 = 0;
+  int64_t mErr = 0; // output bits below Q15, carried into the next sample
+
+  uint32_t mFirHz = 0;
+  int16_t mTaps[FIR_TAPS] = {};        // Q15
+  int16_t mFirHist[2 * FIR_TAPS] = {}; // twice over, so a window never wraps
+  int mFirPos = 0;
+
+  uint32_t mCycles = 0;
+  uint32_t mSamples = 0;
+};
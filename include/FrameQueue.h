@@ -0,0 +1,164 @@
+// ==================== FrameQueue.h (capture -> render hand-off) ====================
+// Lock-free single-producer/single-consumer queue of preallocated frames.
+// No heap, no RTOS calls: only std::atomic, so the same code runs between the
+// two ESP32 cores and between std::threads on a host.
+//
+// Ownership: every buffer is always held by exactly one party — the producer
+// (being filled), the queue, the consumer (being drawn) or the free ring —
+// so neither side ever touches memory the other may be using. When the queue
+// is full the producer drops the *oldest* queued frame and reuses its buffer,
+// so the display always gets the freshest data.
+#pragma once
+#include <stdint.h>
+#include <stddef.h>
+#include <atomic>
+#include "Measure.h"
+
+// CAPACITY_B: room for a second channel, 0 for none
+template <size_t CAPACITY, size_t CAPACITY_B = 0>
+struct SampleFrame
+{
+  static constexpr size_t MAX_SAMPLES = CAPACITY;
+  static constexpr size_t MAX_SAMPLES_B = CAPACITY_B;
+
+  uint32_t seq;     // producer frame counter; gaps mean frames were dropped
+  uint32_t fs;      // sample rate the frame was captured at
+  uint8_t view;     // display mode the frame was made for (samples or spectrum)
+  uint8_t traces;   // which channels, and how they are combined
+  uint8_t pxPerSample;
+  uint16_t samplesPerPx; // > 1 when decimated
+  bool envelope;         // samples[] holds min/max pairs, two per column
+  uint16_t count;   // valid entries in samples[]
+  bool triggered;   // false when the trigger free-ran (auto timeout)
+  uint32_t endSample; // SampleRecord::total() just past the frame's last sample
+  Measurements meas;  // of the source samples read since the previous frame
+  int16_t samples[CAPACITY];
+  int16_t samplesB[CAPACITY_B ? CAPACITY_B : 1]; // count entries when the frame has channel B
+};
+
+template <typename FRAME, size_t DEPTH>
+class FrameQueue
+{
+  static_assert(DEPTH >= 1 && DEPTH <= 250, "DEPTH must fit the uint8_t buffer indices");
+
+public:
+  static constexpr size_t BUFFERS = DEPTH + 2; // queued + one per side
+
+  FrameQueue()
+  {
+    // Buffer 0 starts with the producer, the rest wait in the free ring.
+    mWriteIdx = 0;
+    for (size_t i = 1; i < BUFFERS; ++i)
+      mFree[i - 1].store((uint8_t)i, std::memory_order_relaxed);
+    mFreeHead.store(0, std::memory_order_relaxed);
+    mFreeTail.store(BUFFERS - 1, std::memory_order_relaxed);
+  }
+
+  // ---- producer side ----
+  FRAME &writeFrame() { return mFrames[mWriteIdx]; }
+
+  // Publishes writeFrame() and hands the producer a fresh buffer.
+  void push()
+  {
+    const uint32_t t = mTail.load(std::memory_order_relaxed);
+    uint32_t h = mHead.load(std::memory_order_acquire);
+    int next = -1;
+    if (t - h >= DEPTH)
+    {
+      // Full: claim the oldest entry. If the consumer wins the race instead,
+      // a slot has just opened up and nothing needs dropping.
+      uint8_t oldest = mSlots[h % DEPTH].load(std::memory_order_relaxed);
+      if (mHead.compare_exchange_strong(h, h + 1, std::memory_order_acq_rel, std::memory_order_acquire))
+      {
+        next = oldest;
+        mDropped.fetch_add(1, std::memory_order_relaxed);
+      }
+    }
+    mSlots[t % DEPTH].store(mWriteIdx, std::memory_order_relaxed);
+    mTail.store(t + 1, std::memory_order_release);
+    mPushed.fetch_add(1, std::memory_order_relaxed);
+
+    if (next < 0)
+      next = freePop(); // never empty: see ownership note above
+    mWriteIdx = (uint8_t)next;
+  }
+
+  // ---- consumer side ----
+  // Returns the oldest queued frame, or nullptr if none. The frame stays valid
+  // until the next pop()/release(); the previous one is recycled first.
+  const FRAME *pop()
+  {
+    release();
+    uint32_t h = mHead.load(std::memory_order_acquire);
+    for (;;)
+    {
+      const uint32_t t = mTail.load(std::memory_order_acquire);
+      if (h == t)
+        return nullptr;
+      uint8_t idx = mSlots[h % DEPTH].load(std::memory_order_relaxed);
+      if (mHead.compare_exchange_weak(h, h + 1, std::memory_order_acq_rel, std::memory_order_acquire))
+      {
+        mReadIdx = idx;
+        return &mFrames[idx];
+      }
+    }
+  }
+
+  // Gives the frame returned by pop() back without taking another.
+  void release()
+  {
+    if (mReadIdx < 0)
+      return;
+    freePush((uint8_t)mReadIdx);
+    mReadIdx = -1;
+  }
+
+  // Discards everything queued (consumer side only).
+  void drain()
+  {
+    while (pop())
+    {
+    }
+    release();
+  }
+
+  // ---- counters (any thread) ----
+  uint32_t pushed() const { return mPushed.load(std::memory_order_relaxed); }
+  uint32_t dropped() const { return mDropped.load(std::memory_order_relaxed); }
+  size_t size() const { return mTail.load(std::memory_order_acquire) - mHead.load(std::memory_order_acquire); }
+
+private:
+  // Free ring: consumer pushes, producer pops. Holds at most BUFFERS entries.
+  void freePush(uint8_t idx)
+  {
+    const uint32_t t = mFreeTail.load(std::memory_order_relaxed);
+    mFree[t % BUFFERS].store(idx, std::memory_order_relaxed);
+    mFreeTail.store(t + 1, std::memory_order_release);
+  }
+
+  int freePop()
+  {
+    const uint32_t h = mFreeHead.load(std::memory_order_relaxed);
+    if (h == mFreeTail.load(std::memory_order_acquire))
+      return -1;
+    uint8_t idx = mFree[h % BUFFERS].load(std::memory_order_relaxed);
+    mFreeHead.store(h + 1, std::memory_order_release);
+    return idx;
+  }
+
+  FRAME mFrames[BUFFERS];
+
+  std::atomic<uint8_t> mSlots[DEPTH];
+  std::atomic<uint32_t> mHead{0}; // advanced by the consumer, or by the producer when dropping
+  std::atomic<uint32_t> mTail{0}; // producer only
+
+  std::atomic<uint8_t> mFree[BUFFERS];
+  std::atomic<uint32_t> mFreeHead{0};
+  std::atomic<uint32_t> mFreeTail{0};
+
+  uint8_t mWriteIdx; // producer-owned buffer
+  int mReadIdx = -1; // consumer-owned buffer, -1 when none
+
+  std::atomic<uint32_t> mPushed{0};
+  std::atomic<uint32_t> mDropped{0};
+};
@@ -0,0 +1,68 @@
+// ==================== Measure.h (running waveform measurements) ====================
+// Min/max, mean, AC RMS and period, accumulated sample by sample as capture
+// reads the source, with integer sums only. take() closes the window (one
+// per frame) and starts the next, so nothing makes a second pass over the
+// samples.
+//
+// Sums are kept relative to a pivot, the previous window's mean, so the
+// squares stay small and the variance keeps its low bits. Rising crossings
+// of the signal's mean, with hysteresis scaled to its peak-to-peak, time
+// the period; they carry across windows, so a period longer than one
+// window still gets measured. The crossing level is the mean over whole
+// cycles, and while a period is known it is only revisited once a cycle
+// has completed: a window that holds part of a cycle would tilt it.
+#pragma once
+#include <stdint.h>
+#include <stddef.h>
+
+struct Measurements
+{
+  uint32_t samples; // window length; 0 = nothing measured
+  int16_t min, max; // raw codes
+  int32_t meanQ8;   // raw code x 256
+  uint32_t rmsQ8;   // RMS about the mean (AC), raw code x 256
+  uint32_t periodQ8; // samples x 256; 0 = no period seen
+};
+
+class MeasureAccumulator
+{
+public:
+  static constexpr uint32_t MAX_WINDOW = 1u << 20; // the sums restart past this
+
+  void add(const int16_t *s, size_t n);
+  // The window so far; starts the next one.
+  Measurements take();
+  // The next sample does not follow on from the last (flush, rate change).
+  void restart();
+
+private:
+  void clearSums();
+  void clearLevel();
+
+  // window
+  uint32_t mCount = 0;
+  int64_t mSum = 0;   // of (sample - pivot)
+  uint64_t mSumSq = 0;
+  int16_t mMin = 0x7FFF, mMax = -0x7FFF;
+  uint64_t mIntervals = 0; // total samples between successive rising crossings
+  uint32_t mIntervalCount = 0;
+
+  // from the previous window
+  int16_t mPivot = 2048;
+  uint32_t mPeriodQ8 = 0;
+
+  // crossing detector, continuous across windows
+  int16_t mLow = 2048 - 16, mHigh = 2048 + 16;
+  uint32_t mPos = 0;          // samples since restart()
+  int64_t mTotal = 0;         // of every sample since restart()
+  uint32_t mLastCrossing = 0; // mPos at the last rising crossing
+  int64_t mLastCrossingTotal = 0;
+  bool mHaveCrossing = false;
+  bool mSkipInterval = false; // the level moved since the last crossing
+  bool mArmed = false;        // went below mLow since the last crossing
+
+  // whole cycles, and the extremes, since the crossing level was last set
+  int64_t mCycleSum = 0;
+  uint32_t mCycleLen = 0;
+  int16_t mLevelMin = 0x7FFF, mLevelMax = -0x7FFF;
+};
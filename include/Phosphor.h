@@ -0,0 +1,91 @@
+// ==================== Phosphor.h (intensity-graded persistence) ====================
+// An 8-bit hit count per plot pixel, like the phosphor of an analogue scope:
+// every frame's trace adds to the pixels it covers, and every frame all
+// counts decay by a fixed fraction, so a trace that keeps landing on the
+// same pixels glows hot while rare excursions fade. Counts are shown through
+// a colour ramp built at compile time (BandCompositor::drawPhosphor()).
+//
+// Decay works on four pixels per 32-bit word: one shift-and-mask for the
+// exponential part and one more to take a final count off each pixel still
+// lit, so nothing lingers at a low count forever. Bands of rows that hold no
+// counts are skipped altogether.
+//
+// The counts take a byte per plot pixel (116 KB on a 480x320 panel), so
+// they live on the heap, in PSRAM when there is some.
+#pragma once
+#include <stdint.h>
+#include <stddef.h>
+#include "ScopeLayout.h"
+#include "BandCompositor.h"
+
+// -------------------- compile-time colour ramp --------------------
+struct PhosphorRamp
+{
+  uint16_t color[256]; // RGB565 per hit count; [0] is never drawn
+};
+
+constexpr uint16_t rgb565(int r, int g, int b)
+{
+  return (uint16_t)(((r & 0xF8) << 8) | ((g & 0xFC) << 3) | (b >> 3));
+}
+
+// Dim blue for the rarest hits, through cyan, green and yellow, to white
+constexpr PhosphorRamp makePhosphorRamp()
+{
+  constexpr int STOPS = 6;
+  constexpr int at[STOPS] = {1, 40, 90, 150, 210, 255};
+  constexpr uint8_t rgb[STOPS][3] = {{0, 0, 110}, {0, 90, 255}, {0, 230, 200}, {60, 255, 0}, {255, 230, 0}, {255, 255, 255}};
+  PhosphorRamp ramp{};
+  for (int i = 1; i < 256; ++i)
+  {
+    int s = 0;
+    while (s + 2 < STOPS && i > at[s + 1])
+      ++s;
+    const int span = at[s + 1] - at[s];
+    const int t = i - at[s];
+    int c[3] = {};
+    for (int k = 0; k < 3; ++k)
+      c[k] = (rgb[s][k] * (span - t) + rgb[s + 1][k] * t) / span;
+    ramp.color[i] = rgb565(c[0], c[1], c[2]);
+  }
+  return ramp;
+}
+
+constexpr PhosphorRamp PHOSPHOR_RAMP = makePhosphorRamp();
+
+// -------------------- hit buffer --------------------
+class Phosphor
+{
+public:
+  static constexpr uint8_t HIT = 64; // added per frame the trace covers a pixel
+  static constexpr uint8_t DECAY_MIN = 1;
+  static constexpr uint8_t DECAY_MAX = 6;
+
+  // Each frame keeps 1 - 2^-shift of every count: 1 fades within a few
+  // frames, 6 keeps a trace for a hundred or more
+  void setDecay(uint8_t shift);
+
+  // Takes the hit buffer; without one the image stays dark
+  bool allocate();
+  uint8_t decayShift() const { return mShift; }
+
+  void clear();
+  void decay();
+  // Adds the column spans of one frame (screen rows, as TraceRenderer makes them)
+  void addSpans(const int16_t *top, const int16_t *bot);
+  // Adds single points (screen coordinates; those off the plot are dropped), for XY
+  void addPoints(const int16_t *xs, const int16_t *ys, size_t n);
+
+  const uint8_t *row(int plotY) const { return (const uint8_t *)mHits + plotY * PLOT_W; }
+  bool bandLit(int band) const { return mBandLit[band]; }
+
+private:
+  static constexpr size_t BAND_BYTES = (size_t)BandCompositor::BAND_ROWS * PLOT_W;
+  static_assert(BAND_BYTES % 4 == 0 && ((size_t)PLOT_H * PLOT_W) % 4 == 0,
+                "bands must start on a word boundary");
+  static constexpr size_t WORDS = (size_t)PLOT_H * PLOT_W / 4;
+
+  uint32_t *mHits = nullptr; // PLOT_H rows of PLOT_W counts
+  bool mBandLit[BandCompositor::BAND_COUNT] = {}; // any count in the band
+  uint8_t mShift = 3;
+};
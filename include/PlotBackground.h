@@ -0,0 +1,67 @@
+// ==================== PlotBackground.h (what lies under the traces) ====================
+// The plot's background as a model rather than pixels on the panel: fill
+// colour, graticule rows and columns, and dashed reference cursors (DC,
+// trigger level). It is rebuilt only when a setting moves a line. Lookups
+// are per row and per column, so a renderer that erases a trace pixel
+// restores whatever belongs there in O(1) instead of painting the fill
+// colour over a grid line.
+//
+// Rows whose background changed are remembered until the renderer that
+// draws next has repainted them (takeChanges()), so a moved cursor costs two
+// rows, and a new graticule one plot.
+#pragma once
+#include <stdint.h>
+#include "ScopeLayout.h"
+
+class PlotBackground
+{
+public:
+  static constexpr int MAX_CURSORS = 4;
+
+  PlotBackground() { updateRowCursors(); }
+
+  void setFill(uint16_t colBg);
+  // Graticule: screen rows of the horizontal lines and screen columns of the vertical ones.
+  void setGrid(const int16_t *rows, int nRows, const int16_t *cols, int nCols, uint16_t colGrid565);
+  void setGridVisible(bool on);
+  // 4-on/4-off dashed horizontal line at screen row y; a row outside the plot hides the cursor.
+  void setCursor(int index, int y, uint16_t color);
+
+  // x: plot column, y: screen row
+  uint16_t at(int x, int y) const
+  {
+    const int r = y - PLOT_Y0;
+    const int8_t c = mRowCursor[r];
+    if (c >= 0 && (x & 4) == 0)
+      return mCursorCol[c];
+    if (mGridVisible && (mRowGrid[r] || mColGrid[x]))
+      return mColGrid565;
+    return mColBg;
+  }
+  // One plot row, PLOT_W pixels
+  void composeRow(uint16_t *line, int y) const;
+
+  // Sends the whole background and forgets pending changes.
+  void paint(ScopePanel &tft);
+
+  bool changed() const { return mAnyChanged; }
+  bool rowChanged(int y) const { return mChanged[y - PLOT_Y0]; }
+  void takeChanges();
+
+private:
+  void markRow(int y);
+  void markAll();
+  void updateRowCursors();
+
+  uint16_t mColBg = 0;
+  bool mRowGrid[PLOT_H] = {};
+  bool mColGrid[PLOT_W] = {};
+  uint16_t mColGrid565 = 0;
+  bool mGridVisible = true;
+  int16_t mCursorY[MAX_CURSORS] = {-1, -1, -1, -1};
+  uint16_t mCursorCol[MAX_CURSORS] = {};
+  int8_t mRowCursor[PLOT_H]; // cursor drawn on each row (the last listed wins), or -1
+  bool mChanged[PLOT_H] = {};
+  bool mAnyChanged = false;
+  uint16_t mRow[PLOT_W]; // paint() staging
+};
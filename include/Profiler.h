@@ -0,0 +1,86 @@
+// ==================== Profiler.h (hot-path cycle histograms) ====================
+// Scoped CCOUNT timers around the stages of a frame, each feeding a fixed-size
+// log-scale histogram, so a slow frame can be pinned on capture, sample
+// mapping, the SPI pushes, the VU, the measurements, the sample filters or
+// the serial handler.
+// Dumped with the `stats` serial command, cleared with `stats reset`.
+//
+// Build with -DSCOPE_PROFILE to enable; otherwise PROFILE_SCOPE() expands to
+// nothing and none of this is compiled.
+#pragma once
+#include <stdint.h>
+
+enum ProfStage : uint8_t
+{
+  PROF_LOOP,    // one pass of loop()
+  PROF_SERIAL,  // handleSerial()
+  PROF_BUTTONS, // handleButtons()
+  PROF_CAPTURE, // captureFrame(), on the capture core when there is one
+  PROF_FFT,     // RealFft::run() inside capture
+  PROF_MAP,     // samples -> y / column spans
+  PROF_DRAW,    // pushing the trace (or per-pixel storm, or waterfall line)
+  PROF_VU,      // updateVU()
+  PROF_MEASURE, // measurement accumulation inside capture
+  PROF_HUD,     // measurement panel refresh
+  PROF_FILTER,  // FilterChain::process() inside capture
+  PROF_STAGE_COUNT
+};
+
+#if defined(SCOPE_PROFILE)
+#include <Arduino.h>
+#include "CycleCount.h"
+
+// Counts in buckets four per power of two (<= 19% wide) from 1 cycle to
+// 2^32, plus exact min/max/sum: about 500 bytes whatever the sample count.
+class CycleHistogram
+{
+public:
+  static constexpr int BUCKETS = 124;
+
+  // Single writer: a reset asked for by another core is applied by add().
+  void add(uint32_t cycles);
+  void requestReset() { mResetPending = true; }
+
+  bool resetPending() const { return mResetPending; }
+
+  uint32_t count() const { return mCount; }
+  uint32_t lowest() const { return mCount ? mMin : 0; }
+  uint32_t highest() const { return mMax; }
+  uint32_t mean() const { return mCount ? (uint32_t)(mSum / mCount) : 0; }
+  // Upper edge of the bucket holding the pct-th percentile (clamped to max)
+  uint32_t percentile(uint8_t pct) const;
+
+private:
+  void clear();
+  static int bucketOf(uint32_t v);
+  static uint32_t bucketTop(int b);
+
+  uint32_t mBins[BUCKETS] = {};
+  uint64_t mSum = 0;
+  uint32_t mCount = 0;
+  uint32_t mMin = UINT32_MAX;
+  uint32_t mMax = 0;
+  volatile bool mResetPending = false;
+};
+
+void profRecord(ProfStage stage, uint32_t cycles);
+void profReset();
+void profDump(Print &out);
+
+class ProfileScope
+{
+public:
+  explicit ProfileScope(ProfStage stage) : mStage(stage), mStart(cycleCount()) {}
+  ~ProfileScope() { profRecord(mStage, cycleCount() - mStart); }
+
+private:
+  ProfStage mStage;
+  uint32_t mStart;
+};
+
+#define PROFILE_CAT2(a, b) a##b
+#define PROFILE_CAT(a, b) PROFILE_CAT2(a, b)
+#define PROFILE_SCOPE(stage) ProfileScope PROFILE_CAT(profScope, __LINE__)(stage)
+#else
+#define PROFILE_SCOPE(stage)
+#endif
@@ -0,0 +1,69 @@
+// ==================== RateMeter.h (sample clock measurement) ====================
+// Times a sample source against the CPU's microsecond clock. The source
+// reports each batch of samples as it arrives; a batch always arrives some
+// time after its last sample was taken (DMA buffer hand-over, task
+// switches), so the batches that arrive soonest mark the sample clock best.
+// The meter keeps the least-late batch of every BLOCK_US: CANDIDATES of them
+// from the start of the run and the latest CANDIDATES. The rate is the slope
+// between the least late of each set, re-picked with each new estimate, so
+// it sharpens as the span grows instead of averaging the lateness in.
+//
+// How late every batch arrives against that fitted clock is also kept, as a
+// histogram with power-of-two bins: this is the timing jitter the samples
+// have by the time software sees them.
+#pragma once
+#include <stdint.h>
+#include <stddef.h>
+
+class RateMeter
+{
+public:
+  static constexpr uint32_t BLOCK_US = 62500;
+  static constexpr int CANDIDATES = 16;
+  static constexpr uint32_t SETTLE_US = 2000000;     // span before the rate is trusted
+  static constexpr uint32_t REANCHOR_US = 600000000; // keeps the 64-bit sums in range
+  static constexpr int JITTER_BINS = 8;
+  static constexpr uint32_t JITTER_BIN0_US = 16; // bin i: < 16 << i us; the last: the rest
+
+  // Forget everything (new rate, or samples were lost)
+  void restart(uint32_t nominalHz);
+  // samples have arrived by nowUs
+  void add(uint32_t samples, uint32_t nowUs);
+
+  bool settled() const { return mSettled; }
+  // Nominal until settled
+  uint64_t rateMilliHz() const { return mRateMilli; }
+  uint32_t nominalHz() const { return mNominalHz; }
+  uint32_t spanMs() const { return (uint32_t)(mSpanUs / 1000); }
+  // Bumped every time the estimate is refined
+  uint32_t updates() const { return mUpdates; }
+  uint32_t jitter(int bin) const { return mJitter[bin]; }
+
+private:
+  struct Mark
+  {
+    uint64_t n; // samples since restart
+    uint64_t t; // us since restart
+  };
+  int64_t lateUs(const Mark &m) const;
+  const Mark &leastLate(const Mark *marks, int count) const;
+  void endBlock();
+
+  uint32_t mNominalHz = 0;
+  uint64_t mRateMilli = 0;
+  bool mStarted = false;
+  bool mSettled = false;
+  uint32_t mLastUs = 0;
+  Mark mNow = {};
+  Mark mBest = {}; // least-late batch of the current block so far
+  int64_t mBestLate = INT64_MAX;
+  uint64_t mBlockEnd = BLOCK_US;
+  Mark mEarly[CANDIDATES] = {};
+  int mEarlyCount = 0;
+  Mark mRecent[CANDIDATES] = {}; // ring
+  int mRecentCount = 0;
+  Mark mAnchor = {}; // the fitted clock passes through here
+  uint64_t mSpanUs = 0;
+  uint32_t mUpdates = 0;
+  uint32_t mJitter[JITTER_BINS] = {};
+};
@@ -0,0 +1,50 @@
+// ==================== SampleRecord.h (deep capture memory) ====================
+// A circular record of every source sample, as deep as the heap allows (PSRAM
+// when fitted: about a million samples; otherwise what the internal heap can
+// spare, tens of thousands). Capture appends continuously; pausing freezes
+// it so the display can zoom and pan through the whole record.
+//
+// One writer (capture) and one reader (display). freeze() hands the record
+// to the reader: it waits out an append already in progress, and appends
+// are dropped until release().
+#pragma once
+#include <stdint.h>
+#include <stddef.h>
+#include <atomic>
+
+class SampleRecord
+{
+public:
+  // Takes the largest block it can, up to maxSamples, leaving keepFreeBytes
+  // of internal heap for everything else. Returns the capacity in samples.
+  size_t allocate(size_t maxSamples, size_t keepFreeBytes);
+  size_t capacity() const { return mCap; }
+
+  // ---- capture side ----
+  void append(const int16_t *s, size_t n);
+  // Empties the record (the next samples are not contiguous with it).
+  void reset(uint32_t fs);
+
+  // ---- display side ----
+  void freeze();
+  void release(); // empties it and lets capture fill it again
+  bool frozen() const { return mFrozen.load(); }
+
+  size_t length() const { return mLen; }
+  uint32_t sampleRate() const { return mFs; }
+  // Samples appended since the last reset (wraps); the newest is total() - 1.
+  uint32_t total() const { return mTotal; }
+
+  // Copies up to n samples starting at index from (0 = oldest); returns the count.
+  size_t copy(size_t from, size_t n, int16_t *dst) const;
+
+private:
+  int16_t *mBuf = nullptr;
+  size_t mCap = 0;
+  size_t mHead = 0; // next write
+  size_t mLen = 0;
+  uint32_t mFs = 0;
+  uint32_t mTotal = 0;
+  std::atomic<bool> mFrozen{false};
+  std::atomic<bool> mBusy{false};
+};
@@ -0,0 +1,219 @@
+// ==================== SampleSource.h (acquisition backends) ====================
+#pragma once
+#include <stdint.h>
+#include <stddef.h>
+#include "RateMeter.h"
+
+#if defined(ARDUINO_ARCH_ESP32)
+#include <freertos/FreeRTOS.h>
+#include <freertos/queue.h>
+#include <driver/adc.h>
+#endif
+
+// Samples are raw 12-bit ADC codes (0..4095) stored as int16_t, same as the render buffer.
+class SampleSource
+{
+public:
+  virtual ~SampleSource() {}
+
+  virtual bool begin(uint32_t fs) = 0;
+  virtual void end() = 0;
+
+  // Returns the rate actually in effect (clamped to the backend's range).
+  virtual uint32_t setSampleRate(uint32_t fs) = 0;
+  virtual uint32_t sampleRate() const = 0;
+
+  // Copies up to n of the oldest unread samples into dst, waiting at most
+  // timeoutMs for them to arrive. Returns the number of samples written.
+  virtual size_t read(int16_t *dst, size_t n, uint32_t timeoutMs) = 0;
+
+  // Channel B, sampled interleaved with channel A at the same rate. While
+  // it is on, read() still returns channel A and readPair() both. A backend
+  // with one input refuses.
+  virtual bool setChannelB(bool on) { return !on; }
+  virtual bool channelB() const { return false; }
+  // As read(), with channel B's samples of the same instants in dstB
+  virtual size_t readPair(int16_t *dst, int16_t *dstB, size_t n, uint32_t timeoutMs)
+  {
+    (void)dstB;
+    return read(dst, n, timeoutMs);
+  }
+
+  // Discards everything already buffered so the next read starts "now".
+  virtual void flush() = 0;
+
+  // Number of times the background buffering overflowed and lost samples.
+  virtual uint32_t overruns() const { return 0; }
+
+  // Delivered rate timed against the CPU clock, in mHz; 0 until known (or
+  // for a backend whose rate is exact by construction)
+  virtual uint64_t measuredRateMilliHz() const { return 0; }
+  // The meter behind it, for reports; nullptr if the backend has none
+  virtual const RateMeter *rateMeter() const { return nullptr; }
+};
+
+#if defined(ARDUINO_ARCH_ESP32)
+// -------------------- I2S built-in ADC, continuous DMA --------------------
+// The I2S0 peripheral clocks ADC1 and streams conversions into a ring of DMA
+// buffers, so acquisition continues while the CPU renders. Rates below what
+// the I2S clock dividers can produce are reached by running the ADC faster
+// and boxcar-averaging groups of samples.
+//
+// The dividers rarely hit fs * decim exactly, so groups are not a fixed
+// decim long: a DDS phase accumulator adds fs per hardware sample and closes
+// a group each time it passes the hardware rate, making the average rate
+// exactly fs. The hardware rate is the driver's figure until the rate meter
+// has timed it, then the measured one. A group is decim +-1 samples long at
+// most, so the cost is at most one hardware period of jitter.
+//
+// With channel B on, the ADC's pattern table alternates the two inputs; each
+// DMA word carries its channel number, so the pairs are sorted by tag rather
+// than by position, and the hardware runs at twice the rate.
+class I2sAdcSource : public SampleSource
+{
+public:
+  static constexpr uint32_t HW_FS_MIN = 20000;  // lowest rate the I2S dividers produce reliably
+  static constexpr uint32_t HW_FS_MAX = 500000; // ADC1 conversion limit in DMA mode
+  static constexpr int DMA_BUF_COUNT = 8;
+  static constexpr int DMA_BUF_LEN = 512; // samples per DMA buffer
+
+  I2sAdcSource(adc1_channel_t channel, adc1_channel_t channelB) : mChannel(channel), mChannelB(channelB) {}
+
+  bool begin(uint32_t fs) override;
+  void end() override;
+  uint32_t setSampleRate(uint32_t fs) override;
+  uint32_t sampleRate() const override { return mFs; }
+  size_t read(int16_t *dst, size_t n, uint32_t timeoutMs) override { return readPair(dst, nullptr, n, timeoutMs); }
+  bool setChannelB(bool on) override;
+  bool channelB() const override { return mDual; }
+  size_t readPair(int16_t *dst, int16_t *dstB, size_t n, uint32_t timeoutMs) override;
+  void flush() override;
+  uint32_t overruns() const override { return mOverruns; }
+  uint64_t measuredRateMilliHz() const override;
+  const RateMeter *rateMeter() const override { return &mMeter; }
+  uint32_t hardwareRate() const { return mHwFs; }
+  uint16_t decimation() const { return mDecim; }
+
+private:
+  void pollEvents();
+  void track(size_t hwSamples); // meter, and the DDS modulus once it is measured
+  void applyPattern();
+  uint32_t channels() const { return mDual ? 2 : 1; }
+
+  adc1_channel_t mChannel;
+  adc1_channel_t mChannelB;
+  bool mDual = false;
+  QueueHandle_t mEvents = nullptr;
+  bool mRunning = false;
+  uint32_t mFs = 0;       // delivered rate
+  uint16_t mDecim = 1;    // nominal hardware samples (per channel) per delivered sample
+  uint32_t mHwFs = 0;     // requested from the I2S clock, all channels
+  uint64_t mDdsStep = 0;  // fs in mHz, added per hardware sample (pair, with channel B)
+  uint64_t mDdsMod = 0;   // hardware rate per channel in mHz; a sample is due each wrap
+  uint64_t mDdsPhase = 0;
+  uint32_t mMeterUpdates = 0;
+  RateMeter mMeter;       // times hardware samples, before decimation
+  uint32_t mAccSum[2] = {}; // decimator state carried across reads, per channel
+  uint16_t mAccCount[2] = {};
+  uint32_t mOverruns = 0;
+  int16_t mHold[2] = {};  // one finished sample (pair) left over from an odd-sized read
+  bool mHasHold = false;
+  uint16_t mRaw[256];     // staging for one i2s_read (even count: samples arrive swapped in pairs)
+};
+#endif
+
+// -------------------- Synthetic generator --------------------
+// Deterministic test signal for running the pipeline without an ADC (e.g. on
+// a Linux host). In realtime mode reads are paced by micros() like hardware;
+// otherwise every read is satisfied immediately.
+class SyntheticSource : public SampleSource
+{
+public:
+  enum Wave : uint8_t
+  {
+    WAVE_SINE,
+    WAVE_SQUARE,
+    WAVE_TRIANGLE,
+    WAVE_SAW,
+    WAVE_NOISE
+  };
+
+  static constexpr uint32_t FS_MAX = 1000000;
+  static constexpr uint32_t BACKLOG_MAX = 4096; // like the DMA ring: older samples are lost
+
+  SyntheticSource(Wave wave = WAVE_SINE, float freqHz = 440.0f, int amplitude = 900, int offset = 2048)
+      : mWave(wave), mFreqHz(freqHz), mAmplitude(amplitude), mOffset(offset) {}
+
+  bool begin(uint32_t fs) override;
+  void end() override {}
+  uint32_t setSampleRate(uint32_t fs) override;
+  uint32_t sampleRate() const override { return mFs; }
+  size_t read(int16_t *dst, size_t n, uint32_t timeoutMs) override { return readPair(dst, nullptr, n, timeoutMs); }
+  // Channel B plays the same wave at 3/2 the frequency and 3/4 the
+  // amplitude, starting a quarter turn in: a Lissajous figure in XY
+  bool setChannelB(bool on) override;
+  bool channelB() const override { return mDual; }
+  size_t readPair(int16_t *dst, int16_t *dstB, size_t n, uint32_t timeoutMs) override;
+  void flush() override;
+  uint32_t overruns() const override { return mOverruns; }
+
+  void setRealtime(bool on) { mRealtime = on; }
+  void setWave(Wave wave) { mWave = wave; }
+  void setFrequency(float hz);
+  void setAmplitude(int amplitude, int offset);
+  void setNoise(int amplitude) { mNoise = amplitude; }
+
+private:
+  int16_t next(int16_t *b);
+  int16_t waveAt(uint32_t ph, int amplitude) const;
+
+  Wave mWave;
+  float mFreqHz;
+  int mAmplitude;
+  int mOffset;
+  int mNoise = 0;
+  bool mRealtime = false;
+  uint32_t mFs = 0;
+  uint32_t mPhase = 0;    // DDS phase accumulator, full turn = 2^32
+  uint32_t mPhaseInc = 0;
+  bool mDual = false;
+  uint32_t mPhaseB = 0x40000000u;
+  uint32_t mNoiseState = 0x12345678u;
+  uint32_t mLastUs = 0;   // realtime pacing
+  uint64_t mCarry = 0;    // elapsed time not yet turned into samples, in us*Fs units
+  uint32_t mOverruns = 0;
+};
+
+// -------------------- Scripted generator --------------------
+// Plays a fixed sequence of synthetic segments (tone steps, bursts, silence)
+// and then starts over, so host benchmarks see the same signal every run.
+class ScriptedSource : public SyntheticSource
+{
+public:
+  struct Step
+  {
+    Wave wave;
+    float freqHz;
+    int amplitude;
+    int offset;
+    int noise;
+    uint32_t ms; // segment length, converted to samples at the current rate
+  };
+
+  // steps must outlive the source; an empty script plays the plain generator.
+  void setScript(const Step *steps, size_t count);
+  void rewind();
+  size_t step() const { return mStep; }
+
+  uint32_t setSampleRate(uint32_t fs) override;
+  size_t read(int16_t *dst, size_t n, uint32_t timeoutMs) override { return readPair(dst, nullptr, n, timeoutMs); }
+  size_t readPair(int16_t *dst, int16_t *dstB, size_t n, uint32_t timeoutMs) override;
+
+private:
+  void enter(size_t i);
+
+  const Step *mSteps = nullptr;
+  size_t mCount = 0;
+  size_t mStep = 0;
+  uint32_t mLeft = 0; // samples left in the current step
+};
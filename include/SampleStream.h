@@ -0,0 +1,90 @@
+// ==================== SampleStream.h (binary sample streaming) ====================
+// Raw 12-bit samples sent over serial at full rate for offline analysis:
+// ADC codes as the source delivered them, before calibration and filtering.
+// Each packet carries up to STREAM_MAX_SAMPLES samples packed two per three
+// bytes, with a sequence number, the sample rate and a CRC, and is COBS
+// framed so a receiver can resynchronise on the next 0x00 after any noise
+// (including status text printed while streaming).
+//
+// Packet (before COBS), little-endian:
+//   0      type (STREAM_TYPE_SAMPLES)
+//   1      flags (STREAM_FLAG_*)
+//   2..5   sequence number, +1 per packet, dropped packets included
+//   6..9   sample rate in Hz
+//   10..11 sample count
+//   12..   samples: a[7:0], a[11:8] | b[3:0] << 4, b[11:4] per pair; an odd
+//          count leaves b as padding
+//   last 2 CRC-16/CCITT-FALSE of everything before it
+#pragma once
+#include <stdint.h>
+#include <stddef.h>
+
+constexpr uint8_t STREAM_TYPE_SAMPLES = 0xA5;
+constexpr uint8_t STREAM_FLAG_DISCONTINUITY = 0x01; // samples were discarded before this packet
+constexpr uint16_t STREAM_MAX_SAMPLES = 128;
+constexpr size_t STREAM_HEADER_BYTES = 12;
+constexpr size_t STREAM_PACKET_MAX = STREAM_HEADER_BYTES + (STREAM_MAX_SAMPLES + 1) / 2 * 3 + 2;
+// COBS adds one byte per 254 plus the leading code byte; then the 0x00 delimiter
+constexpr size_t STREAM_FRAME_MAX = STREAM_PACKET_MAX + STREAM_PACKET_MAX / 254 + 2;
+
+uint16_t crc16Ccitt(uint16_t crc, uint8_t b);
+
+// Device side: packs and frames straight from the sample buffer into the
+// wire frame, with no intermediate packet copy.
+class SampleStreamEncoder
+{
+public:
+  // Writes a complete frame (delimiter included) for n <= STREAM_MAX_SAMPLES
+  // samples into out (STREAM_FRAME_MAX bytes); returns its length.
+  size_t encode(const int16_t *samples, uint16_t n, uint32_t fs, uint8_t *out);
+
+  // Consumes a sequence number without sending, so the receiver counts a loss.
+  void skip() { ++mSeq; }
+  // Flags the next packet: the samples before it are not contiguous with it.
+  void markDiscontinuity() { mFlags |= STREAM_FLAG_DISCONTINUITY; }
+
+  uint32_t seq() const { return mSeq; }
+
+private:
+  uint32_t mSeq = 0;
+  uint8_t mFlags = STREAM_FLAG_DISCONTINUITY; // nothing precedes the first packet
+};
+
+// Host side: feed received bytes one at a time.
+struct StreamPacket
+{
+  uint8_t flags;
+  uint32_t seq;
+  uint32_t fs;
+  uint16_t count;
+  int16_t samples[STREAM_MAX_SAMPLES];
+};
+
+struct StreamCounters
+{
+  uint32_t packets = 0;     // valid packets decoded
+  uint32_t lost = 0;        // missing sequence numbers
+  uint32_t corrupt = 0;     // frames failing COBS, length or CRC checks
+  uint32_t discontinuities = 0;
+};
+
+class SampleStreamDecoder
+{
+public:
+  // True when b completed a valid packet, now in packet().
+  bool push(uint8_t b);
+
+  const StreamPacket &packet() const { return mPacket; }
+  const StreamCounters &counters() const { return mCounters; }
+
+private:
+  bool finishFrame();
+
+  uint8_t mBuf[STREAM_FRAME_MAX];
+  size_t mLen = 0;
+  bool mOverflow = false;
+  bool mHaveSeq = false;
+  uint32_t mNextSeq = 0;
+  StreamPacket mPacket;
+  StreamCounters mCounters;
+};
@@ -0,0 +1,20 @@
+// ==================== ScopeLayout.h (screen geometry shared by the draw modules) ====================
+// The screen size comes from the panel's traits (DisplayTraits.h); the
+// banners and margins are fixed by the fonts, and the plot takes the rest.
+#pragma once
+#include "DisplayTraits.h"
+
+// Screen geometry
+constexpr int SCREEN_W = ScopeDisplay::WIDTH;
+constexpr int SCREEN_H = ScopeDisplay::HEIGHT;
+
+// --- Layout ---
+constexpr int PLOT_TOPBANNER = 24;    // title region (text only)
+constexpr int XAXIS_HEIGHT = 12;      // reserved strip under plot for x-axis ticks/labels
+constexpr int PLOT_BOTTOMBANNER = 20; // bottom HUD
+constexpr int PLOT_LMARGIN = 38;      // left margin for Y axis & labels
+
+constexpr int PLOT_X0 = PLOT_LMARGIN;
+constexpr int PLOT_Y0 = PLOT_TOPBANNER;
+constexpr int PLOT_W = SCREEN_W - PLOT_X0;
+constexpr int PLOT_H = SCREEN_H - (PLOT_TOPBANNER + PLOT_BOTTOMBANNER + XAXIS_HEIGHT);
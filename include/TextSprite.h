@@ -0,0 +1,151 @@
+// ==================== TextSprite.h (pre-rasterised text for the HUD and axes) ====================
+// Adafruit_GFX draws font text one pixel (one address window) at a time, over
+// a box that first has to be cleared, so every HUD or axis refresh flickers.
+// Here text is composed into an RGB565 buffer in RAM and sent to the panel as
+// a single window. Labels that never change are rasterised once at boot into
+// a sprite pool, and their sizes come from constexpr glyph metrics, so the
+// pool is sized by the compiler.
+#pragma once
+#include <stdint.h>
+#include <stddef.h>
+#include <Adafruit_GFX.h>
+#include "DisplayTraits.h"
+
+// The box getTextBounds() reports for text with its cursor at (0, 0), plus
+// the cursor advance. constexpr, so it also works on the font tables at
+// compile time. Single line only.
+struct TextBox
+{
+  int16_t x1, y1; // top-left relative to the cursor (y1 < 0 is above the baseline)
+  int16_t w, h;
+  int16_t advance;
+};
+
+constexpr TextBox textBounds(const GFXglyph *glyphs, uint8_t first, uint8_t last, const char *s)
+{
+  int minX = 0x7FFF, minY = 0x7FFF, maxX = -0x7FFF, maxY = -0x7FFF;
+  int cx = 0;
+  for (; *s; ++s)
+  {
+    const uint8_t c = (uint8_t)*s;
+    if (c < first || c > last)
+      continue;
+    const GFXglyph &g = glyphs[c - first];
+    const int x0 = cx + g.xOffset;
+    const int x1 = x0 + g.width - 1;
+    const int y1 = g.yOffset + g.height - 1;
+    minX = x0 < minX ? x0 : minX;
+    maxX = x1 > maxX ? x1 : maxX;
+    minY = g.yOffset < minY ? g.yOffset : minY;
+    maxY = y1 > maxY ? y1 : maxY;
+    cx += g.xAdvance;
+  }
+  if (maxX < minX || maxY < minY)
+    return TextBox{0, 0, 0, 0, (int16_t)cx};
+  return TextBox{(int16_t)minX, (int16_t)minY, (int16_t)(maxX - minX + 1), (int16_t)(maxY - minY + 1), (int16_t)cx};
+}
+
+inline TextBox textBounds(const GFXfont &font, const char *s)
+{
+  return textBounds(font.glyph, (uint8_t)font.first, (uint8_t)font.last, s);
+}
+
+// Pixels needed to rasterise a set of labels (sum of their boxes)
+constexpr size_t textArea(const GFXglyph *glyphs, uint8_t first, uint8_t last, const char *const *labels, size_t n)
+{
+  size_t area = 0;
+  for (size_t i = 0; i < n; ++i)
+  {
+    const TextBox b = textBounds(glyphs, first, last, labels[i]);
+    area += (size_t)b.w * (size_t)b.h;
+  }
+  return area;
+}
+
+// Widest advance among chars: the pitch of a fixed-cell field
+constexpr int16_t maxAdvance(const GFXglyph *glyphs, uint8_t first, uint8_t last, const char *chars)
+{
+  int16_t widest = 0;
+  for (; *chars; ++chars)
+  {
+    const uint8_t c = (uint8_t)*chars;
+    if (c >= first && c <= last && glyphs[c - first].xAdvance > widest)
+      widest = glyphs[c - first].xAdvance;
+  }
+  return widest;
+}
+
+// A rasterised label; (x1, y1) places it relative to the text cursor.
+struct Sprite
+{
+  const uint16_t *pixels = nullptr;
+  TextBox box{};
+};
+
+// RGB565 buffer that text and sprites are composed into before one
+// setAddrWindow()/writePixels() to the panel. Drawing is clipped.
+class TextCanvas
+{
+public:
+  TextCanvas(uint16_t *pixels, int w, int h) : mPix(pixels), mW(w), mH(h) {}
+
+  int width() const { return mW; }
+  int height() const { return mH; }
+
+  void fill(uint16_t c);
+  void hLine(int x, int y, int w, uint16_t c);
+  void vLine(int x, int y, int h, uint16_t c);
+
+  // Text with its cursor at (x, baseline); returns the advance.
+  int print(const GFXfont &font, const char *text, int x, int baseline, uint16_t fg);
+  int draw(const Sprite &s, int x, int baseline);
+
+  // Sends the whole canvas with its top-left at screen (x, y).
+  void blit(ScopePanel &tft, int x, int y) const;
+
+private:
+  uint16_t *mPix;
+  int mW, mH;
+};
+
+// A value drawn in fixed-pitch cells, one character each, so an update only
+// resends the cells whose character changed: a run of changed cells goes as
+// one window, and unchanged digits are not touched at all.
+class CellField
+{
+public:
+  static constexpr int MAX_CELLS = 12;
+
+  // cells of cellW px at (x, baseline); rows y1 .. y1 + h - 1 relative to the baseline
+  void place(int x, int baseline, int cells, int cellW, int y1, int h);
+  int width() const { return mCells * mCellW; }
+
+  // Left-aligned, blank-padded; scratch must hold width() x h pixels.
+  void update(ScopePanel &tft, const GFXfont &font, const char *text, uint16_t fg, uint16_t bg,
+              uint16_t *scratch);
+  // The panel no longer shows these cells: the next update sends them all.
+  void invalidate();
+
+private:
+  int16_t mX = 0, mBaseline = 0, mY1 = 0, mH = 0;
+  int16_t mCells = 0, mCellW = 0;
+  char mShown[MAX_CELLS] = {};
+};
+
+// Fixed-size store of label sprites, filled once at boot.
+class SpritePool
+{
+public:
+  SpritePool(uint16_t *pixels, size_t capacity) : mPix(pixels), mCap(capacity) {}
+
+  // Rasterises text with fg on bg; false if the pool is full.
+  bool render(Sprite &out, const GFXfont &font, const char *text, uint16_t fg, uint16_t bg);
+
+  // Sends a sprite with its text cursor at screen (x, baseline), as one window.
+  static void blit(ScopePanel &tft, const Sprite &s, int x, int baseline);
+
+private:
+  uint16_t *mPix;
+  size_t mCap;
+  size_t mUsed = 0;
+};
@@ -0,0 +1,90 @@
+// ==================== TraceRenderer.h (column-span trace drawing) ====================
+// Each plot column holds one vertical span [top..bot] of trace pixels. A new
+// frame is drawn by writing only the pixels whose colour changes between the
+// previous and the new span, as vertical runs, and runs from neighbouring
+// columns are merged into one setAddrWindow()/writePixels() burst whenever
+// that is cheaper than addressing them separately.
+//
+// Up to MAX_TRACES traces share the plot, each with its own span history, so
+// a second trace only adds the pixels where it moved; the first trace listed
+// is drawn over the others where they cross. Erased pixels get whatever the
+// background model (PlotBackground.h) has there, so the graticule and
+// cursors survive a trace passing over them.
+#pragma once
+#include <stdint.h>
+#include "DisplayTraits.h"
+#include "ScopeLayout.h"
+#include "PlotBackground.h"
+
+// Bytes on the SPI bus for a display update (command + data)
+struct SpiStats
+{
+  uint32_t pixels = 0;
+  uint32_t bytes = 0;
+  uint32_t windows = 0; // address-window setups
+
+  void clear() { pixels = bytes = windows = 0; }
+};
+
+// SPI cost model: CASET(1+4) + RASET(1+4) + RAMWR(1) per window, and the
+// panel's pixel format (2 or 3 bytes) per pixel.
+constexpr uint32_t SPI_WINDOW_BYTES = 11;
+constexpr uint32_t SPI_PIXEL_BYTES = pixelBytes(ScopeDisplay::FORMAT);
+
+// Turns a polyline of samples into per-column spans. Columns between two
+// samples are interpolated; each span reaches back to the previous column's
+// y so steep edges are drawn solid instead of as scattered dots.
+// top/bot are screen rows; a column with top > bot is empty.
+void samplesToSpans(const int16_t *ys, int count, int pxPerSample, int16_t *top, int16_t *bot);
+
+// Peak-decimated frames: ys holds two rows per column (the extremes of that
+// column's samples, in time order). Each column spans both and reaches back
+// to the previous column's last row so neighbouring columns join up.
+void envelopeToSpans(const int16_t *ys, int columns, int16_t *top, int16_t *bot);
+
+// One trace's column spans and colour
+struct TraceSpans
+{
+  const int16_t *top;
+  const int16_t *bot;
+  uint16_t color;
+};
+
+class TraceRenderer
+{
+public:
+  static constexpr int BURST_MAX = ScopeDisplay::BURST_PIXELS; // pixels staged per writePixels()
+  static constexpr int MAX_TRACES = 2;
+
+  // Forget what is on screen (call after the plot area has been cleared).
+  void reset();
+
+  // Replaces the previous traces with the new spans; traces not given this
+  // time are erased. Rows whose background changed are sent whole first,
+  // and the changes taken.
+  void draw(ScopePanel &tft, const TraceSpans *traces, int count, PlotBackground &bg);
+
+  const SpiStats &lastFrame() const { return mStats; }
+
+private:
+  struct Rect
+  {
+    int16_t x0, x1, y0, y1; // inclusive
+  };
+
+  void repaintRows(ScopePanel &tft);
+  void flush(ScopePanel &tft, const Rect &r);
+  void addRun(ScopePanel &tft, int x, int y0, int y1);
+  uint16_t colorAt(int x, int y) const;
+
+  int16_t mTop[MAX_TRACES][PLOT_W]; // spans currently on screen
+  int16_t mBot[MAX_TRACES][PLOT_W];
+  const TraceSpans *mTraces = nullptr; // the frame being drawn
+  int mTraceCount = 0;
+  const PlotBackground *mBg = nullptr;
+  Rect mPending;
+  bool mHavePending = false;
+  SpiStats mStats;
+  uint16_t mBurst[BURST_MAX];
+  static_assert(BURST_MAX >= PLOT_W, "a burst holds a whole row");
+};
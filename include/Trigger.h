@@ -0,0 +1,88 @@
+// ==================== Trigger.h (edge trigger with pre-trigger history) ====================
+// Sits between the sample source and the frame queue. Every sample goes into
+// a circular history, so when an edge is found the frame can start before it
+// (pre-trigger) without re-reading the ADC. A second channel can ride along
+// in a history of its own; only the first is searched for the edge.
+#pragma once
+#include <stdint.h>
+#include <stddef.h>
+
+enum TriggerMode : uint8_t
+{
+  TRIG_AUTO,   // free-runs after a timeout when nothing triggers
+  TRIG_NORMAL, // waits for an edge indefinitely
+  TRIG_SINGLE, // one triggered frame, then holds until re-armed
+  TRIG_MODE_COUNT
+};
+
+enum TriggerEdge : uint8_t
+{
+  EDGE_RISING,
+  EDGE_FALLING
+};
+
+struct TriggerSettings
+{
+  TriggerMode mode = TRIG_AUTO;
+  TriggerEdge edge = EDGE_RISING;
+  int16_t level = 2048;     // raw ADC code
+  int16_t hysteresis = 32;  // signal must first go this far past the level the other way
+  uint8_t preTriggerPct = 50;
+};
+
+class TriggerEngine
+{
+public:
+  static constexpr size_t HISTORY = 1024; // power of two, >= longest frame
+  static constexpr uint32_t AUTO_TIMEOUT_MS = 100;
+
+  // Applies new settings and restarts the search. frameLen <= HISTORY.
+  void configure(const TriggerSettings &s, uint16_t frameLen, uint32_t fs);
+
+  // Starts a new search, keeping the history (used after every frame and to re-arm single).
+  void arm();
+
+  // Forgets the history too, e.g. after the sample stream was interrupted.
+  // A held single shot stays held.
+  void discardHistory();
+
+  // Consumes samples until a frame is complete. *consumed tells how many of
+  // the n were used; the rest belong to the next frame. Returns true when a
+  // frame is ready for extract(). sB, if given, is the second channel at the
+  // same instants.
+  bool feed(const int16_t *s, size_t n, size_t *consumed, const int16_t *sB = nullptr);
+
+  // Copies the completed frame (frameLen samples, oldest first) and re-arms
+  // (auto/normal) or starts holding (single). dstB gets the second channel;
+  // it holds whatever was last fed there.
+  void extract(int16_t *dst, int16_t *dstB = nullptr);
+
+  bool holding() const { return mState == HOLD; }
+  bool lastWasTriggered() const { return mLastTriggered; }
+  uint16_t preTriggerSamples() const { return mPre; }
+
+private:
+  enum State : uint8_t
+  {
+    SEEK_ARM, // waiting for the signal to clear the hysteresis band
+    SEEK_EDGE,
+    POST,     // trigger found, collecting the post-trigger part
+    READY,    // frame complete, waiting for extract()
+    HOLD      // single shot taken
+  };
+
+  bool crossed(int16_t v);
+
+  TriggerSettings mSet;
+  uint16_t mFrameLen = 0;
+  uint16_t mPre = 0;
+  uint32_t mAutoTimeout = 0; // samples
+  State mState = SEEK_ARM;
+  uint32_t mWritten = 0;     // samples stored since the history was last discarded
+  uint32_t mSearchStart = 0; // mWritten when the current search began
+  uint32_t mTrigAt = 0;      // mWritten index of the trigger sample
+  bool mTriggered = false;
+  bool mLastTriggered = false;
+  int16_t mHist[HISTORY];
+  int16_t mHistB[HISTORY];
+};
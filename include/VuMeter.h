@@ -0,0 +1,105 @@
+// ==================== VuMeter.h (LED bar meter ballistics) ====================
+// A level follower with separate attack and release time constants, run on
+// the time actually elapsed between updates, so the meter moves at the same
+// speed whatever the frame rate. Peak mode reads the frame's largest swing
+// from the DC offset; RMS mode reads its AC RMS, scaled so a full-scale sine
+// reads 0 dBFS in both. The top LED reached is held for a while as a dot.
+//
+// LED thresholds are a dB table turned into raw-code levels at compile time.
+#pragma once
+#include <stdint.h>
+#include <stddef.h>
+
+enum VuMode : uint8_t
+{
+  VU_PEAK, // fast attack, slow release (PPM-like)
+  VU_RMS,  // symmetric 300 ms integration (VU-like)
+  VU_MODE_COUNT
+};
+
+// -------------------- compile-time dB table --------------------
+// e^x by its Taylor series after halving x into range, for constexpr use
+constexpr double constExp(double x)
+{
+  int halvings = 0;
+  while (x > 0.5 || x < -0.5)
+  {
+    x /= 2;
+    ++halvings;
+  }
+  double sum = 1, term = 1;
+  for (int n = 1; n < 20; ++n)
+  {
+    term *= x / n;
+    sum += term;
+  }
+  while (halvings--)
+    sum *= sum;
+  return sum;
+}
+
+constexpr double dbToRatio(double db)
+{
+  return constExp(db * 0.11512925464970229); // ln(10) / 20
+}
+
+constexpr int VU_LEDS = 6;
+constexpr float VU_FULL_SCALE = 2047.0f; // largest swing about mid-scale, in raw codes
+constexpr int8_t VU_LED_DB[VU_LEDS] = {-36, -30, -24, -18, -12, -6}; // dBFS each LED lights at
+
+struct VuThresholds
+{
+  float level[VU_LEDS];
+};
+
+constexpr VuThresholds makeVuThresholds()
+{
+  VuThresholds t{};
+  for (int i = 0; i < VU_LEDS; ++i)
+    t.level[i] = (float)(VU_FULL_SCALE * dbToRatio(VU_LED_DB[i]));
+  return t;
+}
+
+constexpr VuThresholds VU_THRESHOLDS = makeVuThresholds();
+
+// -------------------- meter --------------------
+class VuMeter
+{
+public:
+  static constexpr uint32_t HOLD_US = 1000000;
+
+  void setMode(VuMode m);
+  VuMode mode() const { return mMode; }
+
+  // level in raw codes of swing (peak, or RMS x sqrt(2)), dtUs since the
+  // last update. Returns the LEDs to light, bit 0 the lowest.
+  uint8_t update(float level, uint32_t dtUs);
+
+private:
+  VuMode mMode = VU_PEAK;
+  float mEnv = 0;
+  uint8_t mHold = 0; // LEDs lit at the held peak
+  uint32_t mHoldLeftUs = 0;
+};
+
+// -------------------- LED bar --------------------
+// Up to 8 output pins written together. On the ESP32 a new pattern is one
+// write to each GPIO bank's set and clear registers (pins 0-31 and 32-39),
+// instead of one digitalWrite() per LED; unchanged patterns cost nothing.
+class LedBar
+{
+public:
+  static constexpr int MAX_PINS = 8;
+
+  void begin(const uint8_t *pins, int n);
+  void write(uint8_t bits); // bit i drives pins[i]
+
+private:
+  uint8_t mPins[MAX_PINS] = {};
+  int mCount = 0;
+  int mShown = -1; // pattern on the pins; -1 until the first write
+#if defined(ARDUINO_ARCH_ESP32)
+  uint32_t mMask[MAX_PINS] = {}; // bit in its bank's registers
+  bool mHighBank[MAX_PINS] = {};
+#endif
+};
@@ -0,0 +1,43 @@
+// ==================== Waterfall.h (scrolling spectrogram) ====================
+// Each spectrum becomes one colour-mapped line and the panel's hardware
+// scroll moves the history along, so a frame costs one PLOT_H-pixel line
+// write plus a scroll-offset command instead of a plot redraw.
+//
+// The panel scrolls along its long axis, which in landscape is screen
+// x: time runs left to right (newest at the right edge) and frequency runs up
+// the plot. Only whole screen columns can be held still, so the fixed area is
+// the left margin; everything right of it scrolls, and the title/HUD strips
+// there are kept blank while the waterfall is up.
+#pragma once
+#include <stdint.h>
+#include "DisplayTraits.h"
+#include "ScopeLayout.h"
+#include "TraceRenderer.h" // SpiStats, SPI cost model
+
+class Waterfall
+{
+public:
+  // Fixes the left margin, makes the rest a scroll area and clears it.
+  void start(ScopePanel &tft, uint16_t colBg);
+
+  // Puts the panel back to unscrolled. The scroll area holds stale lines
+  // afterwards; the caller redraws it.
+  void stop(ScopePanel &tft);
+
+  bool active() const { return mActive; }
+
+  // Adds one spectrum (bins values in 0.1 dB, DC first, Fs/2 last) at the
+  // right edge. dbRange maps 0 .. -dbRange onto the colour scale.
+  void pushLine(ScopePanel &tft, const int16_t *db, int bins, int16_t dbRange);
+
+  // Colour for a level in 0.1 dB (same map as the lines), e.g. for a legend.
+  static uint16_t colorFor(int db, int16_t dbRange);
+
+  const SpiStats &lastFrame() const { return mStats; }
+
+private:
+  uint16_t mLine[PLOT_H];
+  uint16_t mOffset = 0; // scroll-area line currently shown at the left edge
+  bool mActive = false;
+  SpiStats mStats;
+};
@@ -0,0 +1,219 @@
+// ==================== AdcCalibration.cpp (ADC linearity correction) ====================
+#include <Arduino.h>
+#include "AdcCalibration.h"
+
+#if defined(ARDUINO_ARCH_ESP32)
+#include <esp_adc_cal.h>
+#include <Preferences.h>
+#endif
+
+namespace
+{
+constexpr const char *NVS_NAMESPACE = "adccal";
+constexpr uint8_t NVS_VERSION = 1; // bump when the stored layout changes
+constexpr int POINT_MERGE_CODES = 16;
+constexpr int32_t NOMINAL_SLOPE_Q16 = (int32_t)(((int64_t)ADC_FULL_SCALE_MV << 16) / ADC_CODE_MAX);
+
+uint16_t clampCode(int32_t code)
+{
+  return (uint16_t)constrain(code, 0L, (long)ADC_CODE_MAX);
+}
+} // namespace
+
+// -------------------- sources --------------------
+void AdcCalibration::begin(bool adcInput)
+{
+  if (load())
+    return;
+  if (!adcInput || !buildEfuse())
+    buildNominal();
+}
+
+void AdcCalibration::useNominal()
+{
+  mPointCount = 0;
+  buildNominal();
+}
+
+bool AdcCalibration::useEfuse()
+{
+  if (!buildEfuse())
+    return false;
+  mPointCount = 0;
+  return true;
+}
+
+bool AdcCalibration::addPoint(uint16_t raw, uint16_t mv)
+{
+  raw = min(raw, (uint16_t)ADC_CODE_MAX);
+  int i = 0;
+  while (i < mPointCount && mPoints[i].raw + POINT_MERGE_CODES <= raw)
+    ++i;
+  if (i < mPointCount && abs((int)mPoints[i].raw - (int)raw) < POINT_MERGE_CODES)
+    mPoints[i] = CalPoint{raw, mv};
+  else
+  {
+    if (mPointCount == MAX_POINTS)
+      return false;
+    for (int j = mPointCount; j > i; --j)
+      mPoints[j] = mPoints[j - 1];
+    mPoints[i] = CalPoint{raw, mv};
+    ++mPointCount;
+  }
+  buildFromPoints();
+  return true;
+}
+
+void AdcCalibration::clearPoints()
+{
+  mPointCount = 0;
+  if (!buildEfuse())
+    buildNominal();
+}
+
+const char *AdcCalibration::sourceName() const
+{
+  static const char *const NAMES[CAL_SOURCE_COUNT] = {"nominal", "eFuse", "user"};
+  return NAMES[mSource];
+}
+
+// -------------------- tables --------------------
+void AdcCalibration::buildNominal()
+{
+  for (int i = 0; i < CODES; ++i)
+    mCode[i] = (uint16_t)i;
+  mIdentity = true;
+  mSource = CAL_NOMINAL;
+}
+
+bool AdcCalibration::buildEfuse()
+{
+#if defined(ARDUINO_ARCH_ESP32)
+  // Without either eFuse record the driver falls back to a typical Vref,
+  // which is no better than nominal
+  if (esp_adc_cal_check_efuse(ESP_ADC_CAL_VAL_EFUSE_TP) != ESP_OK &&
+      esp_adc_cal_check_efuse(ESP_ADC_CAL_VAL_EFUSE_VREF) != ESP_OK)
+    return false;
+  esp_adc_cal_characteristics_t chars;
+  esp_adc_cal_characterize(ADC_UNIT_1, ADC_ATTEN_DB_11, ADC_WIDTH_BIT_12, 1100, &chars);
+  for (int i = 0; i < CODES; ++i)
+    mCode[i] = clampCode(mvToCode((int32_t)esp_adc_cal_raw_to_voltage(i, &chars)));
+  mIdentity = false;
+  mSource = CAL_EFUSE;
+  return true;
+#else
+  return false;
+#endif
+}
+
+// Piecewise-linear through the points, slopes in Q16 mV per code
+void AdcCalibration::buildFromPoints()
+{
+  if (!mPointCount)
+  {
+    buildNominal();
+    return;
+  }
+  int seg = 0;
+  for (int i = 0; i < CODES; ++i)
+  {
+    while (seg + 2 < mPointCount && i > mPoints[seg + 1].raw)
+      ++seg;
+    const CalPoint &a = mPoints[seg];
+    int32_t slopeQ16 = NOMINAL_SLOPE_Q16;
+    if (mPointCount > 1)
+    {
+      const CalPoint &b = mPoints[seg + 1];
+      slopeQ16 = (int32_t)((((int64_t)b.mv - a.mv) << 16) / max(1, (int)b.raw - (int)a.raw));
+    }
+    const int32_t mv = a.mv + (int32_t)(((int64_t)slopeQ16 * (i - a.raw) + 0x8000) >> 16);
+    mCode[i] = clampCode(mvToCode(mv));
+  }
+  mIdentity = false;
+  mSource = CAL_USER;
+}
+
+// -------------------- samples --------------------
+void AdcCalibration::apply(int16_t *s, size_t n, bool track)
+{
+  if (!n || (mIdentity && !track))
+    return;
+  uint32_t sum = 0;
+  if (mIdentity)
+  {
+    for (size_t i = 0; i < n; ++i)
+      sum += (uint16_t)s[i];
+  }
+  else
+  {
+    // A table rebuilt by the UI mid-chunk gives one chunk of mixed samples
+    const uint16_t *code = mCode;
+    for (size_t i = 0; i < n; ++i)
+    {
+      const uint16_t raw = (uint16_t)s[i] & ADC_CODE_MAX;
+      sum += raw;
+      s[i] = (int16_t)code[raw];
+    }
+  }
+  if (!track)
+    return;
+  const uint32_t meanQ4 = (sum << 4) / n;
+  const uint32_t level = mRawQ4;
+  mRawQ4 = level ? level + (int32_t)(meanQ4 - level) / 16 : meanQ4;
+}
+
+// -------------------- storage --------------------
+bool AdcCalibration::save() const
+{
+#if defined(ARDUINO_ARCH_ESP32)
+  Preferences prefs;
+  if (!prefs.begin(NVS_NAMESPACE, false))
+    return false;
+  bool ok = prefs.putUChar("ver", NVS_VERSION) == 1 && prefs.putUChar("src", mSource) == 1 &&
+            prefs.putBytes("pts", mPoints, sizeof(CalPoint) * mPointCount) == sizeof(CalPoint) * mPointCount;
+  // Nominal needs no table, and an eFuse one is cheaper to rebuild than to store
+  if (mSource == CAL_USER)
+    ok = ok && prefs.putBytes("lut", mCode, sizeof(mCode)) == sizeof(mCode);
+  else
+    prefs.remove("lut");
+  prefs.end();
+  return ok;
+#else
+  return false;
+#endif
+}
+
+bool AdcCalibration::load()
+{
+#if defined(ARDUINO_ARCH_ESP32)
+  Preferences prefs;
+  if (!prefs.begin(NVS_NAMESPACE, true))
+    return false;
+  bool ok = prefs.getUChar("ver", 0) == NVS_VERSION;
+  const uint8_t src = prefs.getUChar("src", CAL_SOURCE_COUNT);
+  ok = ok && src < CAL_SOURCE_COUNT;
+  if (ok)
+  {
+    const size_t ptsLen = prefs.getBytesLength("pts");
+    mPointCount = (int)min(ptsLen / sizeof(CalPoint), (size_t)MAX_POINTS);
+    if (mPointCount)
+      prefs.getBytes("pts", mPoints, sizeof(CalPoint) * mPointCount);
+    if (src == CAL_USER)
+    {
+      ok = prefs.getBytes("lut", mCode, sizeof(mCode)) == sizeof(mCode);
+      mIdentity = false;
+      mSource = CAL_USER;
+    }
+    else if (src == CAL_EFUSE)
+      ok = buildEfuse();
+    else
+      buildNominal();
+  }
+  prefs.end();
+  if (!ok)
+    mPointCount = 0;
+  return ok;
+#else
+  return false;
+#endif
+}
@@ -0,0 +1,67 @@
+// ==================== AutoSet.cpp (signal survey for auto-set) ====================
+#include <Arduino.h>
+#include "AutoSet.h"
+
+void AutoSetProbe::begin(uint32_t fs, uint32_t levelSamples)
+{
+  mFs = fs;
+  mLevelSamples = levelSamples;
+  mPos = 0;
+  mMin = 0x7FFF;
+  mMax = -0x7FFF;
+  mLow = mHigh = 0;
+  mArmed = false;
+  mFirstCrossing = mLastCrossing = 0;
+  mCrossings = 0;
+}
+
+void AutoSetProbe::add(const int16_t *s, size_t n)
+{
+  for (size_t i = 0; i < n; ++i)
+  {
+    const int16_t v = s[i];
+    if (v < mMin)
+      mMin = v;
+    if (v > mMax)
+      mMax = v;
+
+    const uint32_t at = mPos + (uint32_t)i;
+    if (at < mLevelSamples)
+      continue;
+    if (at == mLevelSamples)
+    {
+      const int16_t mid = (int16_t)((mMin + mMax) / 2);
+      const int16_t hyst = (int16_t)max((mMax - mMin) / 8, (int)MIN_HYSTERESIS);
+      mLow = (int16_t)(mid - hyst);
+      mHigh = (int16_t)(mid + hyst);
+    }
+
+    if (!mArmed)
+    {
+      mArmed = v < mLow;
+      continue;
+    }
+    if (v <= mHigh)
+      continue;
+    if (!mCrossings)
+      mFirstCrossing = at;
+    mLastCrossing = at;
+    mCrossings++;
+    mArmed = false;
+  }
+  mPos += (uint32_t)n;
+}
+
+AutoSetSurvey AutoSetProbe::result() const
+{
+  AutoSetSurvey r{};
+  r.samples = mPos;
+  r.fs = mFs;
+  if (!mPos)
+    return r;
+  r.min = mMin;
+  r.max = mMax;
+  if (mCrossings >= 2)
+    r.periodQ8 = (uint32_t)(((uint64_t)(mLastCrossing - mFirstCrossing) << 8) / (mCrossings - 1));
+  return r;
+}
@@ -0,0 +1,106 @@
+// ==================== BandCompositor.cpp (off-screen plot composition) ====================
+#include <Arduino.h>
+#include "BandCompositor.h"
+#include "Phosphor.h"
+
+void BandCompositor::invalidate()
+{
+  for (bool &stale : mStale)
+    stale = true;
+}
+
+void BandCompositor::composeBackground(uint16_t *buf, int y0, int rows, const PlotBackground &bg) const
+{
+  for (int r = 0; r < rows; ++r)
+    bg.composeRow(buf + r * PLOT_W, y0 + r);
+}
+
+void BandCompositor::compose(uint16_t *buf, int y0, int rows, const TraceSpans *traces, int count,
+                             const PlotBackground &bg) const
+{
+  composeBackground(buf, y0, rows, bg);
+
+  // Traces on top, the first one last
+  for (int t = count - 1; t >= 0; --t)
+  {
+    const int16_t *top = traces[t].top;
+    const int16_t *bot = traces[t].bot;
+    const uint16_t colTrace = traces[t].color;
+    for (int r = 0; r < rows; ++r)
+    {
+      const int y = y0 + r;
+      uint16_t *line = buf + r * PLOT_W;
+      for (int x = 0; x < PLOT_W; ++x)
+        if (y >= top[x] && y <= bot[x])
+          line[x] = colTrace;
+    }
+  }
+}
+
+void BandCompositor::push(ScopePanel &tft, uint16_t *buf, int y0, int rows)
+{
+  tft.dmaWait();
+  tft.setAddrWindow(PLOT_X0, y0, PLOT_W, rows);
+  tft.writePixels(buf, (uint32_t)(PLOT_W * rows), false);
+
+  mStats.windows++;
+  mStats.pixels += (uint32_t)(PLOT_W * rows);
+  mStats.bytes += SPI_WINDOW_BYTES + SPI_PIXEL_BYTES * (uint32_t)(PLOT_W * rows);
+}
+
+void BandCompositor::draw(ScopePanel &tft, const TraceSpans *traces, int count, PlotBackground &bg)
+{
+  mStats.clear();
+  tft.startWrite();
+  for (int b = 0; b < BAND_COUNT; ++b)
+  {
+    const int y0 = PLOT_Y0 + b * BAND_ROWS;
+    const int rows = min(BAND_ROWS, PLOT_Y0 + PLOT_H - y0);
+    uint16_t *buf = mBand[b & 1];
+
+    // The other buffer may still be on the wire; this one finished two bands ago.
+    compose(buf, y0, rows, traces, count, bg);
+    push(tft, buf, y0, rows);
+    mStale[b] = true;
+  }
+  tft.dmaWait();
+  tft.endWrite();
+  bg.takeChanges();
+}
+
+void BandCompositor::drawPhosphor(ScopePanel &tft, const Phosphor &ph, PlotBackground &bg)
+{
+  mStats.clear();
+  if (bg.changed())
+  {
+    for (int y = PLOT_Y0; y < PLOT_Y0 + PLOT_H; ++y)
+      if (bg.rowChanged(y))
+        mStale[(y - PLOT_Y0) / BAND_ROWS] = true;
+    bg.takeChanges();
+  }
+  tft.startWrite();
+  int sent = 0;
+  for (int b = 0; b < BAND_COUNT; ++b)
+  {
+    const bool lit = ph.bandLit(b);
+    if (!lit && !mStale[b])
+      continue; // dark now and plain background on the panel
+    mStale[b] = lit;
+
+    const int y0 = PLOT_Y0 + b * BAND_ROWS;
+    const int rows = min(BAND_ROWS, PLOT_Y0 + PLOT_H - y0);
+    uint16_t *buf = mBand[sent++ & 1];
+    composeBackground(buf, y0, rows, bg);
+    for (int r = 0; lit && r < rows; ++r)
+    {
+      const uint8_t *hits = ph.row(y0 - PLOT_Y0 + r);
+      uint16_t *line = buf + r * PLOT_W;
+      for (int x = 0; x < PLOT_W; ++x)
+        if (hits[x])
+          line[x] = PHOSPHOR_RAMP.color[hits[x]];
+    }
+    push(tft, buf, y0, rows);
+  }
+  tft.dmaWait();
+  tft.endWrite();
+}
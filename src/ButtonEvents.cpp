@@ -0,0 +1,136 @@
+// ==================== ButtonEvents.cpp (interrupt-driven button gestures) ====================
+#include <Arduino.h>
+#include "ButtonEvents.h"
+
+#if defined(ARDUINO_ARCH_ESP32)
+#include <soc/gpio_reg.h>
+#endif
+
+// -------------------- ISR side --------------------
+bool IRAM_ATTR ButtonEvents::readDown(uint8_t button) const
+{
+  const uint8_t pin = mCfg[button].pin;
+#if defined(ARDUINO_ARCH_ESP32)
+  // Straight from the input registers: digitalRead() is not safe in an ISR
+  const uint32_t in = pin < 32 ? REG_READ(GPIO_IN_REG) : REG_READ(GPIO_IN1_REG);
+  return !((in >> (pin & 31)) & 1);
+#else
+  return digitalRead(pin) == LOW;
+#endif
+}
+
+void IRAM_ATTR ButtonEvents::onEdge(void *arg)
+{
+  const PinRef &ref = *static_cast<PinRef *>(arg);
+  ButtonEvents &self = *ref.owner;
+  const bool down = self.readDown(ref.button);
+  self.mLevel[ref.button].store(down, std::memory_order_relaxed);
+
+  // All button ISRs run on the core that attached them, so this is the
+  // ring's only producer
+  const uint8_t t = self.mEdgeTail.load(std::memory_order_relaxed);
+  if ((uint8_t)(t - self.mEdgeHead.load(std::memory_order_acquire)) >= EDGE_RING)
+  {
+    self.mLost.fetch_add(1, std::memory_order_relaxed); // the level above still lands
+    return;
+  }
+  self.mEdges[t % EDGE_RING] = Edge{(uint32_t)micros(), ref.button, down};
+  self.mEdgeTail.store((uint8_t)(t + 1), std::memory_order_release);
+}
+
+// -------------------- loop side --------------------
+void ButtonEvents::begin(const ButtonConfig *cfg, int n)
+{
+  mCount = min(n, MAX_BUTTONS);
+  const uint32_t now = micros();
+  for (int i = 0; i < mCount; ++i)
+  {
+    mCfg[i] = cfg[i];
+    mRefs[i] = PinRef{this, (uint8_t)i};
+    pinMode(cfg[i].pin, INPUT_PULLUP);
+    const bool down = readDown((uint8_t)i);
+    mLevel[i].store(down, std::memory_order_relaxed);
+    mState[i] = State{down, true, 0, now, 0}; // held at boot: no gestures until released
+    attachInterruptArg(digitalPinToInterrupt(cfg[i].pin), onEdge, &mRefs[i], CHANGE);
+  }
+}
+
+bool ButtonEvents::next(ButtonEvent &e)
+{
+  if (mOutHead == mOutTail)
+    service(micros());
+  if (mOutHead == mOutTail)
+    return false;
+  e = mOut[mOutHead % OUT_RING];
+  ++mOutHead;
+  return true;
+}
+
+void ButtonEvents::service(uint32_t nowUs)
+{
+  // Edges, in order, on the times they happened
+  uint8_t h = mEdgeHead.load(std::memory_order_relaxed);
+  const uint8_t t = mEdgeTail.load(std::memory_order_acquire);
+  for (; h != t; ++h)
+  {
+    const Edge e = mEdges[h % EDGE_RING];
+    const State &s = mState[e.button];
+    if (e.down != s.down && (int32_t)(e.us - s.acceptedUs) >= (int32_t)DEBOUNCE_US)
+      accept(e.button, e.down, e.us);
+  }
+  mEdgeHead.store(h, std::memory_order_release);
+
+  for (uint8_t i = 0; i < mCount; ++i)
+  {
+    State &s = mState[i];
+    const int32_t sinceUs = (int32_t)(nowUs - s.acceptedUs); // < 0 for an edge after nowUs was read
+    if (sinceUs < (int32_t)DEBOUNCE_US)
+      continue;
+    // A level that settled during the lockout, or whose edge was lost
+    const bool level = mLevel[i].load(std::memory_order_relaxed);
+    if (level != s.down)
+      accept(i, level, nowUs);
+    if (!s.down)
+      continue;
+
+    if (mCfg[i].longPress && !s.longFired && sinceUs >= (int32_t)LONG_US)
+    {
+      s.longFired = true;
+      emit(i, BTN_LONG);
+    }
+    // Repeats due during a long frame all come out, so a held button steps
+    // at the same rate whatever the frame time
+    while (mCfg[i].repeat && (int32_t)(nowUs - s.nextRepeatUs) >= 0 &&
+           (uint8_t)(mOutTail - mOutHead) < OUT_RING)
+    {
+      s.repeats++;
+      s.nextRepeatUs += REPEAT_US;
+      emit(i, BTN_REPEAT);
+    }
+  }
+}
+
+void ButtonEvents::accept(uint8_t button, bool down, uint32_t us)
+{
+  State &s = mState[button];
+  const bool wasLong = s.longFired;
+  s.down = down;
+  s.acceptedUs = us;
+  if (down)
+  {
+    s.longFired = false;
+    s.repeats = 0;
+    s.nextRepeatUs = us + REPEAT_DELAY_US;
+    emit(button, BTN_PRESS);
+  }
+  else if (!wasLong)
+    emit(button, BTN_CLICK);
+}
+
+void ButtonEvents::emit(uint8_t button, ButtonGesture g)
+{
+  if ((uint8_t)(mOutTail - mOutHead) >= OUT_RING)
+    return; // the loop is far behind; gestures are not worth queuing further
+  mOut[mOutTail % OUT_RING] = ButtonEvent{button, g, mState[button].repeats};
+  ++mOutTail;
+}
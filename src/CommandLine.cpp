@@ -0,0 +1,96 @@
+// ==================== CommandLine.cpp (non-blocking serial command lines) ====================
+#include <ctype.h>
+#include <string.h>
+#include <strings.h>
+#include "CommandLine.h"
+
+namespace
+{
+char *trim(char *s)
+{
+  while (*s == ' ' || *s == '\t')
+    ++s;
+  char *end = s + strlen(s);
+  while (end > s && (end[-1] == ' ' || end[-1] == '\t'))
+    *--end = 0;
+  return s;
+}
+} // namespace
+
+// -------------------- CommandLine --------------------
+bool CommandLine::push(char c)
+{
+  if (mDone)
+  {
+    mLen = 0;
+    mDone = mOverflow = false;
+  }
+  if (c == '\n' || c == '\r')
+  {
+    if (mLen == 0 && !mOverflow)
+      return false; // blank line, or the LF of a CRLF
+    mBuf[mLen] = 0;
+    mDone = true;
+    return true;
+  }
+  if (c == 0)
+    return false; // terminals and the stream host send them; they would end the line early
+  if (c == '\b' || c == 0x7F)
+  {
+    if (mLen)
+      --mLen;
+    return false;
+  }
+  if (mLen < MAX_LEN)
+    mBuf[mLen++] = c;
+  else
+    mOverflow = true;
+  return false;
+}
+
+// -------------------- parsing --------------------
+char *nextCommand(char *&s)
+{
+  while (s && *s)
+  {
+    char *cmd = s;
+    char *semi = strchr(s, ';');
+    if (semi)
+    {
+      *semi = 0;
+      s = semi + 1;
+    }
+    else
+      s = nullptr;
+    cmd = trim(cmd);
+    if (*cmd)
+      return cmd;
+  }
+  return nullptr;
+}
+
+Command splitCommand(char *cmd)
+{
+  char *cut = strchr(cmd, '=');
+  if (!cut)
+    cut = strchr(cmd, ' ');
+  if (cut)
+  {
+    *cut = 0;
+    const char *key = trim(cmd);
+    return Command{key, strlen(key), trim(cut + 1)};
+  }
+
+  // "f8000": letters then a number, no separator
+  char *p = cmd;
+  while (isalpha((unsigned char)*p))
+    ++p;
+  if (p != cmd && (isdigit((unsigned char)*p) || *p == '.'))
+    return Command{cmd, (size_t)(p - cmd), p};
+  return Command{cmd, strlen(cmd), cmd + strlen(cmd)};
+}
+
+bool Command::keyIs(const char *name) const
+{
+  return strlen(name) == keyLen && strncasecmp(key, name, keyLen) == 0;
+}
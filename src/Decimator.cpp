@@ -0,0 +1,60 @@
+// ==================== Decimator.cpp (many samples per plot column) ====================
+#include "Decimator.h"
+
+void Decimator::configure(uint16_t factor, DecimMode mode)
+{
+  mFactor = factor < 2 ? 2 : factor;
+  mMode = mode;
+  reset();
+}
+
+void Decimator::reset()
+{
+  mCount = 0;
+  mSum = 0;
+}
+
+size_t Decimator::process(const int16_t *in, size_t n, int16_t *out)
+{
+  size_t produced = 0;
+  for (size_t i = 0; i < n; ++i)
+  {
+    const int16_t v = in[i];
+    if (mMode == DECIM_AVERAGE)
+    {
+      mSum += v;
+    }
+    else if (mCount == 0)
+    {
+      mMin = mMax = v;
+      mMinAt = mMaxAt = 0;
+    }
+    else if (v < mMin)
+    {
+      mMin = v;
+      mMinAt = mCount;
+    }
+    else if (v > mMax)
+    {
+      mMax = v;
+      mMaxAt = mCount;
+    }
+
+    if (++mCount < mFactor)
+      continue;
+
+    if (mMode == DECIM_AVERAGE)
+    {
+      out[produced++] = (int16_t)((mSum + mFactor / 2) / mFactor);
+      mSum = 0;
+    }
+    else
+    {
+      const bool minFirst = mMinAt <= mMaxAt;
+      out[produced++] = minFirst ? mMin : mMax;
+      out[produced++] = minFirst ? mMax : mMin;
+    }
+    mCount = 0;
+  }
+  return produced;
+}
@@ -0,0 +1,271 @@
+// ==================== Fft.cpp (fixed-point real FFT for the spectrum view) ====================
+#include <Arduino.h>
+#include "Fft.h"
+#include "CycleCount.h"
+
+// -------------------- compile-time tables --------------------
+namespace
+{
+constexpr double PI_D = 3.14159265358979323846;
+constexpr int FFT_LOG2_HALF = 10; // log2(FFT_MAX / 2)
+static_assert((1 << FFT_LOG2_HALF) == FFT_MAX / 2, "FFT_LOG2_HALF out of step with FFT_MAX");
+
+// Taylor series, accurate to double precision on [-pi, pi]
+constexpr double cSin(double x)
+{
+  while (x > PI_D)
+    x -= 2 * PI_D;
+  while (x < -PI_D)
+    x += 2 * PI_D;
+  double term = x, sum = x;
+  for (int i = 1; i < 14; ++i)
+  {
+    term *= -x * x / ((2.0 * i) * (2.0 * i + 1.0));
+    sum += term;
+  }
+  return sum;
+}
+
+constexpr double cCos(double x)
+{
+  return cSin(x + PI_D / 2);
+}
+
+// ln(y) = 2 atanh((y-1)/(y+1)); converges quickly for y in [1, 2]
+constexpr double cLog2(double y)
+{
+  const double z = (y - 1.0) / (y + 1.0);
+  double term = z, sum = 0.0;
+  for (int i = 0; i < 20; ++i)
+  {
+    sum += term / (2 * i + 1);
+    term *= z * z;
+  }
+  return 2.0 * sum / 0.69314718055994531;
+}
+
+constexpr int16_t toQ15(double v)
+{
+  double s = v * 32768.0;
+  s += (s >= 0) ? 0.5 : -0.5;
+  if (s > 32767.0)
+    s = 32767.0;
+  if (s < -32768.0)
+    s = -32768.0;
+  return (int16_t)s;
+}
+
+// Cosine-sum window coefficients (periodic); coherent gain is a[0].
+constexpr double WIN_COEF[WIN_COUNT][5] = {
+    {0.5, 0.5, 0.0, 0.0, 0.0},                                            // Hann
+    {0.42, 0.5, 0.08, 0.0, 0.0},                                          // Blackman
+    {0.21557895, 0.41663158, 0.277263158, 0.083578947, 0.006947368}};     // flat-top
+
+constexpr int LOG2_LUT_BITS = 6;
+constexpr int32_t Q15_HALF = 1 << 14; // rounds a Q15 product instead of truncating it
+
+struct FftTables
+{
+  int16_t cosT[FFT_MAX / 2 + 1]; // cos(2*pi*k/FFT_MAX)
+  int16_t sinT[FFT_MAX / 2 + 1];
+  uint16_t rev[FFT_MAX / 2];     // 10-bit bit reversal
+  int16_t win[WIN_COUNT][FFT_MAX / 2 + 1]; // first half (+ centre) of each window
+  int16_t log2Frac[(1 << LOG2_LUT_BITS) + 1]; // log2(1 + i/64) in Q10
+};
+
+constexpr FftTables makeTables()
+{
+  FftTables t{};
+  for (int k = 0; k <= FFT_MAX / 2; ++k)
+  {
+    const double a = 2.0 * PI_D * k / FFT_MAX;
+    t.cosT[k] = toQ15(cCos(a));
+    t.sinT[k] = toQ15(cSin(a));
+  }
+  for (int i = 0; i < FFT_MAX / 2; ++i)
+  {
+    int r = 0;
+    for (int b = 0; b < FFT_LOG2_HALF; ++b)
+      if (i & (1 << b))
+        r |= 1 << (FFT_LOG2_HALF - 1 - b);
+    t.rev[i] = (uint16_t)r;
+  }
+  for (int w = 0; w < WIN_COUNT; ++w)
+  {
+    for (int n = 0; n <= FFT_MAX / 2; ++n)
+    {
+      const double a = 2.0 * PI_D * n / FFT_MAX;
+      double v = 0.0, sign = 1.0;
+      for (int h = 0; h < 5; ++h, sign = -sign)
+        v += sign * WIN_COEF[w][h] * cCos(h * a);
+      t.win[w][n] = toQ15(v);
+    }
+  }
+  for (int i = 0; i <= (1 << LOG2_LUT_BITS); ++i)
+    t.log2Frac[i] = (int16_t)(cLog2(1.0 + (double)i / (1 << LOG2_LUT_BITS)) * 1024.0 + 0.5);
+  return t;
+}
+
+constexpr FftTables TABLES = makeTables();
+
+// log2(v) in Q10, v > 0; 64-bit, as a bin's power can pass 2^32
+int32_t log2Q10(uint64_t v)
+{
+  const int msb = 63 - __builtin_clzll(v);
+  // Mantissa as 16 fractional bits below the leading one
+  const uint32_t frac = (uint32_t)(msb >= 16 ? v >> (msb - 16) : v << (16 - msb)) & 0xFFFF;
+  const uint32_t idx = frac >> (16 - LOG2_LUT_BITS);
+  const uint32_t rem = frac & ((1u << (16 - LOG2_LUT_BITS)) - 1);
+  const int32_t a = TABLES.log2Frac[idx];
+  const int32_t b = TABLES.log2Frac[idx + 1];
+  return msb * 1024 + a + (int32_t)(((b - a) * (int32_t)rem) >> (16 - LOG2_LUT_BITS));
+}
+} // namespace
+
+int16_t fftPeakAt(const int16_t *db, int bins, int pos, int positions)
+{
+  const int m = bins - 1; // bin m is Fs/2, at the last position
+  const int w = positions - 1;
+  // Bins whose centre rounds to this position; the nearest one if none do
+  int lo = ((2 * pos - 1) * m + 2 * w - 1) / (2 * w);
+  int hi = ((2 * pos + 1) * m) / (2 * w);
+  if (lo < 0)
+    lo = 0;
+  if (hi > m)
+    hi = m;
+  if (hi < lo)
+    lo = hi = (pos * m + w / 2) / w;
+  int16_t best = db[lo];
+  for (int k = lo + 1; k <= hi; ++k)
+    if (db[k] > best)
+      best = db[k];
+  return best;
+}
+
+// -------------------- RealFft --------------------
+const char *RealFft::windowName(FftWindow w)
+{
+  switch (w)
+  {
+  case WIN_HANN:
+    return "Hann";
+  case WIN_BLACKMAN:
+    return "Blackman";
+  case WIN_FLATTOP:
+    return "Flat-top";
+  default:
+    return "?";
+  }
+}
+
+void RealFft::prepareReference(int n, FftWindow w)
+{
+  // A ±2048 code sine, shifted up 3 bits on input, peaks at 8192 * n * gain
+  // in the unscaled real DFT; that is 0 dBFS.
+  const double peak = 8192.0 * n * WIN_COEF[w][0];
+  mRefDb = (int32_t)lround(200.0 * log10(peak));
+  mRefN = n;
+  mRefWin = w;
+}
+
+void RealFft::run(const int16_t *x, int n, int16_t dc, FftWindow w, int16_t *outDb)
+{
+  const uint32_t c0 = cycleCount();
+  if (w >= WIN_COUNT)
+    w = WIN_HANN;
+  if (n != mRefN || w != mRefWin)
+    prepareReference(n, w);
+
+  const int m = n / 2; // complex points
+  int log2m = 0;
+  while ((1 << log2m) < m)
+    ++log2m;
+  const int revShift = FFT_LOG2_HALF - log2m;
+  const int stride = FFT_MAX / n; // window / real-twiddle step for this size
+  const int16_t *win = TABLES.win[w];
+
+  // Window, pack even/odd samples as re/im, and store in bit-reversed order.
+  for (int i = 0; i < m; ++i)
+  {
+    const int e = 2 * i, o = 2 * i + 1;
+    const int32_t we = win[(e <= m ? e : n - e) * stride];
+    const int32_t wo = win[(o <= m ? o : n - o) * stride];
+    const int j = TABLES.rev[i] >> revShift;
+    // Up 3 bits as a multiply: a left shift of a negative value is undefined
+    mRe[j] = (int16_t)(((int32_t)(x[e] - dc) * 8 * we + Q15_HALF) >> 15);
+    mIm[j] = (int16_t)(((int32_t)(x[o] - dc) * 8 * wo + Q15_HALF) >> 15);
+  }
+
+  // Radix-2 decimation-in-time butterflies with block floating point
+  int exponent = 0;
+  for (int len = 2; len <= m; len <<= 1)
+  {
+    int16_t peak = 0;
+    for (int i = 0; i < m; ++i)
+    {
+      const int16_t a = (int16_t)abs(mRe[i]), b = (int16_t)abs(mIm[i]);
+      if (a > peak)
+        peak = a;
+      if (b > peak)
+        peak = b;
+    }
+    if (peak > 13000) // a butterfly can grow a value by up to 1 + sqrt(2)
+    {
+      for (int i = 0; i < m; ++i)
+      {
+        mRe[i] >>= 1;
+        mIm[i] >>= 1;
+      }
+      ++exponent;
+    }
+
+    const int half = len / 2;
+    const int tstep = FFT_MAX / len;
+    for (int start = 0; start < m; start += len)
+    {
+      for (int k = 0; k < half; ++k)
+      {
+        const int32_t c = TABLES.cosT[k * tstep];
+        const int32_t s = TABLES.sinT[k * tstep];
+        const int i1 = start + k, i2 = i1 + half;
+        // (re + j im) * (c - j s)
+        const int32_t tr = ((int32_t)mRe[i2] * c + (int32_t)mIm[i2] * s + Q15_HALF) >> 15;
+        const int32_t ti = ((int32_t)mIm[i2] * c - (int32_t)mRe[i2] * s + Q15_HALF) >> 15;
+        mRe[i2] = (int16_t)(mRe[i1] - tr);
+        mIm[i2] = (int16_t)(mIm[i1] - ti);
+        mRe[i1] = (int16_t)(mRe[i1] + tr);
+        mIm[i1] = (int16_t)(mIm[i1] + ti);
+      }
+    }
+  }
+
+  // Split: X[k] = E[k] + W^k O[k], E/O recovered from Z[k] and conj(Z[m-k]).
+  const int32_t expDb = (int32_t)exponent * 602; // 0.1 dB per doubling of power, x10 for rounding
+  for (int k = 0; k <= m; ++k)
+  {
+    const int a = k & (m - 1);
+    const int b = (m - k) & (m - 1);
+    const int32_t zr = mRe[a], zi = mIm[a];
+    const int32_t cr = mRe[b], ci = -mIm[b];
+    const int32_t er = (zr + cr) >> 1, ei = (zi + ci) >> 1; // even part
+    const int32_t orr = (zi - ci) >> 1, oi = -((zr - cr) >> 1); // odd part: (Z - conj)/(2j)
+    const int32_t c = TABLES.cosT[k * stride];
+    const int32_t s = TABLES.sinT[k * stride];
+    const int32_t xr = er + ((orr * c + oi * s + Q15_HALF) >> 15);
+    const int32_t xi = ei + ((oi * c - orr * s + Q15_HALF) >> 15);
+
+    // |xr| and |xi| reach 2^16 near DC and Fs/2: square in 64 bits
+    const uint64_t power = (uint64_t)((int64_t)xr * xr + (int64_t)xi * xi);
+    int32_t db = FFT_DB_FLOOR;
+    if (power)
+    {
+      // 10*log10(p) in 0.1 dB = 30.103 * log2(p)
+      db = (int32_t)(((int64_t)log2Q10(power) * 30103) / (1024 * 1000)) + expDb / 10 - mRefDb;
+      if (db < FFT_DB_FLOOR)
+        db = FFT_DB_FLOOR;
+    }
+    outDb[k] = (int16_t)db;
+  }
+
+  mCycles = cycleCount() - c0;
+}
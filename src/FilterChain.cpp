@@ -0,0 +1,174 @@
+// ==================== FilterChain.cpp (fixed-point sample filters) ====================
+#include <Arduino.h>
+#include <math.h>
+#include "FilterChain.h"
+#include "CycleCount.h"
+
+namespace
+{
+constexpr int SAMPLE_SHIFT = 3; // 12-bit codes about the centre -> Q15
+constexpr int COEF_BITS = 30;
+
+int16_t toQ15(float v)
+{
+  return (int16_t)constrain(lroundf(v * 32768.0f), -32768L, 32767L);
+}
+
+int32_t clampQ15(int32_t v)
+{
+  return v > 32767 ? 32767 : (v < -32768 ? -32768 : v);
+}
+} // namespace
+
+// -------------------- design --------------------
+void FilterChain::configure(const FilterSettings &s, uint32_t fs)
+{
+  mSettings = s;
+  const float k = log2f(fs / (2.0f * (float)M_PI * DC_CORNER_HZ));
+  mDcShift = (uint8_t)constrain(lroundf(k), 4L, 16L);
+  designBiquad(fs);
+  designFir(fs);
+  reset();
+}
+
+// RBJ cookbook sections. The coefficients carry 30 fraction bits rather
+// than 15: at a corner near Fs/2000 a low-pass b0 is ~1e-6, far under one
+// Q15 step. The samples themselves stay Q15.
+void FilterChain::designBiquad(uint32_t fs)
+{
+  mBiquadHz = 0;
+  if (mSettings.biquad == BIQUAD_OFF)
+    return;
+  mBiquadHz = constrain(mSettings.biquadHz, max(1u, fs / 2000), fs * 9 / 20);
+  // In double: 1 - cos(w0) is ~5e-6 at the lowest corner
+  const double w0 = 2.0 * M_PI * mBiquadHz / fs;
+  const double alpha = sin(w0) / (2.0 * mSettings.biquadQ);
+  const double oneMinusCos = 2.0 * sin(w0 / 2) * sin(w0 / 2);
+  double b[3];
+  if (mSettings.biquad == BIQUAD_LOWPASS)
+  {
+    b[0] = b[2] = oneMinusCos / 2.0;
+    b[1] = oneMinusCos;
+  }
+  else
+  {
+    b[0] = alpha; // 0 dB at the centre
+    b[1] = 0.0;
+    b[2] = -alpha;
+  }
+  const double scale = (double)(1L << COEF_BITS) / (1.0 + alpha);
+  for (int i = 0; i < 3; ++i)
+    mB[i] = (int32_t)llround(b[i] * scale);
+  mA[0] = (int32_t)llround(-2.0 * (1.0 - oneMinusCos) * scale);
+  mA[1] = (int32_t)llround((1.0 - alpha) * scale);
+}
+
+// Hamming-windowed sinc, taps summing to exactly 1.0 in Q15
+void FilterChain::designFir(uint32_t fs)
+{
+  mFirHz = 0;
+  if (!mSettings.firHz)
+    return;
+  mFirHz = constrain(mSettings.firHz, fs / 50, fs * 9 / 20);
+  const float fc = (float)mFirHz / fs;
+  constexpr int MID = FIR_TAPS / 2;
+  float h[FIR_TAPS];
+  float sum = 0.0f;
+  for (int i = 0; i < FIR_TAPS; ++i)
+  {
+    const int m = i - MID;
+    const float sinc = m ? sinf(2.0f * (float)M_PI * fc * m) / ((float)M_PI * m) : 2.0f * fc;
+    h[i] = sinc * (0.54f - 0.46f * cosf(2.0f * (float)M_PI * i / (FIR_TAPS - 1)));
+    sum += h[i];
+  }
+  int32_t total = 0;
+  for (int i = 0; i < FIR_TAPS; ++i)
+  {
+    mTaps[i] = toQ15(h[i] / sum);
+    total += mTaps[i];
+  }
+  mTaps[MID] = (int16_t)(mTaps[MID] + (32768 - total)); // rounding left over
+}
+
+void FilterChain::reset()
+{
+  mX1 = mX2 = mY1 = mY2 = 0;
+  mErr = 0;
+  for (int16_t &v : mFirHist)
+    v = 0;
+  mFirPos = 0;
+}
+
+// -------------------- samples --------------------
+void FilterChain::process(int16_t *s, size_t n)
+{
+  if (!n)
+    return;
+  const uint32_t start = cycleCount();
+  if (!mDcPrimed)
+  {
+    mDcAcc = (int32_t)s[0] << 16;
+    mDcPrimed = true;
+  }
+  const uint8_t k = mDcShift;
+  const bool block = mSettings.dcBlock;
+  const bool biquad = mBiquadHz != 0;
+  const bool fir = mFirHz != 0;
+
+  if (!block && !biquad && !fir)
+  {
+    // Tracking only: the samples pass untouched
+    for (size_t i = 0; i < n; ++i)
+      mDcAcc += (((int32_t)s[i] << 16) - mDcAcc) >> k;
+  }
+  else
+  {
+    for (size_t i = 0; i < n; ++i)
+    {
+      const int32_t x = s[i];
+      mDcAcc += ((x << 16) - mDcAcc) >> k;
+      // Q15 about the centre; blocking keeps the estimate's fraction
+      int32_t v = block ? ((x << 16) - mDcAcc) >> (16 - SAMPLE_SHIFT) : (x - ADC_MID) << SAMPLE_SHIFT;
+
+      if (biquad)
+      {
+        // Direct form I; the bits shifted off each output are fed back into
+        // the next, so rounding cannot build up near a pole at z = 1
+        int64_t acc = mErr + (int64_t)mB[0] * v + (int64_t)mB[1] * mX1 + (int64_t)mB[2] * mX2 -
+                      (int64_t)mA[0] * mY1 - (int64_t)mA[1] * mY2;
+        const int32_t y = clampQ15((int32_t)(acc >> COEF_BITS));
+        mErr = acc - ((int64_t)y << COEF_BITS);
+        if (mErr < -(1LL << COEF_BITS) || mErr >= (1LL << COEF_BITS))
+          mErr = 0; // clipped: don't carry the overshoot
+        mX2 = mX1;
+        mX1 = v;
+        mY2 = mY1;
+        mY1 = y;
+        v = y;
+      }
+
+      if (fir)
+      {
+        mFirPos = mFirPos ? mFirPos - 1 : FIR_TAPS - 1;
+        mFirHist[mFirPos] = mFirHist[mFirPos + FIR_TAPS] = (int16_t)clampQ15(v);
+        const int16_t *h = mFirHist + mFirPos; // h[j] is j samples ago
+        int32_t acc = 1 << 14;
+        for (int j = 0; j < FIR_TAPS; ++j)
+          acc += (int32_t)mTaps[j] * h[j];
+        v = acc >> 15;
+      }
+
+      const int32_t out = ((v + (1 << (SAMPLE_SHIFT - 1))) >> SAMPLE_SHIFT) + ADC_MID;
+      s[i] = (int16_t)constrain(out, 0L, 4095L);
+    }
+  }
+  mCycles += cycleCount() - start;
+  mSamples += (uint32_t)n;
+}
+
+uint32_t FilterChain::takeCyclesPerSample()
+{
+  const uint32_t cps = mSamples ? mCycles / mSamples : 0;
+  mCycles = mSamples = 0;
+  return cps;
+}
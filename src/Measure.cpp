@@ -0,0 +1,150 @@
+// ==================== Measure.cpp (running waveform measurements) ====================
+#include "Measure.h"
+
+namespace
+{
+// floor(sqrt(v)), bit by bit
+uint32_t isqrt64(uint64_t v)
+{
+  uint64_t root = 0;
+  uint64_t bit = 1ULL << 62;
+  while (bit > v)
+    bit >>= 2;
+  while (bit)
+  {
+    if (v >= root + bit)
+    {
+      v -= root + bit;
+      root = (root >> 1) + bit;
+    }
+    else
+      root >>= 1;
+    bit >>= 2;
+  }
+  return (uint32_t)root;
+}
+} // namespace
+
+void MeasureAccumulator::add(const int16_t *s, size_t n)
+{
+  if (mCount + n > MAX_WINDOW)
+    clearSums();
+  const int32_t pivot = mPivot;
+  for (size_t i = 0; i < n; ++i)
+  {
+    const int16_t v = s[i];
+    const int32_t d = v - pivot;
+    mSum += d;
+    mSumSq += (uint32_t)(d * d);
+    mTotal += v;
+    if (v < mMin)
+      mMin = v;
+    if (v > mMax)
+      mMax = v;
+
+    if (!mArmed)
+    {
+      mArmed = v < mLow;
+      continue;
+    }
+    if (v <= mHigh)
+      continue;
+    const uint32_t at = mPos + (uint32_t)i;
+    const int64_t before = mTotal - v; // of the samples ahead of this one
+    if (mHaveCrossing && !mSkipInterval)
+    {
+      mIntervals += at - mLastCrossing;
+      mIntervalCount++;
+      mCycleSum += before - mLastCrossingTotal;
+      mCycleLen += at - mLastCrossing;
+    }
+    mLastCrossing = at;
+    mLastCrossingTotal = before;
+    mHaveCrossing = true;
+    mSkipInterval = false;
+    mArmed = false;
+  }
+  mCount += (uint32_t)n;
+  mPos += (uint32_t)n;
+}
+
+Measurements MeasureAccumulator::take()
+{
+  Measurements m{};
+  if (mCount == 0)
+    return m;
+
+  // Mean and variance relative to the pivot: var = E[d^2] - E[d]^2, in Q16
+  const int64_t meanDQ8 = mSum * 256 / (int64_t)mCount;
+  const int64_t varQ16 = (int64_t)((mSumSq << 16) / mCount) - meanDQ8 * meanDQ8;
+  m.samples = mCount;
+  m.min = mMin;
+  m.max = mMax;
+  m.meanQ8 = (int32_t)(mPivot * 256 + meanDQ8);
+  m.rmsQ8 = varQ16 > 0 ? isqrt64((uint64_t)varQ16) : 0;
+
+  // A period is kept through windows with no full cycle, until it is overdue
+  if (mIntervalCount)
+    mPeriodQ8 = (uint32_t)(mIntervals * 256 / mIntervalCount);
+  else if (!mHaveCrossing || (uint64_t)(mPos - mLastCrossing) * 256 > 2ULL * mPeriodQ8)
+    mPeriodQ8 = 0;
+  m.periodQ8 = mPeriodQ8;
+
+  // The next window pivots on this mean
+  mPivot = (int16_t)((m.meanQ8 + 128) >> 8);
+
+  // Crossings are looked for about the mean of the cycles completed since the
+  // level was last looked at, with hysteresis an eighth of the swing. With
+  // no cycle in yet and no period known, this window's mean is the best
+  // there is. The rising level only moves when it is off by more than a
+  // quarter of the hysteresis, and the interval across the move is not
+  // timed: it runs from a crossing of one level to a crossing of another.
+  mLevelMin = mMin < mLevelMin ? mMin : mLevelMin;
+  mLevelMax = mMax > mLevelMax ? mMax : mLevelMax;
+  if (mCycleLen || !mPeriodQ8)
+  {
+    const int16_t mid = mCycleLen ? (int16_t)((mCycleSum + mCycleLen / 2) / mCycleLen) : mPivot;
+    const int16_t hyst = (int16_t)(((mLevelMax - mLevelMin) / 8) > 8 ? (mLevelMax - mLevelMin) / 8 : 8);
+    const int16_t high = mid + hyst;
+    if ((high > mHigh ? high - mHigh : mHigh - high) > hyst / 4)
+    {
+      mHigh = high;
+      mSkipInterval = mPeriodQ8 != 0;
+    }
+    mLow = mid - hyst;
+    clearLevel();
+  }
+  clearSums();
+  return m;
+}
+
+void MeasureAccumulator::restart()
+{
+  clearSums();
+  clearLevel();
+  mPeriodQ8 = 0;
+  mPos = 0;
+  mTotal = 0;
+  mHaveCrossing = false;
+  mSkipInterval = false;
+  mArmed = false;
+}
+
+void MeasureAccumulator::clearLevel()
+{
+  mCycleSum = 0;
+  mCycleLen = 0;
+  mLevelMin = 0x7FFF;
+  mLevelMax = -0x7FFF;
+}
+
+void MeasureAccumulator::clearSums()
+{
+  mCount = 0;
+  mSum = 0;
+  mSumSq = 0;
+  mMin = 0x7FFF;
+  mMax = -0x7FFF;
+  mIntervals = 0;
+  mIntervalCount = 0;
+}
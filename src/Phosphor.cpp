@@ -0,0 +1,110 @@
+// ==================== Phosphor.cpp (intensity-graded persistence) ====================
+#include <Arduino.h>
+#include "Phosphor.h"
+
+#if defined(ARDUINO_ARCH_ESP32)
+#include <esp_heap_caps.h>
+#endif
+
+void Phosphor::setDecay(uint8_t shift)
+{
+  mShift = constrain(shift, DECAY_MIN, DECAY_MAX);
+}
+
+bool Phosphor::allocate()
+{
+  if (mHits)
+    return true;
+#if defined(ARDUINO_ARCH_ESP32)
+  mHits = (uint32_t *)heap_caps_malloc(WORDS * 4, MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+  if (!mHits)
+    mHits = (uint32_t *)heap_caps_malloc(WORDS * 4, MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+#else
+  mHits = (uint32_t *)malloc(WORDS * 4);
+#endif
+  clear();
+  return mHits != nullptr;
+}
+
+void Phosphor::clear()
+{
+  if (mHits)
+    memset(mHits, 0, WORDS * 4);
+  for (bool &lit : mBandLit)
+    lit = false;
+}
+
+void Phosphor::decay()
+{
+  if (!mHits)
+    return;
+  // Per byte: v -= v >> shift, then v -= 1 where v is still non-zero. The
+  // mask drops the bits each shifted byte takes from its neighbour, and
+  // neither step can borrow across a byte.
+  const uint32_t keep = 0x01010101u * (0xFFu >> mShift);
+  uint32_t *w = mHits;
+  for (int b = 0; b < BandCompositor::BAND_COUNT; ++b)
+  {
+    const size_t rows = (size_t)min(BandCompositor::BAND_ROWS, PLOT_H - b * BandCompositor::BAND_ROWS);
+    uint32_t *end = w + rows * PLOT_W / 4;
+    if (!mBandLit[b])
+    {
+      w = end;
+      continue;
+    }
+    uint32_t any = 0;
+    for (; w < end; ++w)
+    {
+      uint32_t v = *w;
+      if (!v)
+        continue;
+      v -= (v >> mShift) & keep;
+      const uint32_t nonZero = (((v & 0x7F7F7F7Fu) + 0x7F7F7F7Fu) | v) & 0x80808080u;
+      v -= nonZero >> 7;
+      *w = v;
+      any |= v;
+    }
+    mBandLit[b] = any != 0;
+  }
+}
+
+void Phosphor::addSpans(const int16_t *top, const int16_t *bot)
+{
+  if (!mHits)
+    return;
+  uint8_t *hits = (uint8_t *)mHits;
+  int yMin = PLOT_H, yMax = -1;
+  for (int x = 0; x < PLOT_W; ++x)
+  {
+    const int y0 = max(top[x] - PLOT_Y0, 0);
+    const int y1 = min(bot[x] - PLOT_Y0, PLOT_H - 1);
+    if (y0 > y1)
+      continue;
+    yMin = min(yMin, y0);
+    yMax = max(yMax, y1);
+    uint8_t *p = hits + y0 * PLOT_W + x;
+    for (int y = y0; y <= y1; ++y, p += PLOT_W)
+      *p = *p > 255 - HIT ? 255 : (uint8_t)(*p + HIT);
+  }
+  for (int y = yMin; y <= yMax; y += BandCompositor::BAND_ROWS)
+    mBandLit[y / BandCompositor::BAND_ROWS] = true;
+  if (yMax >= 0)
+    mBandLit[yMax / BandCompositor::BAND_ROWS] = true;
+}
+
+void Phosphor::addPoints(const int16_t *xs, const int16_t *ys, size_t n)
+{
+  if (!mHits)
+    return;
+  uint8_t *hits = (uint8_t *)mHits;
+  for (size_t i = 0; i < n; ++i)
+  {
+    const int x = xs[i] - PLOT_X0;
+    const int y = ys[i] - PLOT_Y0;
+    if (x < 0 || x >= PLOT_W || y < 0 || y >= PLOT_H)
+      continue;
+    uint8_t *p = hits + y * PLOT_W + x;
+    *p = *p > 255 - HIT ? 255 : (uint8_t)(*p + HIT);
+    mBandLit[y / BandCompositor::BAND_ROWS] = true;
+  }
+}
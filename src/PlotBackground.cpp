@@ -0,0 +1,132 @@
+// ==================== PlotBackground.cpp (what lies under the traces) ====================
+#include <Arduino.h>
+#include "PlotBackground.h"
+
+// -------------------- model --------------------
+void PlotBackground::setFill(uint16_t colBg)
+{
+  if (colBg != mColBg)
+    markAll();
+  mColBg = colBg;
+}
+
+void PlotBackground::setGrid(const int16_t *rows, int nRows, const int16_t *cols, int nCols, uint16_t colGrid565)
+{
+  bool rowGrid[PLOT_H] = {};
+  for (int i = 0; i < nRows; ++i)
+  {
+    const int y = rows[i] - PLOT_Y0;
+    if (y >= 0 && y < PLOT_H)
+      rowGrid[y] = true;
+  }
+  bool colGrid[PLOT_W] = {};
+  for (int i = 0; i < nCols; ++i)
+  {
+    const int x = cols[i] - PLOT_X0;
+    if (x >= 0 && x < PLOT_W)
+      colGrid[x] = true;
+  }
+  // A column (or the colour) changes every row; a row line only its own
+  bool colsMoved = colGrid565 != mColGrid565;
+  for (int x = 0; x < PLOT_W && !colsMoved; ++x)
+    colsMoved = colGrid[x] != mColGrid[x];
+  if (colsMoved)
+    markAll();
+  for (int y = 0; y < PLOT_H; ++y)
+    if (rowGrid[y] != mRowGrid[y])
+      markRow(PLOT_Y0 + y);
+  memcpy(mRowGrid, rowGrid, sizeof(mRowGrid));
+  memcpy(mColGrid, colGrid, sizeof(mColGrid));
+  mColGrid565 = colGrid565;
+}
+
+void PlotBackground::setGridVisible(bool on)
+{
+  if (on != mGridVisible)
+    markAll();
+  mGridVisible = on;
+}
+
+void PlotBackground::setCursor(int index, int y, uint16_t color)
+{
+  if (index < 0 || index >= MAX_CURSORS)
+    return;
+  if (y < PLOT_Y0 || y >= PLOT_Y0 + PLOT_H)
+    y = -1;
+  if (mCursorY[index] == y && mCursorCol[index] == color)
+    return;
+  markRow(mCursorY[index]);
+  markRow(y);
+  mCursorY[index] = (int16_t)y;
+  mCursorCol[index] = color;
+  updateRowCursors();
+}
+
+void PlotBackground::updateRowCursors()
+{
+  for (int8_t &c : mRowCursor)
+    c = -1;
+  for (int c = 0; c < MAX_CURSORS; ++c)
+    if (mCursorY[c] >= 0)
+      mRowCursor[mCursorY[c] - PLOT_Y0] = (int8_t)c;
+}
+
+// -------------------- changes --------------------
+void PlotBackground::markRow(int y)
+{
+  if (y < PLOT_Y0 || y >= PLOT_Y0 + PLOT_H)
+    return;
+  mChanged[y - PLOT_Y0] = true;
+  mAnyChanged = true;
+}
+
+void PlotBackground::markAll()
+{
+  for (bool &c : mChanged)
+    c = true;
+  mAnyChanged = true;
+}
+
+void PlotBackground::takeChanges()
+{
+  if (!mAnyChanged)
+    return;
+  for (bool &c : mChanged)
+    c = false;
+  mAnyChanged = false;
+}
+
+// -------------------- pixels --------------------
+void PlotBackground::composeRow(uint16_t *line, int y) const
+{
+  const int r = y - PLOT_Y0;
+  const uint16_t fill = mGridVisible && mRowGrid[r] ? mColGrid565 : mColBg;
+  for (int x = 0; x < PLOT_W; ++x)
+    line[x] = fill;
+  if (mGridVisible && !mRowGrid[r])
+  {
+    for (int x = 0; x < PLOT_W; ++x)
+      if (mColGrid[x])
+        line[x] = mColGrid565;
+  }
+  const int8_t c = mRowCursor[r];
+  if (c >= 0)
+  {
+    for (int x = 0; x < PLOT_W; ++x)
+      if ((x & 4) == 0)
+        line[x] = mCursorCol[c];
+  }
+}
+
+void PlotBackground::paint(ScopePanel &tft)
+{
+  tft.startWrite();
+  tft.setAddrWindow(PLOT_X0, PLOT_Y0, PLOT_W, PLOT_H);
+  for (int y = PLOT_Y0; y < PLOT_Y0 + PLOT_H; ++y)
+  {
+    composeRow(mRow, y);
+    tft.writePixels(mRow, PLOT_W);
+  }
+  tft.endWrite();
+  takeChanges();
+}
@@ -0,0 +1,100 @@
+// ==================== Profiler.cpp (hot-path cycle histograms) ====================
+#include "Profiler.h"
+
+#if defined(SCOPE_PROFILE)
+namespace
+{
+CycleHistogram gHist[PROF_STAGE_COUNT];
+
+const char *const STAGE_NAMES[PROF_STAGE_COUNT] = {
+    "loop", "serial", "buttons", "capture", "fft", "map", "draw", "vu", "measure", "hud", "filter"};
+} // namespace
+
+// -------------------- CycleHistogram --------------------
+// 0..3 exact, then four sub-buckets per octave: [4,5,6,7], [8,10,12,14], ...
+int CycleHistogram::bucketOf(uint32_t v)
+{
+  if (v < 4)
+    return (int)v;
+  const int e = 31 - __builtin_clz(v);
+  return 4 * (e - 1) + (int)((v >> (e - 2)) & 3);
+}
+
+uint32_t CycleHistogram::bucketTop(int b)
+{
+  if (b < 4)
+    return (uint32_t)b;
+  const int e = b / 4 + 1;
+  const uint64_t low = (uint64_t)(4 + b % 4) << (e - 2);
+  const uint64_t top = low + ((uint64_t)1 << (e - 2)) - 1;
+  return top > UINT32_MAX ? UINT32_MAX : (uint32_t)top;
+}
+
+void CycleHistogram::clear()
+{
+  for (int i = 0; i < BUCKETS; ++i)
+    mBins[i] = 0;
+  mSum = 0;
+  mCount = 0;
+  mMin = UINT32_MAX;
+  mMax = 0;
+}
+
+void CycleHistogram::add(uint32_t cycles)
+{
+  if (mResetPending)
+  {
+    clear();
+    mResetPending = false;
+  }
+  mBins[bucketOf(cycles)]++;
+  mSum += cycles;
+  mCount++;
+  if (cycles < mMin)
+    mMin = cycles;
+  if (cycles > mMax)
+    mMax = cycles;
+}
+
+uint32_t CycleHistogram::percentile(uint8_t pct) const
+{
+  if (!mCount)
+    return 0;
+  const uint64_t rank = ((uint64_t)mCount * pct + 99) / 100; // 1-based
+  uint64_t seen = 0;
+  for (int b = 0; b < BUCKETS; ++b)
+  {
+    seen += mBins[b];
+    if (seen >= rank)
+      return bucketTop(b) < mMax ? bucketTop(b) : mMax;
+  }
+  return mMax;
+}
+
+// -------------------- stage table --------------------
+void profRecord(ProfStage stage, uint32_t cycles)
+{
+  gHist[stage].add(cycles);
+}
+
+void profReset()
+{
+  for (int s = 0; s < PROF_STAGE_COUNT; ++s)
+    gHist[s].requestReset();
+}
+
+void profDump(Print &out)
+{
+  const float cyclesPerUs = cpuHz() / 1000000.0f;
+  out.println(F("stage        count      min     mean      p99      max  (us)"));
+  for (int s = 0; s < PROF_STAGE_COUNT; ++s)
+  {
+    const CycleHistogram &h = gHist[s];
+    if (!h.count() || h.resetPending())
+      continue;
+    out.printf("%-8s %9lu %8.1f %8.1f %8.1f %8.1f\r\n", STAGE_NAMES[s], (unsigned long)h.count(),
+               h.lowest() / cyclesPerUs, h.mean() / cyclesPerUs, h.percentile(99) / cyclesPerUs,
+               h.highest() / cyclesPerUs);
+  }
+}
+#endif // SCOPE_PROFILE
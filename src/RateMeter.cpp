@@ -0,0 +1,109 @@
+// ==================== RateMeter.cpp (sample clock measurement) ====================
+#include <Arduino.h>
+#include "RateMeter.h"
+
+void RateMeter::restart(uint32_t nominalHz)
+{
+  mNominalHz = nominalHz;
+  mRateMilli = (uint64_t)nominalHz * 1000;
+  mStarted = mSettled = false;
+  mNow = mBest = mAnchor = Mark{};
+  mBestLate = INT64_MAX;
+  mBlockEnd = BLOCK_US;
+  mEarlyCount = mRecentCount = 0;
+  mSpanUs = 0;
+  for (uint32_t &c : mJitter)
+    c = 0;
+}
+
+// Against a clock at the current rate through the first candidate
+int64_t RateMeter::lateUs(const Mark &m) const
+{
+  if (!mRateMilli)
+    return 0;
+  const Mark ref = mEarlyCount ? mEarly[0] : Mark{};
+  return (int64_t)(m.t - ref.t) - (int64_t)(m.n - ref.n) * 1000000000LL / (int64_t)mRateMilli;
+}
+
+const RateMeter::Mark &RateMeter::leastLate(const Mark *marks, int count) const
+{
+  int best = 0;
+  int64_t bestLate = lateUs(marks[0]);
+  for (int i = 1; i < count; ++i)
+  {
+    const int64_t late = lateUs(marks[i]);
+    if (late < bestLate)
+    {
+      best = i;
+      bestLate = late;
+    }
+  }
+  return marks[best];
+}
+
+void RateMeter::add(uint32_t samples, uint32_t nowUs)
+{
+  if (!mStarted)
+  {
+    // The first batch only sets the origin: nothing says when it began
+    mStarted = true;
+    mLastUs = nowUs;
+    return;
+  }
+  mNow.t += (uint32_t)(nowUs - mLastUs);
+  mNow.n += samples;
+  mLastUs = nowUs;
+
+  const int64_t late = lateUs(mNow);
+  if (late < mBestLate)
+  {
+    mBest = mNow;
+    mBestLate = late;
+  }
+  if (mSettled)
+  {
+    const int64_t jitter = late - lateUs(mAnchor);
+    int bin = 0;
+    while (bin < JITTER_BINS - 1 && jitter >= (int64_t)(JITTER_BIN0_US << bin))
+      ++bin;
+    ++mJitter[bin];
+  }
+  if (mNow.t >= mBlockEnd)
+    endBlock();
+}
+
+void RateMeter::endBlock()
+{
+  mBlockEnd = mNow.t + BLOCK_US;
+  mBestLate = INT64_MAX;
+  if (mEarlyCount < CANDIDATES)
+  {
+    mEarly[mEarlyCount++] = mBest;
+    return;
+  }
+  mRecent[mRecentCount++ % CANDIDATES] = mBest;
+
+  // Which candidates are least late depends on the rate, so pick, fit, and
+  // pick again with the better slope
+  const int recent = min(mRecentCount, CANDIDATES);
+  for (int pass = 0; pass < 2; ++pass)
+  {
+    const Mark &a = leastLate(mEarly, CANDIDATES);
+    const Mark &b = leastLate(mRecent, recent);
+    if (b.t - a.t < SETTLE_US)
+      return;
+    mRateMilli = (b.n - a.n) * 1000000000ULL / (b.t - a.t);
+    mAnchor = a;
+    mSpanUs = b.t - a.t;
+  }
+  mSettled = true;
+  ++mUpdates;
+
+  if (mSpanUs >= REANCHOR_US && mRecentCount >= CANDIDATES)
+  {
+    // The recent set becomes the early one, oldest first
+    for (int i = 0; i < CANDIDATES; ++i)
+      mEarly[i] = mRecent[(mRecentCount + i) % CANDIDATES];
+    mRecentCount = 0;
+  }
+}
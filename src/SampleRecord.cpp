@@ -0,0 +1,90 @@
+// ==================== SampleRecord.cpp (deep capture memory) ====================
+#include <Arduino.h>
+#include "SampleRecord.h"
+
+#if defined(ARDUINO_ARCH_ESP32)
+#include <esp_heap_caps.h>
+#endif
+
+size_t SampleRecord::allocate(size_t maxSamples, size_t keepFreeBytes)
+{
+  size_t bytes = maxSamples * sizeof(int16_t);
+#if defined(ARDUINO_ARCH_ESP32)
+  // PSRAM first: far deeper, and the internal heap stays with the drivers
+  uint32_t caps = MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT;
+  size_t avail = heap_caps_get_largest_free_block(caps);
+  if (avail < keepFreeBytes)
+  {
+    caps = MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT;
+    const size_t freeBytes = heap_caps_get_free_size(caps);
+    avail = freeBytes > keepFreeBytes ? min(heap_caps_get_largest_free_block(caps), freeBytes - keepFreeBytes) : 0;
+  }
+  bytes = min(bytes, avail) & ~(size_t)(sizeof(int16_t) - 1);
+  mBuf = bytes ? (int16_t *)heap_caps_malloc(bytes, caps) : nullptr;
+#else
+  mBuf = (int16_t *)malloc(bytes);
+#endif
+  mCap = mBuf ? bytes / sizeof(int16_t) : 0;
+  mHead = mLen = 0;
+  return mCap;
+}
+
+void SampleRecord::append(const int16_t *s, size_t n)
+{
+  mBusy.store(true);
+  if (!mFrozen.load() && mCap)
+  {
+    mTotal += (uint32_t)n;
+    if (n > mCap)
+    {
+      s += n - mCap;
+      n = mCap;
+    }
+    const size_t first = min(n, mCap - mHead);
+    memcpy(mBuf + mHead, s, first * sizeof(int16_t));
+    memcpy(mBuf, s + first, (n - first) * sizeof(int16_t));
+    mHead = (mHead + n) % mCap;
+    mLen = min(mLen + n, mCap);
+  }
+  mBusy.store(false);
+}
+
+void SampleRecord::reset(uint32_t fs)
+{
+  // Busy before the frozen check, as in append(): a freeze() that lands in
+  // between waits for the writes to finish
+  mBusy.store(true);
+  if (!mFrozen.load()) // otherwise the display owns it
+  {
+    mHead = mLen = 0;
+    mTotal = 0;
+    mFs = fs;
+  }
+  mBusy.store(false);
+}
+
+void SampleRecord::freeze()
+{
+  mFrozen.store(true);
+  while (mBusy.load())
+    delay(0);
+}
+
+void SampleRecord::release()
+{
+  mHead = mLen = 0;
+  mTotal = 0;
+  mFrozen.store(false);
+}
+
+size_t SampleRecord::copy(size_t from, size_t n, int16_t *dst) const
+{
+  if (from >= mLen)
+    return 0;
+  n = min(n, mLen - from);
+  const size_t start = (mHead + mCap - mLen + from) % mCap;
+  const size_t first = min(n, mCap - start);
+  memcpy(dst, mBuf + start, first * sizeof(int16_t));
+  memcpy(dst + first, mBuf, (n - first) * sizeof(int16_t));
+  return n;
+}
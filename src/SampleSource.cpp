@@ -0,0 +1,427 @@
+// ==================== SampleSource.cpp (acquisition backends) ====================
+#include <Arduino.h>
+#include "SampleSource.h"
+
+#if defined(ARDUINO_ARCH_ESP32)
+#include <driver/i2s.h>
+#include <soc/syscon_struct.h>
+
+// -------------------- I2S built-in ADC --------------------
+bool I2sAdcSource::begin(uint32_t fs)
+{
+  if (mRunning)
+    end();
+
+  i2s_config_t cfg = {};
+  cfg.mode = (i2s_mode_t)(I2S_MODE_MASTER | I2S_MODE_RX | I2S_MODE_ADC_BUILT_IN);
+  cfg.sample_rate = HW_FS_MIN;
+  cfg.bits_per_sample = I2S_BITS_PER_SAMPLE_16BIT;
+  cfg.channel_format = I2S_CHANNEL_FMT_ONLY_LEFT;
+  cfg.communication_format = I2S_COMM_FORMAT_STAND_I2S;
+  cfg.intr_alloc_flags = ESP_INTR_FLAG_LEVEL1;
+  cfg.dma_buf_count = DMA_BUF_COUNT;
+  cfg.dma_buf_len = DMA_BUF_LEN;
+  cfg.use_apll = false;
+  cfg.tx_desc_auto_clear = false;
+  cfg.fixed_mclk = 0;
+
+  if (i2s_driver_install(I2S_NUM_0, &cfg, 4, &mEvents) != ESP_OK)
+    return false;
+  if (i2s_set_adc_mode(ADC_UNIT_1, mChannel) != ESP_OK)
+  {
+    i2s_driver_uninstall(I2S_NUM_0);
+    return false;
+  }
+  adc1_config_channel_atten(mChannel, ADC_ATTEN_DB_11);
+  adc1_config_channel_atten(mChannelB, ADC_ATTEN_DB_11);
+  i2s_adc_enable(I2S_NUM_0);
+  mRunning = true;
+  applyPattern();
+
+  setSampleRate(fs);
+  return true;
+}
+
+void I2sAdcSource::end()
+{
+  if (!mRunning)
+    return;
+  i2s_adc_disable(I2S_NUM_0);
+  i2s_driver_uninstall(I2S_NUM_0);
+  mEvents = nullptr;
+  mRunning = false;
+}
+
+// i2s_set_adc_mode() leaves a one-entry pattern table; with two entries the
+// controller alternates the inputs. Entries are channel:4 width:2 atten:2,
+// the first in the top byte.
+void I2sAdcSource::applyPattern()
+{
+  auto entry = [](adc1_channel_t ch)
+  { return (uint32_t)((ch << 4) | (ADC_WIDTH_BIT_12 << 2) | ADC_ATTEN_DB_11); };
+  SYSCON.saradc_ctrl.sar1_patt_len = mDual ? 1 : 0; // entries - 1
+  SYSCON.saradc_sar1_patt_tab[0] = entry(mChannel) << 24 | (mDual ? entry(mChannelB) << 16 : 0);
+}
+
+bool I2sAdcSource::setChannelB(bool on)
+{
+  if (on == mDual)
+    return true;
+  mDual = on;
+  if (mRunning)
+    applyPattern();
+  setSampleRate(mFs); // twice the conversions, or half
+  return true;
+}
+
+uint32_t I2sAdcSource::setSampleRate(uint32_t fs)
+{
+  if (fs < 1)
+    fs = 1;
+  if (fs > HW_FS_MAX / channels())
+    fs = HW_FS_MAX / channels();
+  uint32_t decim = (HW_FS_MIN + fs - 1) / fs;
+  if (decim < 1)
+    decim = 1;
+
+  mFs = fs;
+  mDecim = (uint16_t)decim;
+  mHwFs = fs * decim * channels();
+  mDdsStep = (uint64_t)fs * 1000;
+  mDdsMod = (uint64_t)fs * decim * 1000;
+  if (mRunning)
+  {
+    i2s_set_sample_rates(I2S_NUM_0, mHwFs);
+    // What the dividers came to; decim 1 has nothing to stretch, so it
+    // delivers whatever that is and the meter reports it
+    const float clk = i2s_get_clk(I2S_NUM_0);
+    if (decim > 1 && clk > 0.0f)
+      mDdsMod = (uint64_t)llroundf(clk * 1000.0f / channels());
+  }
+  mDdsPhase = 0;
+  mMeter.restart(mHwFs);
+  mMeterUpdates = 0;
+  flush();
+  return mFs;
+}
+
+uint64_t I2sAdcSource::measuredRateMilliHz() const
+{
+  if (!mMeter.settled())
+    return 0;
+  const uint64_t perChannel = mMeter.rateMilliHz() / channels();
+  return mDecim > 1 ? perChannel * mDdsStep / mDdsMod : perChannel;
+}
+
+void I2sAdcSource::track(size_t hwSamples)
+{
+  mMeter.add((uint32_t)hwSamples, micros());
+  if (mDecim <= 1 || mMeter.updates() == mMeterUpdates)
+    return;
+  mMeterUpdates = mMeter.updates();
+  mDdsMod = mMeter.rateMilliHz() / channels();
+  if (mDdsPhase >= mDdsMod)
+    mDdsPhase %= mDdsMod;
+}
+
+void I2sAdcSource::pollEvents()
+{
+  i2s_event_t ev;
+  while (mEvents && xQueueReceive(mEvents, &ev, 0) == pdTRUE)
+  {
+    if (ev.type == I2S_EVENT_RX_Q_OVF)
+    {
+      ++mOverruns;
+      mMeter.restart(mHwFs); // lost samples would read as a slow clock
+    }
+  }
+}
+
+size_t I2sAdcSource::readPair(int16_t *dst, int16_t *dstB, size_t n, uint32_t timeoutMs)
+{
+  if (!mRunning)
+    return 0;
+  pollEvents();
+
+  size_t out = 0;
+  if (mHasHold && n > 0)
+  {
+    dst[out] = mHold[0];
+    if (dstB)
+      dstB[out] = mHold[1];
+    ++out;
+    mHasHold = false;
+  }
+
+  const TickType_t deadline = xTaskGetTickCount() + pdMS_TO_TICKS(timeoutMs);
+  const uint32_t ch = channels();
+  while (out < n)
+  {
+    // Hardware samples for the rest of the request if every DDS group came
+    // out as short as it can, so the request is never overshot, rounded up
+    // to a whole 32-bit word because the DMA stores samples swapped in
+    // pairs (that one may finish a group: it waits in mHold).
+    const size_t groupMin = (size_t)max(mDdsMod / mDdsStep, (uint64_t)1);
+    size_t want = (n - out) * groupMin * ch;
+    want = (want + 1) & ~(size_t)1;
+    if (want > sizeof(mRaw) / sizeof(mRaw[0]))
+      want = sizeof(mRaw) / sizeof(mRaw[0]);
+
+    TickType_t now = xTaskGetTickCount();
+    TickType_t wait = (int32_t)(deadline - now) > 0 ? deadline - now : 0;
+    size_t gotBytes = 0;
+    i2s_read(I2S_NUM_0, mRaw, want * sizeof(uint16_t), &gotBytes, wait);
+    size_t got = gotBytes / sizeof(uint16_t);
+    if (got == 0)
+      break;
+    track(got);
+
+    for (size_t i = 0; i < got; ++i)
+    {
+      const uint16_t word = mRaw[i ^ 1];
+      // Channel B closes a pair; a lone word of either still lands in its own sum
+      const int c = mDual && (word >> 12) == (uint16_t)mChannelB;
+      mAccSum[c] += word & 0x0FFF;
+      ++mAccCount[c];
+      if (mDual && !c)
+        continue;
+      mDdsPhase += mDdsStep;
+      if (mDdsPhase < mDdsMod)
+        continue;
+      mDdsPhase -= mDdsMod;
+
+      int16_t v[2] = {};
+      for (uint32_t k = 0; k < ch; ++k)
+      {
+        if (mAccCount[k])
+          v[k] = (int16_t)(mAccCount[k] == 1 ? mAccSum[k] : mAccSum[k] / mAccCount[k]);
+        mAccSum[k] = 0;
+        mAccCount[k] = 0;
+      }
+      if (out < n)
+      {
+        dst[out] = v[0];
+        if (dstB)
+          dstB[out] = v[1];
+        ++out;
+      }
+      else
+      {
+        mHold[0] = v[0];
+        mHold[1] = v[1];
+        mHasHold = true;
+      }
+    }
+  }
+  return out;
+}
+
+void I2sAdcSource::flush()
+{
+  mAccSum[0] = mAccSum[1] = 0;
+  mAccCount[0] = mAccCount[1] = 0;
+  mDdsPhase = 0;
+  mHasHold = false;
+  if (!mRunning)
+    return;
+  size_t gotBytes;
+  do
+  {
+    gotBytes = 0;
+    i2s_read(I2S_NUM_0, mRaw, sizeof(mRaw), &gotBytes, 0);
+    if (gotBytes)
+      track(gotBytes / sizeof(uint16_t)); // dropped, but the clock still ran
+  } while (gotBytes > 0);
+  pollEvents();
+}
+#endif // ARDUINO_ARCH_ESP32
+
+// -------------------- Synthetic generator --------------------
+bool SyntheticSource::begin(uint32_t fs)
+{
+  setSampleRate(fs);
+  return true;
+}
+
+uint32_t SyntheticSource::setSampleRate(uint32_t fs)
+{
+  if (fs < 1)
+    fs = 1;
+  if (fs > FS_MAX)
+    fs = FS_MAX;
+  mFs = fs;
+  setFrequency(mFreqHz);
+  flush();
+  return mFs;
+}
+
+void SyntheticSource::setFrequency(float hz)
+{
+  mFreqHz = hz;
+  if (mFs)
+    mPhaseInc = (uint32_t)((double)hz / (double)mFs * 4294967296.0);
+}
+
+void SyntheticSource::setAmplitude(int amplitude, int offset)
+{
+  mAmplitude = amplitude;
+  mOffset = offset;
+}
+
+void SyntheticSource::flush()
+{
+  mLastUs = micros();
+  mCarry = 0;
+}
+
+bool SyntheticSource::setChannelB(bool on)
+{
+  mDual = on;
+  mPhaseB = mPhase + 0x40000000u;
+  return true;
+}
+
+int16_t SyntheticSource::waveAt(uint32_t ph, int amplitude) const
+{
+  switch (mWave)
+  {
+  case WAVE_SQUARE:
+    return (int16_t)((ph & 0x80000000u) ? -amplitude : amplitude);
+  case WAVE_TRIANGLE:
+  {
+    int32_t tri = (int32_t)((ph & 0x80000000u) ? ~ph : ph) - 0x40000000; // -2^30..2^30
+    return (int16_t)(((int64_t)tri * amplitude) >> 30);
+  }
+  case WAVE_SAW:
+    return (int16_t)(((int64_t)(int32_t)ph * amplitude) >> 31);
+  case WAVE_NOISE:
+    return (int16_t)((int)(mNoiseState % (uint32_t)(2 * amplitude + 1)) - amplitude);
+  case WAVE_SINE:
+  default:
+    return (int16_t)lroundf(sinf((float)ph * (6.28318531f / 4294967296.0f)) * (float)amplitude);
+  }
+}
+
+// Channel A's sample; channel B's goes to *b when there is one
+int16_t SyntheticSource::next(int16_t *b)
+{
+  // xorshift32: cheap, repeatable noise
+  mNoiseState ^= mNoiseState << 13;
+  mNoiseState ^= mNoiseState >> 17;
+  mNoiseState ^= mNoiseState << 5;
+  int noise = mNoise ? (int)(mNoiseState % (uint32_t)(2 * mNoise + 1)) - mNoise : 0;
+
+  if (mDual)
+  {
+    const int vb = waveAt(mPhaseB, mAmplitude * 3 / 4) + mOffset - noise;
+    mPhaseB += mPhaseInc + mPhaseInc / 2;
+    if (b)
+      *b = (int16_t)constrain(vb, 0, 4095);
+  }
+  int v = waveAt(mPhase, mAmplitude);
+  mPhase += mPhaseInc;
+
+  v += mOffset + noise;
+  if (v < 0)
+    v = 0;
+  if (v > 4095)
+    v = 4095;
+  return (int16_t)v;
+}
+
+size_t SyntheticSource::readPair(int16_t *dst, int16_t *dstB, size_t n, uint32_t timeoutMs)
+{
+  if (!mRealtime)
+  {
+    for (size_t i = 0; i < n; ++i)
+      dst[i] = next(dstB ? dstB + i : nullptr);
+    return n;
+  }
+
+  // Hand out only as many samples as the sample clock has produced so far.
+  size_t out = 0;
+  const uint32_t start = millis();
+  while (out < n)
+  {
+    uint32_t now = micros();
+    mCarry += (uint64_t)(now - mLastUs) * mFs;
+    mLastUs = now;
+    if (mCarry > (uint64_t)BACKLOG_MAX * 1000000ULL)
+    {
+      // Skip the phase ahead over the samples a real ring would have dropped.
+      uint64_t lost = mCarry / 1000000ULL - BACKLOG_MAX;
+      mPhase += (uint32_t)(lost * mPhaseInc);
+      mPhaseB += (uint32_t)(lost * (mPhaseInc + mPhaseInc / 2));
+      mCarry -= lost * 1000000ULL;
+      ++mOverruns;
+    }
+    uint64_t due = mCarry / 1000000ULL;
+    if (due > n - out)
+      due = n - out;
+    mCarry -= due * 1000000ULL;
+    for (uint64_t i = 0; i < due; ++i, ++out)
+      dst[out] = next(dstB ? dstB + out : nullptr);
+
+    if (out < n)
+    {
+      if ((uint32_t)(millis() - start) >= timeoutMs)
+        break;
+      delay(1);
+    }
+  }
+  return out;
+}
+
+// -------------------- Scripted generator --------------------
+void ScriptedSource::setScript(const Step *steps, size_t count)
+{
+  mSteps = steps;
+  mCount = count;
+  rewind();
+}
+
+void ScriptedSource::rewind()
+{
+  if (mCount)
+    enter(0);
+}
+
+void ScriptedSource::enter(size_t i)
+{
+  const Step &s = mSteps[i];
+  mStep = i;
+  setWave(s.wave);
+  setFrequency(s.freqHz);
+  setAmplitude(s.amplitude, s.offset);
+  setNoise(s.noise);
+  const uint64_t samples = (uint64_t)s.ms * sampleRate() / 1000;
+  mLeft = samples ? (uint32_t)samples : 1;
+}
+
+uint32_t ScriptedSource::setSampleRate(uint32_t fs)
+{
+  const uint32_t actual = SyntheticSource::setSampleRate(fs);
+  if (mCount)
+    enter(mStep); // restart the current step at the new rate
+  return actual;
+}
+
+size_t ScriptedSource::readPair(int16_t *dst, int16_t *dstB, size_t n, uint32_t timeoutMs)
+{
+  if (!mCount)
+    return SyntheticSource::readPair(dst, dstB, n, timeoutMs);
+
+  size_t out = 0;
+  while (out < n)
+  {
+    const size_t want = min((size_t)mLeft, n - out);
+    const size_t got = SyntheticSource::readPair(dst + out, dstB ? dstB + out : nullptr, want, timeoutMs);
+    out += got;
+    mLeft -= (uint32_t)got;
+    if (mLeft == 0)
+      enter((mStep + 1) % mCount);
+    if (got < want)
+      break; // realtime and timed out
+  }
+  return out;
+}
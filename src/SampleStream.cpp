@@ -0,0 +1,161 @@
+// ==================== SampleStream.cpp (binary sample streaming) ====================
+#include "SampleStream.h"
+
+uint16_t crc16Ccitt(uint16_t crc, uint8_t b)
+{
+  crc ^= (uint16_t)b << 8;
+  for (int i = 0; i < 8; ++i)
+    crc = (crc & 0x8000) ? (uint16_t)((crc << 1) ^ 0x1021) : (uint16_t)(crc << 1);
+  return crc;
+}
+
+// -------------------- encoder --------------------
+namespace
+{
+// Single-pass COBS: each run's code byte is back-patched once the run ends.
+struct CobsWriter
+{
+  uint8_t *out;
+  size_t pos = 1;  // next data byte
+  size_t code = 0; // index of the current run's code byte
+  uint16_t crc = 0xFFFF;
+
+  explicit CobsWriter(uint8_t *o) : out(o) {}
+
+  void put(uint8_t b)
+  {
+    if (b == 0)
+    {
+      out[code] = (uint8_t)(pos - code);
+      code = pos++;
+    }
+    else
+    {
+      out[pos++] = b;
+      if (pos - code == 0xFF)
+      {
+        out[code] = 0xFF;
+        code = pos++;
+      }
+    }
+  }
+
+  void data(uint8_t b)
+  {
+    crc = crc16Ccitt(crc, b);
+    put(b);
+  }
+
+  void data32(uint32_t v)
+  {
+    for (int i = 0; i < 4; ++i)
+      data((uint8_t)(v >> (8 * i)));
+  }
+
+  size_t finish()
+  {
+    const uint16_t c = crc;
+    put((uint8_t)c);
+    put((uint8_t)(c >> 8));
+    out[code] = (uint8_t)(pos - code);
+    out[pos++] = 0x00;
+    return pos;
+  }
+};
+} // namespace
+
+size_t SampleStreamEncoder::encode(const int16_t *samples, uint16_t n, uint32_t fs, uint8_t *out)
+{
+  if (n > STREAM_MAX_SAMPLES)
+    n = STREAM_MAX_SAMPLES;
+  CobsWriter w(out);
+  w.data(STREAM_TYPE_SAMPLES);
+  w.data(mFlags);
+  w.data32(mSeq++);
+  w.data32(fs);
+  w.data((uint8_t)n);
+  w.data((uint8_t)(n >> 8));
+  for (uint16_t i = 0; i < n; i += 2)
+  {
+    const uint16_t a = (uint16_t)samples[i] & 0x0FFF;
+    const uint16_t b = (i + 1 < n) ? ((uint16_t)samples[i + 1] & 0x0FFF) : 0;
+    w.data((uint8_t)a);
+    w.data((uint8_t)((a >> 8) | (b << 4)));
+    w.data((uint8_t)(b >> 4));
+  }
+  mFlags = 0;
+  return w.finish();
+}
+
+// -------------------- decoder --------------------
+bool SampleStreamDecoder::push(uint8_t b)
+{
+  if (b != 0)
+  {
+    if (mLen < sizeof(mBuf))
+      mBuf[mLen++] = b;
+    else
+      mOverflow = true;
+    return false;
+  }
+  const bool ok = mLen && !mOverflow && finishFrame();
+  if (!ok && (mLen || mOverflow))
+    mCounters.corrupt++;
+  mLen = 0;
+  mOverflow = false;
+  return ok;
+}
+
+bool SampleStreamDecoder::finishFrame()
+{
+  // COBS decode in place: output never runs ahead of input
+  size_t in = 0, out = 0;
+  while (in < mLen)
+  {
+    const uint8_t code = mBuf[in++];
+    if (in + code - 1 > mLen)
+      return false;
+    for (int i = 1; i < code; ++i)
+      mBuf[out++] = mBuf[in++];
+    if (code < 0xFF && in < mLen)
+      mBuf[out++] = 0;
+  }
+
+  if (out < STREAM_HEADER_BYTES + 2 || mBuf[0] != STREAM_TYPE_SAMPLES)
+    return false;
+  uint16_t crc = 0xFFFF;
+  for (size_t i = 0; i < out - 2; ++i)
+    crc = crc16Ccitt(crc, mBuf[i]);
+  if (crc != (uint16_t)(mBuf[out - 2] | (mBuf[out - 1] << 8)))
+    return false;
+
+  auto rd32 = [this](size_t i)
+  {
+    return (uint32_t)mBuf[i] | ((uint32_t)mBuf[i + 1] << 8) | ((uint32_t)mBuf[i + 2] << 16) | ((uint32_t)mBuf[i + 3] << 24);
+  };
+  StreamPacket &p = mPacket;
+  p.flags = mBuf[1];
+  p.seq = rd32(2);
+  p.fs = rd32(6);
+  p.count = (uint16_t)(mBuf[10] | (mBuf[11] << 8));
+  if (p.count > STREAM_MAX_SAMPLES || out != STREAM_HEADER_BYTES + (p.count + 1u) / 2 * 3 + 2)
+    return false;
+
+  const uint8_t *s = mBuf + STREAM_HEADER_BYTES;
+  for (uint16_t i = 0; i < p.count; i += 2, s += 3)
+  {
+    p.samples[i] = (int16_t)(s[0] | ((s[1] & 0x0F) << 8));
+    if (i + 1 < p.count)
+      p.samples[i + 1] = (int16_t)((s[1] >> 4) | (s[2] << 4));
+  }
+
+  const uint32_t gap = p.seq - mNextSeq;
+  if (mHaveSeq && gap < 0x80000000u) // a jump backwards is a device restart, not a loss
+    mCounters.lost += gap;
+  mHaveSeq = true;
+  mNextSeq = p.seq + 1;
+  mCounters.packets++;
+  if (p.flags & STREAM_FLAG_DISCONTINUITY)
+    mCounters.discontinuities++;
+  return true;
+}
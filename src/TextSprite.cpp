@@ -0,0 +1,168 @@
+// ==================== TextSprite.cpp (pre-rasterised text for the HUD and axes) ====================
+#include <Arduino.h>
+#include "TextSprite.h"
+
+// -------------------- TextCanvas --------------------
+void TextCanvas::fill(uint16_t c)
+{
+  for (int i = 0; i < mW * mH; ++i)
+    mPix[i] = c;
+}
+
+void TextCanvas::hLine(int x, int y, int w, uint16_t c)
+{
+  if (y < 0 || y >= mH)
+    return;
+  const int x0 = max(x, 0), x1 = min(x + w, mW);
+  for (int xx = x0; xx < x1; ++xx)
+    mPix[y * mW + xx] = c;
+}
+
+void TextCanvas::vLine(int x, int y, int h, uint16_t c)
+{
+  if (x < 0 || x >= mW)
+    return;
+  const int y0 = max(y, 0), y1 = min(y + h, mH);
+  for (int yy = y0; yy < y1; ++yy)
+    mPix[yy * mW + x] = c;
+}
+
+int TextCanvas::print(const GFXfont &font, const char *text, int x, int baseline, uint16_t fg)
+{
+  const int startX = x;
+  for (const char *p = text; *p; ++p)
+  {
+    const uint8_t c = (uint8_t)*p;
+    if (c < font.first || c > font.last)
+      continue;
+    const GFXglyph &g = font.glyph[c - font.first];
+    const uint8_t *bits = font.bitmap + g.bitmapOffset;
+
+    // Glyph bitmaps are packed MSB first, row after row, with no row padding
+    uint8_t byte = 0;
+    int bit = 0;
+    for (int gy = 0; gy < g.height; ++gy)
+    {
+      const int y = baseline + g.yOffset + gy;
+      for (int gx = 0; gx < g.width; ++gx, ++bit)
+      {
+        if ((bit & 7) == 0)
+          byte = bits[bit >> 3];
+        if ((byte & 0x80) && y >= 0 && y < mH)
+        {
+          const int px = x + g.xOffset + gx;
+          if (px >= 0 && px < mW)
+            mPix[y * mW + px] = fg;
+        }
+        byte <<= 1;
+      }
+    }
+    x += g.xAdvance;
+  }
+  return x - startX;
+}
+
+int TextCanvas::draw(const Sprite &s, int x, int baseline)
+{
+  const int ox = x + s.box.x1, oy = baseline + s.box.y1;
+  for (int r = 0; r < s.box.h; ++r)
+  {
+    const int y = oy + r;
+    if (y < 0 || y >= mH)
+      continue;
+    for (int c = 0; c < s.box.w; ++c)
+    {
+      const int xx = ox + c;
+      if (xx >= 0 && xx < mW)
+        mPix[y * mW + xx] = s.pixels[r * s.box.w + c];
+    }
+  }
+  return s.box.advance;
+}
+
+void TextCanvas::blit(ScopePanel &tft, int x, int y) const
+{
+  tft.startWrite();
+  tft.setAddrWindow(x, y, mW, mH);
+  tft.writePixels(mPix, (uint32_t)(mW * mH));
+  tft.endWrite();
+}
+
+// -------------------- CellField --------------------
+void CellField::place(int x, int baseline, int cells, int cellW, int y1, int h)
+{
+  mX = (int16_t)x;
+  mBaseline = (int16_t)baseline;
+  mCells = (int16_t)min(cells, MAX_CELLS);
+  mCellW = (int16_t)cellW;
+  mY1 = (int16_t)y1;
+  mH = (int16_t)h;
+  invalidate();
+}
+
+void CellField::invalidate()
+{
+  for (int i = 0; i < MAX_CELLS; ++i)
+    mShown[i] = 0; // never a printable character
+}
+
+void CellField::update(ScopePanel &tft, const GFXfont &font, const char *text, uint16_t fg, uint16_t bg,
+                       uint16_t *scratch)
+{
+  char want[MAX_CELLS];
+  for (int i = 0; i < mCells; ++i)
+    want[i] = *text ? *text++ : ' ';
+
+  for (int c = 0; c < mCells;)
+  {
+    if (want[c] == mShown[c])
+    {
+      ++c;
+      continue;
+    }
+    int end = c + 1;
+    while (end < mCells && want[end] != mShown[end])
+      ++end;
+
+    // Each glyph centred in its cell
+    TextCanvas run(scratch, (end - c) * mCellW, mH);
+    run.fill(bg);
+    for (int i = c; i < end; ++i)
+    {
+      const char ch[2] = {want[i], 0};
+      const int adv = textBounds(font, ch).advance;
+      run.print(font, ch, (i - c) * mCellW + (mCellW - adv) / 2, -mY1, fg);
+      mShown[i] = want[i];
+    }
+    run.blit(tft, mX + c * mCellW, mBaseline + mY1);
+    c = end;
+  }
+}
+
+// -------------------- SpritePool --------------------
+bool SpritePool::render(Sprite &out, const GFXfont &font, const char *text, uint16_t fg, uint16_t bg)
+{
+  const TextBox box = textBounds(font, text);
+  const size_t need = (size_t)box.w * (size_t)box.h;
+  if (mUsed + need > mCap)
+    return false;
+
+  uint16_t *pix = mPix + mUsed;
+  TextCanvas canvas(pix, box.w, box.h);
+  canvas.fill(bg);
+  canvas.print(font, text, -box.x1, -box.y1, fg);
+  mUsed += need;
+  out.pixels = pix;
+  out.box = box;
+  return true;
+}
+
+void SpritePool::blit(ScopePanel &tft, const Sprite &s, int x, int baseline)
+{
+  if (!s.pixels || s.box.w == 0)
+    return;
+  tft.startWrite();
+  tft.setAddrWindow(x + s.box.x1, baseline + s.box.y1, s.box.w, s.box.h);
+  tft.writePixels((uint16_t *)s.pixels, (uint32_t)(s.box.w * s.box.h));
+  tft.endWrite();
+}
@@ -0,0 +1,274 @@
+// ==================== TraceRenderer.cpp (column-span trace drawing) ====================
+#include <Arduino.h>
+#include "TraceRenderer.h"
+
+void samplesToSpans(const int16_t *ys, int count, int pxPerSample, int16_t *top, int16_t *bot)
+{
+  constexpr int yMin = PLOT_Y0;
+  constexpr int yMax = PLOT_Y0 + PLOT_H - 1;
+
+  int xcol = 0;
+  int prevY = count > 0 ? ys[0] : 0;
+  for (int i = 1; i < count && xcol < PLOT_W; ++i)
+  {
+    const int y0 = ys[i - 1];
+    const int y1 = ys[i];
+    for (int k = 0; k < pxPerSample && xcol < PLOT_W; ++k, ++xcol)
+    {
+      int y = y0 + (((y1 - y0) * k + pxPerSample / 2) / pxPerSample);
+
+      // Cover the rows between the previous column and this one, excluding
+      // the previous column's own row (it is already lit there).
+      int t = y, b = y;
+      if (y > prevY + 1)
+        t = prevY + 1;
+      else if (y < prevY - 1)
+        b = prevY - 1;
+      prevY = y;
+
+      if (t < yMin)
+        t = yMin;
+      if (b > yMax)
+        b = yMax;
+      top[xcol] = (int16_t)t;
+      bot[xcol] = (int16_t)b; // t > b (empty) when entirely off-plot
+    }
+  }
+  for (; xcol < PLOT_W; ++xcol)
+  {
+    top[xcol] = 1;
+    bot[xcol] = 0;
+  }
+}
+
+void envelopeToSpans(const int16_t *ys, int columns, int16_t *top, int16_t *bot)
+{
+  constexpr int yMin = PLOT_Y0;
+  constexpr int yMax = PLOT_Y0 + PLOT_H - 1;
+
+  int x = 0;
+  for (; x < columns && x < PLOT_W; ++x)
+  {
+    int t = min(ys[2 * x], ys[2 * x + 1]);
+    int b = max(ys[2 * x], ys[2 * x + 1]);
+    if (x > 0)
+    {
+      const int prevY = ys[2 * x - 1];
+      if (prevY < t - 1)
+        t = prevY + 1;
+      else if (prevY > b + 1)
+        b = prevY - 1;
+    }
+    if (t < yMin)
+      t = yMin;
+    if (b > yMax)
+      b = yMax;
+    top[x] = (int16_t)t;
+    bot[x] = (int16_t)b;
+  }
+  for (; x < PLOT_W; ++x)
+  {
+    top[x] = 1;
+    bot[x] = 0;
+  }
+}
+
+namespace
+{
+struct Run
+{
+  int y0, y1;
+};
+
+// Rows whose colour flips between an old and a new span: their symmetric
+// difference, top to bottom
+int spanChanges(int oT, int oB, int nT, int nB, Run *out)
+{
+  const bool oldEmpty = oT > oB;
+  const bool newEmpty = nT > nB;
+  if ((oldEmpty && newEmpty) || (oT == nT && oB == nB))
+    return 0;
+  if (oldEmpty)
+  {
+    out[0] = Run{nT, nB};
+    return 1;
+  }
+  if (newEmpty)
+  {
+    out[0] = Run{oT, oB};
+    return 1;
+  }
+  if (nB < oT || nT > oB)
+  {
+    // Disjoint: erase old, draw new
+    out[0] = nT < oT ? Run{nT, nB} : Run{oT, oB};
+    out[1] = nT < oT ? Run{oT, oB} : Run{nT, nB};
+    return 2;
+  }
+  int n = 0;
+  if (oT != nT)
+    out[n++] = Run{min(oT, nT), max(oT, nT) - 1};
+  if (oB != nB)
+    out[n++] = Run{min(oB, nB) + 1, max(oB, nB)};
+  return n;
+}
+} // namespace
+
+void TraceRenderer::reset()
+{
+  for (int t = 0; t < MAX_TRACES; ++t)
+  {
+    for (int x = 0; x < PLOT_W; ++x)
+    {
+      mTop[t][x] = 1;
+      mBot[t][x] = 0;
+    }
+  }
+  mHavePending = false;
+}
+
+void TraceRenderer::draw(ScopePanel &tft, const TraceSpans *traces, int count, PlotBackground &bg)
+{
+  mStats.clear();
+  mHavePending = false;
+  mTraces = traces;
+  mTraceCount = min(count, MAX_TRACES);
+  mBg = &bg;
+  tft.startWrite();
+  if (bg.changed())
+  {
+    repaintRows(tft);
+    bg.takeChanges();
+  }
+
+  for (int x = 0; x < PLOT_W; ++x)
+  {
+    // Every trace's changes (one missing this frame goes to empty), then
+    // merged top to bottom so overlapping runs are written once
+    Run runs[2 * MAX_TRACES];
+    int n = 0;
+    for (int t = 0; t < MAX_TRACES; ++t)
+    {
+      const int nT = t < mTraceCount ? traces[t].top[x] : 1;
+      const int nB = t < mTraceCount ? traces[t].bot[x] : 0;
+      n += spanChanges(mTop[t][x], mBot[t][x], nT, nB, runs + n);
+    }
+    for (int i = 1; i < n; ++i)
+      for (int j = i; j > 0 && runs[j].y0 < runs[j - 1].y0; --j)
+      {
+        const Run r = runs[j];
+        runs[j] = runs[j - 1];
+        runs[j - 1] = r;
+      }
+    for (int i = 0; i < n;)
+    {
+      Run r = runs[i++];
+      while (i < n && runs[i].y0 <= r.y1 + 1)
+        r.y1 = max(r.y1, runs[i++].y1);
+      addRun(tft, x, r.y0, r.y1);
+    }
+  }
+
+  if (mHavePending)
+    flush(tft, mPending);
+  tft.endWrite();
+
+  for (int t = 0; t < MAX_TRACES; ++t)
+  {
+    for (int x = 0; x < PLOT_W; ++x)
+    {
+      mTop[t][x] = t < mTraceCount ? traces[t].top[x] : 1;
+      mBot[t][x] = t < mTraceCount ? traces[t].bot[x] : 0;
+    }
+  }
+  mTraces = nullptr;
+  mBg = nullptr;
+}
+
+// Rows whose background changed, with the new traces over them; runs of
+// neighbouring rows share one window
+void TraceRenderer::repaintRows(ScopePanel &tft)
+{
+  const int yEnd = PLOT_Y0 + PLOT_H;
+  for (int y = PLOT_Y0; y < yEnd; ++y)
+  {
+    if (!mBg->rowChanged(y))
+      continue;
+    int y1 = y;
+    while (y1 + 1 < yEnd && mBg->rowChanged(y1 + 1))
+      ++y1;
+    const int h = y1 - y + 1;
+    tft.setAddrWindow(PLOT_X0, y, PLOT_W, h);
+    for (; y <= y1; ++y)
+    {
+      for (int x = 0; x < PLOT_W; ++x)
+        mBurst[x] = colorAt(x, y);
+      tft.writePixels(mBurst, PLOT_W);
+    }
+    mStats.windows++;
+    mStats.pixels += (uint32_t)(PLOT_W * h);
+    mStats.bytes += SPI_WINDOW_BYTES + SPI_PIXEL_BYTES * (uint32_t)(PLOT_W * h);
+  }
+}
+
+void TraceRenderer::addRun(ScopePanel &tft, int x, int y0, int y1)
+{
+  const Rect run{(int16_t)x, (int16_t)x, (int16_t)y0, (int16_t)y1};
+  if (!mHavePending)
+  {
+    mPending = run;
+    mHavePending = true;
+    return;
+  }
+
+  // Merge into the pending burst if the bigger window costs no more bytes than
+  // a second window would. Only same or adjacent columns can merge.
+  if (x <= mPending.x1 + 1)
+  {
+    Rect m = mPending;
+    m.x1 = (int16_t)x;
+    m.y0 = (int16_t)min((int)m.y0, y0);
+    m.y1 = (int16_t)max((int)m.y1, y1);
+    auto area = [](const Rect &r) -> uint32_t
+    { return (uint32_t)(r.x1 - r.x0 + 1) * (uint32_t)(r.y1 - r.y0 + 1); };
+
+    const uint32_t merged = area(m);
+    const uint32_t separate = area(mPending) + area(run) + SPI_WINDOW_BYTES / SPI_PIXEL_BYTES;
+    if (merged <= BURST_MAX && merged <= separate)
+    {
+      mPending = m;
+      return;
+    }
+  }
+
+  flush(tft, mPending);
+  mPending = run;
+}
+
+uint16_t TraceRenderer::colorAt(int x, int y) const
+{
+  for (int t = 0; t < mTraceCount; ++t)
+    if (y >= mTraces[t].top[x] && y <= mTraces[t].bot[x])
+      return mTraces[t].color;
+  return mBg->at(x, y);
+}
+
+void TraceRenderer::flush(ScopePanel &tft, const Rect &r)
+{
+  const int w = r.x1 - r.x0 + 1;
+  const int h = r.y1 - r.y0 + 1;
+
+  // Window is written row-major; every pixel gets its new colour (pixels
+  // outside the runs are unchanged, so rewriting them is harmless).
+  uint16_t *p = mBurst;
+  for (int y = r.y0; y <= r.y1; ++y)
+    for (int x = r.x0; x <= r.x1; ++x)
+      *p++ = colorAt(x, y);
+
+  tft.setAddrWindow(PLOT_X0 + r.x0, r.y0, w, h);
+  tft.writePixels(mBurst, (uint32_t)(w * h));
+
+  mStats.windows++;
+  mStats.pixels += (uint32_t)(w * h);
+  mStats.bytes += SPI_WINDOW_BYTES + SPI_PIXEL_BYTES * (uint32_t)(w * h);
+}
@@ -0,0 +1,133 @@
+// ==================== Trigger.cpp (edge trigger with pre-trigger history) ====================
+#include "Trigger.h"
+
+void TriggerEngine::configure(const TriggerSettings &s, uint16_t frameLen, uint32_t fs)
+{
+  mSet = s;
+  if (mSet.preTriggerPct > 100)
+    mSet.preTriggerPct = 100;
+  if (frameLen > HISTORY)
+    frameLen = HISTORY;
+  mFrameLen = frameLen;
+  mPre = (uint16_t)((uint32_t)frameLen * mSet.preTriggerPct / 100);
+  if (mPre >= frameLen && frameLen > 0)
+    mPre = frameLen - 1; // the trigger sample itself is always in the frame
+
+  // Free-run after AUTO_TIMEOUT_MS, but never sooner than two frames' worth
+  mAutoTimeout = (uint32_t)((uint64_t)fs * AUTO_TIMEOUT_MS / 1000);
+  if (mAutoTimeout < 2u * frameLen)
+    mAutoTimeout = 2u * frameLen;
+  arm();
+}
+
+void TriggerEngine::arm()
+{
+  mState = SEEK_ARM;
+  mSearchStart = mWritten;
+  mTriggered = false;
+}
+
+void TriggerEngine::discardHistory()
+{
+  mWritten = 0;
+  if (mState != HOLD) // a single shot stays held until configure() or arm()
+    arm();
+}
+
+bool TriggerEngine::crossed(int16_t v)
+{
+  if (mSet.edge == EDGE_RISING)
+  {
+    if (mState == SEEK_ARM)
+    {
+      if (v <= mSet.level - mSet.hysteresis)
+        mState = SEEK_EDGE;
+      return false;
+    }
+    return v >= mSet.level;
+  }
+  if (mState == SEEK_ARM)
+  {
+    if (v >= mSet.level + mSet.hysteresis)
+      mState = SEEK_EDGE;
+    return false;
+  }
+  return v <= mSet.level;
+}
+
+bool TriggerEngine::feed(const int16_t *s, size_t n, size_t *consumed, const int16_t *sB)
+{
+  size_t i = 0;
+  if (mState == READY || mState == HOLD || mFrameLen == 0)
+  {
+    *consumed = 0;
+    return mState == READY;
+  }
+
+  for (; i < n; ++i)
+  {
+    const int16_t v = s[i];
+    const uint32_t idx = mWritten++;
+    mHist[idx & (HISTORY - 1)] = v;
+    if (sB)
+      mHistB[idx & (HISTORY - 1)] = sB[i];
+
+    if (mState == POST)
+    {
+      if (idx + 1 >= mTrigAt + (mFrameLen - mPre))
+      {
+        mState = READY;
+        ++i;
+        break;
+      }
+      continue;
+    }
+
+    // Can't honour the pre-trigger until that much history exists
+    if (idx < mPre)
+      continue;
+
+    if (crossed(v))
+    {
+      mTriggered = true;
+      mTrigAt = idx;
+    }
+    else if (mSet.mode == TRIG_AUTO && idx - mSearchStart >= mAutoTimeout)
+    {
+      mTriggered = false;
+      mTrigAt = idx;
+    }
+    else
+    {
+      continue;
+    }
+
+    if (mFrameLen - mPre <= 1)
+    {
+      mState = READY;
+      ++i;
+      break;
+    }
+    mState = POST;
+  }
+
+  *consumed = i;
+  return mState == READY;
+}
+
+void TriggerEngine::extract(int16_t *dst, int16_t *dstB)
+{
+  const uint32_t start = mTrigAt - mPre;
+  for (uint16_t k = 0; k < mFrameLen; ++k)
+    dst[k] = mHist[(start + k) & (HISTORY - 1)];
+  for (uint16_t k = 0; dstB && k < mFrameLen; ++k)
+    dstB[k] = mHistB[(start + k) & (HISTORY - 1)];
+
+  mLastTriggered = mTriggered;
+  if (mSet.mode == TRIG_SINGLE && mTriggered)
+  {
+    mState = HOLD;
+    return;
+  }
+  arm();
+}
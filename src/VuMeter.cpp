@@ -0,0 +1,101 @@
+// ==================== VuMeter.cpp (LED bar meter ballistics) ====================
+#include <Arduino.h>
+#include <math.h>
+#include "VuMeter.h"
+
+#if defined(ARDUINO_ARCH_ESP32)
+#include <soc/gpio_reg.h>
+#endif
+
+namespace
+{
+struct Ballistics
+{
+  float attackUs, releaseUs;
+};
+const Ballistics BALLISTICS[VU_MODE_COUNT] = {
+    {500.0f, 650000.0f},    // peak: catches a transient, falls ~20 dB in 1.5 s
+    {300000.0f, 300000.0f}, // RMS: the classic VU integration time
+};
+} // namespace
+
+// -------------------- VuMeter --------------------
+void VuMeter::setMode(VuMode m)
+{
+  mMode = m;
+  mEnv = 0;
+  mHold = 0;
+  mHoldLeftUs = 0;
+}
+
+uint8_t VuMeter::update(float level, uint32_t dtUs)
+{
+  // One-pole follower: the fraction of the gap closed depends only on dt
+  const Ballistics &b = BALLISTICS[mMode];
+  const float tau = level > mEnv ? b.attackUs : b.releaseUs;
+  mEnv += (level - mEnv) * (1.0f - expf(-(float)dtUs / tau));
+
+  uint8_t lit = 0;
+  while (lit < VU_LEDS && mEnv >= VU_THRESHOLDS.level[lit])
+    ++lit;
+
+  if (lit >= mHold)
+  {
+    mHold = lit;
+    mHoldLeftUs = HOLD_US;
+  }
+  else if (mHoldLeftUs > dtUs)
+    mHoldLeftUs -= dtUs;
+  else
+  {
+    mHold = lit;
+    mHoldLeftUs = HOLD_US;
+  }
+
+  uint8_t bits = (uint8_t)((1u << lit) - 1);
+  if (mHold)
+    bits |= (uint8_t)(1u << (mHold - 1));
+  return bits;
+}
+
+// -------------------- LedBar --------------------
+void LedBar::begin(const uint8_t *pins, int n)
+{
+  mCount = min(n, MAX_PINS);
+  for (int i = 0; i < mCount; ++i)
+  {
+    mPins[i] = pins[i];
+    pinMode(pins[i], OUTPUT);
+#if defined(ARDUINO_ARCH_ESP32)
+    mHighBank[i] = pins[i] >= 32;
+    mMask[i] = 1u << (pins[i] & 31);
+#endif
+  }
+  mShown = -1;
+}
+
+void LedBar::write(uint8_t bits)
+{
+  if (bits == mShown)
+    return;
+#if defined(ARDUINO_ARCH_ESP32)
+  uint32_t set[2] = {0, 0}, clr[2] = {0, 0};
+  for (int i = 0; i < mCount; ++i)
+    (bits & (1u << i) ? set : clr)[mHighBank[i]] |= mMask[i];
+  if (set[0] | clr[0])
+  {
+    REG_WRITE(GPIO_OUT_W1TS_REG, set[0]);
+    REG_WRITE(GPIO_OUT_W1TC_REG, clr[0]);
+  }
+  if (set[1] | clr[1])
+  {
+    REG_WRITE(GPIO_OUT1_W1TS_REG, set[1]);
+    REG_WRITE(GPIO_OUT1_W1TC_REG, clr[1]);
+  }
+#else
+  for (int i = 0; i < mCount; ++i)
+    if (mShown < 0 || ((bits ^ mShown) & (1u << i)))
+      digitalWrite(mPins[i], (bits & (1u << i)) ? HIGH : LOW);
+#endif
+  mShown = bits;
+}
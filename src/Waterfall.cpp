@@ -0,0 +1,91 @@
+// ==================== Waterfall.cpp (scrolling spectrogram) ====================
+#include <Arduino.h>
+#include "Waterfall.h"
+#include "Fft.h"
+
+// -------------------- colour map --------------------
+namespace
+{
+constexpr int MAP_SIZE = 256;
+
+// Dark blue -> purple -> red -> orange -> pale yellow, evenly spaced
+constexpr uint8_t MAP_KEYS[][3] = {
+    {0, 0, 0}, {30, 10, 110}, {170, 30, 120}, {245, 110, 30}, {255, 250, 170}};
+constexpr int MAP_KEY_COUNT = sizeof(MAP_KEYS) / sizeof(MAP_KEYS[0]);
+
+struct ColorMap
+{
+  uint16_t rgb565[MAP_SIZE];
+};
+
+constexpr ColorMap makeColorMap()
+{
+  ColorMap m{};
+  for (int i = 0; i < MAP_SIZE; ++i)
+  {
+    const int span = (MAP_SIZE - 1) * 16 / (MAP_KEY_COUNT - 1); // x16 fixed point
+    const int pos = i * 16;
+    int k = pos / span;
+    if (k > MAP_KEY_COUNT - 2)
+      k = MAP_KEY_COUNT - 2;
+    const int t = pos - k * span; // 0..span
+    uint8_t c[3] = {};
+    for (int ch = 0; ch < 3; ++ch)
+      c[ch] = (uint8_t)(MAP_KEYS[k][ch] + (MAP_KEYS[k + 1][ch] - MAP_KEYS[k][ch]) * t / span);
+    m.rgb565[i] = (uint16_t)(((c[0] & 0xF8) << 8) | ((c[1] & 0xFC) << 3) | (c[2] >> 3));
+  }
+  return m;
+}
+
+constexpr ColorMap COLOR_MAP = makeColorMap();
+
+// VSCRSADD: command + 2 data bytes
+constexpr uint32_t SPI_SCROLL_BYTES = 3;
+} // namespace
+
+uint16_t Waterfall::colorFor(int db, int16_t dbRange)
+{
+  if (db > 0)
+    db = 0;
+  if (db < -dbRange)
+    db = -dbRange;
+  return COLOR_MAP.rgb565[(db + dbRange) * (MAP_SIZE - 1) / dbRange];
+}
+
+// -------------------- Waterfall --------------------
+void Waterfall::start(ScopePanel &tft, uint16_t colBg)
+{
+  // Landscape x is the panel's scroll axis: PLOT_X0 fixed lines, the rest scroll
+  ScopeDisplay::setScrollMargins(tft, PLOT_X0, SCREEN_W - PLOT_X0 - PLOT_W);
+  mOffset = 0;
+  ScopeDisplay::scrollTo(tft, PLOT_X0);
+  tft.fillRect(PLOT_X0, 0, PLOT_W, SCREEN_H, colBg);
+  mActive = true;
+}
+
+void Waterfall::stop(ScopePanel &tft)
+{
+  ScopeDisplay::setScrollMargins(tft, 0, 0);
+  ScopeDisplay::scrollTo(tft, 0);
+  mActive = false;
+}
+
+void Waterfall::pushLine(ScopePanel &tft, const int16_t *db, int bins, int16_t dbRange)
+{
+  mStats.clear();
+  // Highest frequency at the top row
+  for (int r = 0; r < PLOT_H; ++r)
+    mLine[r] = colorFor(fftPeakAt(db, bins, PLOT_H - 1 - r, PLOT_H), dbRange);
+
+  // Overwrite the oldest line (on screen at the left edge), then scroll it round to the right.
+  tft.startWrite();
+  tft.setAddrWindow(PLOT_X0 + mOffset, PLOT_Y0, 1, PLOT_H);
+  tft.writePixels(mLine, PLOT_H);
+  tft.endWrite();
+  mOffset = (uint16_t)((mOffset + 1) % PLOT_W);
+  ScopeDisplay::scrollTo(tft, PLOT_X0 + mOffset);
+
+  mStats.windows = 1;
+  mStats.pixels = PLOT_H;
+  mStats.bytes = SPI_WINDOW_BYTES + SPI_PIXEL_BYTES * PLOT_H + SPI_SCROLL_BYTES;
+}
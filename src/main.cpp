@@ -1,8 +1,31 @@
-// ==================== main.cpp (ESP32 + ILI9341, buttons + 6-LED VU + paused grid) ====================
+// ==================== main.cpp (ESP32 + ILI9341, buttons + 6-LED VU + live graticule) ====================
 #include <Arduino.h>
 #include <SPI.h>
 #include <Adafruit_GFX.h>
-#include <Adafruit_ILI9341.h>
+#include "DisplayTraits.h"
+
+#include "ScopeLayout.h"
+#include "SampleSource.h"
+#include "FrameQueue.h"
+#include "PlotBackground.h"
+#include "TraceRenderer.h"
+#include "BandCompositor.h"
+#include "Phosphor.h"
+#include "Trigger.h"
+#include "Decimator.h"
+#include "Fft.h"
+#include "Waterfall.h"
+#include "TextSprite.h"
+#include "CycleCount.h"
+#include "Profiler.h"
+#include "AutoSet.h"
+#include "SampleStream.h"
+#include "SampleRecord.h"
+#include "VuMeter.h"
+#include "FilterChain.h"
+#include "AdcCalibration.h"
+#include "CommandLine.h"
+#include "ButtonEvents.h"
 
 // --- custom fonts ---
 #include "Aurora4pt7b.h" // small font  (aurora_244pt7b)
@@ -24,6 +47,7 @@
 #define BTN_PX_DOWN 15
 #define BTN_PX_UP 2
 #define BTN_PAUSE 0  
+#define BTN_TRIG 4 // click cycles trigger mode, hold re-arms
 
 // VU LEDs (6 levels) — outputs ONLY (34/35 are input-only on ESP32, so don't use them)
 #define VU1 14
@@ -32,118 +56,401 @@
 #define VU4 25
 #define VU5 33
 #define VU6 32
-
-// Screen geometry
-constexpr int SCREEN_W = 320;
-constexpr int SCREEN_H = 240;
-
-// --- Layout ---
-constexpr int PLOT_TOPBANNER = 24;    // title region (text only)
-constexpr int XAXIS_HEIGHT = 12;      // reserved strip under plot for x-axis ticks/labels
-constexpr int PLOT_BOTTOMBANNER = 20; // bottom HUD
-constexpr int PLOT_LMARGIN = 38;      // left margin for Y axis & labels
-
-constexpr int PLOT_X0 = PLOT_LMARGIN;
-constexpr int PLOT_Y0 = PLOT_TOPBANNER;
-constexpr int PLOT_W = SCREEN_W - PLOT_X0;
-constexpr int PLOT_H = SCREEN_H - (PLOT_TOPBANNER + PLOT_BOTTOMBANNER + XAXIS_HEIGHT);
+const uint8_t VU_PINS[VU_LEDS] = {VU1, VU2, VU3, VU4, VU5, VU6};
 
 // ----------- Color palette -----------
 static inline uint16_t RGB565(uint8_t r, uint8_t g, uint8_t b)
 {
   return ((r & 0xF8) << 8) | ((g & 0xFC) << 3) | (b >> 3);
 }
-uint16_t COL_BG = ILI9341_BLACK;
-uint16_t COL_TEXT = ILI9341_WHITE;
+uint16_t COL_BG = RGB565(0, 0, 0);
+uint16_t COL_TEXT = RGB565(255, 255, 255);
 uint16_t COL_TITLE = RGB565(244, 206, 39); // yellow title
-uint16_t COL_AXIS = ILI9341_WHITE;
-uint16_t COL_TICKS = ILI9341_WHITE;
+uint16_t COL_AXIS = RGB565(255, 255, 255);
+uint16_t COL_TICKS = RGB565(255, 255, 255);
 uint16_t COL_GRID = RGB565(30, 30, 30);
-uint16_t COL_TRACE = ILI9341_WHITE;
+uint16_t COL_TRACE = RGB565(255, 255, 255);
+uint16_t COL_TRACE_B = RGB565(0, 220, 120); // channel B, and its DC cursor
+uint16_t COL_CURSOR = RGB565(0, 120, 255);
+uint16_t COL_TRIG = RGB565(255, 140, 0);
 
 // -------------------- GLOBALS --------------------
-Adafruit_ILI9341 tft(TFT_CS, TFT_DC, TFT_MOSI, TFT_SCLK, TFT_RST, TFT_MISO);
-
-// For 4" display
-// Adafruit_ILI9488 tft(TFT_CS, TFT_DC, TFT_MOSI, TFT_SCLK, TFT_RST, TFT_MISO);
+// The panel type and size come from DisplayTraits.h (-DSCOPE_DISPLAY_ILI9488 for the 4" 480x320)
+ScopePanel tft(TFT_CS, TFT_DC, TFT_MOSI, TFT_SCLK, TFT_RST, TFT_MISO);
 
 // Sampling & visualization
 volatile uint32_t gSampleFreqHz = 5000; // default Fs (Hz)
 constexpr uint32_t FS_MIN = 1000;
-constexpr uint32_t FS_MAX = 20000;
+constexpr uint32_t FS_MAX = 500000;
+// The rate the source actually delivers at gMeasuredFsFor, once it has timed
+// itself (capture side; 0 = not yet). Axis labels, FFT bins and measurements
+// use it through axisFs().
+volatile uint32_t gMeasuredFsHz = 0;
+volatile uint32_t gMeasuredFsFor = 0;
+
+uint32_t axisFs()
+{
+  const uint32_t fs = gSampleFreqHz;
+  const uint32_t measured = gMeasuredFsHz;
+  return measured && gMeasuredFsFor == fs ? measured : fs;
+}
 
 volatile uint8_t pxPerSample = 2; // “Px/Sample” (1..10)
 constexpr uint8_t PXS_MIN = 1;
 constexpr uint8_t PXS_MAX = 10;
 
-// Plot state
-int16_t gLastY[PLOT_W];    // last drawn y per column, -1 means “none”
-uint16_t gDCOffsetRaw = 0; // measured raw offset (0..4095)
+// Timebases past 1 px/sample: several samples per column, reduced by the
+// capture side to a min/max envelope or a mean ('d' toggles)
+volatile uint16_t gSamplesPerPx = 1; // 1 = no decimation
+constexpr uint16_t SPP_STEPS[] = {1, 2, 5, 10, 20, 50, 100, 200, 500, 1000};
+constexpr size_t SPP_STEP_COUNT = sizeof(SPP_STEPS) / sizeof(SPP_STEPS[0]);
+volatile DecimMode gDecimMode = DECIM_PEAK;
+
+// Vertical scale ('vgain', auto-set): a software gain of 1 << gVertGain on
+// the corrected codes, with gVertBottom on the plot's bottom row. At x1 from
+// code 0 the plot is 0 V .. ADC_FULL_SCALE_MV. Grid and labels step in volts.
+constexpr int ADC_BITS = 12;
+constexpr int ADC_CODES = ADC_CODE_MAX + 1;
+constexpr uint8_t VERT_GAIN_MAX = 4; // x16
+constexpr int16_t VERT_MAJOR_MV[VERT_GAIN_MAX + 1] = {500, 200, 100, 50, 20};
+constexpr int16_t VERT_MINOR_MV[VERT_GAIN_MAX + 1] = {100, 50, 20, 10, 5};
+uint8_t gVertGain = 0;
+int16_t gVertBottom = 0;
+
+// Display mode ('m' cycles): triggered waveform, FFT magnitude spectrum, or
+// spectrum history as a hardware-scrolled waterfall
+enum ScopeView : uint8_t
+{
+  VIEW_SCOPE,
+  VIEW_SPECTRUM,
+  VIEW_WATERFALL,
+  VIEW_COUNT
+};
+volatile ScopeView gView = VIEW_SCOPE;
+volatile uint16_t gFftSize = 1024;          // FFT_MIN..FFT_MAX, power of two ('n' cycles)
+volatile FftWindow gFftWindow = WIN_HANN;   // 'w' cycles
+volatile uint32_t gFftCycles = 0;           // cycles spent in the last FFT (capture side)
+constexpr int16_t SPEC_DB_RANGE = 1000;     // plot spans 0 .. -100 dB (0.1 dB units)
+constexpr int16_t SPEC_DB_MAJOR = 200;      // 20 dB per grid line
+
+// Acquisition runs in the background (I2S DMA on the ESP32); loop() only collects samples.
+// Build with -DSCOPE_SYNTH_SOURCE to drive the scope from the synthetic generator instead.
+#if defined(ARDUINO_ARCH_ESP32) && !defined(SCOPE_SYNTH_SOURCE)
+I2sAdcSource gAdcSource(ADC1_CHANNEL_0, ADC1_CHANNEL_3); // MIC_PIN, channel B on GPIO39
+constexpr bool SOURCE_IS_ADC = true;
+#elif defined(SCOPE_HOST)
+ScriptedSource gAdcSource; // the host runner loads its script
+constexpr bool SOURCE_IS_ADC = false;
+#else
+SyntheticSource gAdcSource(SyntheticSource::WAVE_SINE, 440.0f);
+constexpr bool SOURCE_IS_ADC = false;
+#endif
+SampleSource &gSource = gAdcSource;
+
+// Capture -> render hand-off. On dual-core ESP32s capture owns core 0 and
+// loop() (render/HUD/serial) keeps core 1; elsewhere loop() does both.
+#if defined(ARDUINO_ARCH_ESP32) && !CONFIG_FREERTOS_UNICORE
+#define SCOPE_DUAL_CORE 1
+constexpr BaseType_t CAPTURE_CORE = 0;
+constexpr UBaseType_t CAPTURE_PRIORITY = 3;
+TaskHandle_t gCaptureTask = nullptr;
+#endif
+// Channels ('ch='): A alone, A and B overlaid, A-B as one trace, or B
+// against A (XY). B is sampled in the same conversion sequence as A, so the
+// two share one Fs of at most FS_MAX / 2. Record, stream, measurements and
+// the spectrum views stay on A.
+enum TraceMode : uint8_t
+{
+  TRACE_A,
+  TRACE_AB,
+  TRACE_A_MINUS_B,
+  TRACE_XY,
+  TRACE_MODE_COUNT
+};
+volatile TraceMode gTraceMode = TRACE_A;
+constexpr size_t XY_POINTS = 2 * PLOT_W; // sample pairs per XY frame
+
+// A scope frame needs PLOT_W + 1 at most, or 2 * PLOT_W as an envelope; an
+// XY frame XY_POINTS of each channel
+using ScopeFrame = SampleFrame<FFT_MAX, XY_POINTS>;
+FrameQueue<ScopeFrame, 4> gFrames;
+
+// Trigger: the UI edits gTrig then bumps gTrigGen; capture copies it when the
+// generation changes (which also re-arms a single shot).
+TriggerSettings gTrig;
+volatile uint32_t gTrigGen = 0;
+
+// Sample filters: the UI edits gFilter then bumps gFilterGen, as for the trigger
+FilterSettings gFilter;
+volatile uint32_t gFilterGen = 0;
+volatile uint32_t gFilterCycles = 0; // per sample, averaged over the last frame (capture side)
+
+// Raw codes are corrected to true volts as they arrive; from there on a code
+// is ADC_FULL_SCALE_MV / ADC_CODE_MAX millivolts everywhere
+AdcCalibration gCal;
+
+// Capture side only
+constexpr size_t CAPTURE_CHUNK = 128;
+constexpr uint32_t CAPTURE_MAX_WAIT_MS = 100; // give settings changes a look-in while waiting for an edge
+struct CaptureState
+{
+  TriggerEngine trigger;
+  int16_t chunk[CAPTURE_CHUNK];
+  size_t chunkLen = 0;
+  size_t chunkPos = 0;
+  uint32_t trigGen = ~0u;
+  uint8_t pxs = 0; // 0 forces the trigger to reconfigure
+  uint16_t spp = 1;
+  DecimMode decimMode = DECIM_PEAK;
+  Decimator decim;
+  int16_t raw[CAPTURE_CHUNK]; // source samples before decimation
+  ScopeView view = VIEW_SCOPE;
+  uint32_t seq = 0;
+  RealFft fft;
+  bool held = false; // a single shot held, so the source went unread
+  MeasureAccumulator meas; // every sample read, one window per frame
+  FilterChain filter;
+  uint32_t filterGen = ~0u;
+  TraceMode traceMode = TRACE_A;
+  // Channel B alongside chunk, raw, decim and filter
+  int16_t chunkB[CAPTURE_CHUNK];
+  int16_t rawB[CAPTURE_CHUNK];
+  Decimator decimB;
+  FilterChain filterB;
+  uint32_t autoSetGen = 0;
+  AutoSetProbe autoSet;
+  uint32_t overruns = 0; // the source's count as of the last read
+};
+CaptureState gCap;
 
-// Pause + paused overlay grid
+// Plot state
+int16_t gLastY[PLOT_W];    // last drawn y per column, -1 means “none” (per-pixel path)
+volatile int16_t gDCOffsetRaw = ADC_MID; // DC of the samples as filtered (the DC cursor)
+volatile int16_t gDCInputRaw = ADC_MID;  // DC of the ADC input, tracked continuously
+int16_t gCursorDC = ADC_MID;             // gDCOffsetRaw as last given to the grid model
+volatile int16_t gDCOffsetRawB = ADC_MID; // the same for channel B, while it is sampled
+int16_t gCursorDCB = ADC_MID;
+constexpr int16_t DC_CURSOR_STEP = 4;    // codes the offset moves before the cursor does
+
+// Trace drawing ('r' cycles): span bursts, full-plot RAM bands with live
+// graticule, the old per-pixel path kept for comparison, or persistence
+// (bands of a decaying hit count per pixel)
+enum RenderMode : uint8_t
+{
+  RENDER_SPANS,
+  RENDER_BANDS,
+  RENDER_PIXELS,
+  RENDER_PHOSPHOR,
+  RENDER_MODE_COUNT
+};
+RenderMode gRenderMode = RENDER_SPANS;
+PlotBackground gPlotBg; // graticule and cursors, shared by every plot renderer
+TraceRenderer gTrace;
+BandCompositor gBands;
+Phosphor gPhosphor;
+Waterfall gWaterfall;
+
+// Frame rate / SPI traffic report ('i' toggles printing once a second)
+bool gShowRenderStats = false;
+uint32_t gStatFrames = 0;
+uint32_t gStatBytes = 0;
+uint32_t gStatPixels = 0;
+uint32_t gStatStartMs = 0;
+
+// Binary sample stream ('stream on'): every source sample, framed as in
+// SampleStream.h. The encoder and frame buffer belong to the capture side.
+constexpr size_t STREAM_TX_BUFFER = 8192; // UART TX ring, so a frame never waits on the FIFO
+volatile bool gStreaming = false;
+SampleStreamEncoder gStreamEnc;
+uint8_t gStreamFrame[STREAM_FRAME_MAX];
+volatile uint32_t gStreamSent = 0;
+volatile uint32_t gStreamDropped = 0;
+
+// VU LEDs: ballistics in VuMeter, one register write per bank in LedBar ('u' peak/RMS)
+VuMeter gVu;
+LedBar gVuLeds;
+
+// Pause; the graticule is part of the plot background, live or paused ('g')
 volatile bool gPaused = false;
-bool gShowPausedGrid = true;
+bool gShowGrid = true;
+
+// Deep memory: every source sample goes into gRecord (SampleRecord.h) as
+// well. Pausing freezes it; the scope view then zooms ('p'/'P', Px buttons)
+// and pans (',' '.', Fs buttons) through it instead of showing live frames.
+constexpr size_t RECORD_MAX_SAMPLES = 1u << 20; // 2 MB, PSRAM only
+constexpr size_t RECORD_KEEP_FREE = 48 * 1024;  // internal heap left for the drivers and tasks
+SampleRecord gRecord;
+size_t gRecordPos = 0;      // first record sample in view while paused
+bool gRecordDirty = false;  // view moved; redraw from the record
+uint32_t gLastFrameEnd = 0; // endSample of the last frame drawn
+
+// Text: labels that never change are rasterised once at boot (TextSprite.h);
+// strips of changing text are composed in gTextPixels and sent in one window.
+enum LabelId : uint8_t
+{
+  LBL_VOLT_0, // 0.0V .. 3.0V in 0.5 V steps
+  LBL_DB_0 = LBL_VOLT_0 + 7, // 0dB .. -100 in 20 dB steps
+  LBL_FS = LBL_DB_0 + 6,
+  LBL_PXS,
+  LBL_SPP,
+  LBL_TRIG,
+  LBL_FFT,
+  LBL_BIN,
+  LBL_PAUSED,
+  LBL_VPP, // measurement panel, in MeasureId order
+  LBL_COUNT = LBL_VPP + 8
+};
+constexpr const char *LABEL_TEXT[LBL_COUNT] = {
+    "0.0V", "0.5V", "1.0V", "1.5V", "2.0V", "2.5V", "3.0V",
+    "0dB", "-20", "-40", "-60", "-80", "-100",
+    "Fs: ", "Px/Sample: ", "Smp/Px: ", "Trig: ", "FFT: ", "Bin: ", "[PAUSED]",
+    "Vpp ", "Vrms ", "Mean ", "Crest ", "Min ", "Max ", "f ", "T "};
+constexpr size_t LABEL_PIXELS = textArea(aurora_244pt7bGlyphs, 0x20, 0x7E, LABEL_TEXT, LBL_COUNT);
+uint16_t gLabelPixels[LABEL_PIXELS];
+SpritePool gLabelPool(gLabelPixels, LABEL_PIXELS);
+Sprite gLabels[LBL_COUNT];
+uint16_t gTextPixels[PLOT_W * PLOT_TOPBANNER];
+
+// Glyph metrics fixed at compile time: x-axis labels hang just below the
+// axis strip, and the HUD strip starts where they end.
+constexpr TextBox DIGITS_BOX = textBounds(aurora_244pt7bGlyphs, 0x20, 0x7E, "0123456789");
+constexpr TextBox HUD_TEXT_BOX = textBounds(aurora_244pt7bGlyphs, 0x20, 0x7E, "Fs: 0123456789.kHz Px/Sample: Trig: [PAUSED]");
+constexpr int XAXIS_LABEL_BASELINE = 10 + DIGITS_BOX.h / 2;
+constexpr int XAXIS_STRIP_H = XAXIS_LABEL_BASELINE + DIGITS_BOX.y1 + DIGITS_BOX.h;
+constexpr int HUD_Y0 = PLOT_Y0 + PLOT_H + XAXIS_STRIP_H;
+constexpr int HUD_BASELINE = SCREEN_H - (PLOT_BOTTOMBANNER - HUD_TEXT_BOX.h) / 2;
+static_assert(HUD_BASELINE + HUD_TEXT_BOX.y1 >= HUD_Y0, "HUD text overlaps the x-axis labels");
+static_assert(PLOT_W * (SCREEN_H - HUD_Y0) <= PLOT_W * PLOT_TOPBANNER, "gTextPixels too small for the HUD");
+
+// Measurement panel ('v' toggles): replaces the title in the scope view.
+// Values sit in fixed-pitch cells (TextSprite.h CellField), so a new frame
+// only resends the characters that changed.
+enum MeasureId : uint8_t
+{
+  MEAS_VPP,
+  MEAS_RMS,
+  MEAS_MEAN,
+  MEAS_CREST,
+  MEAS_MIN,
+  MEAS_MAX,
+  MEAS_FREQ,
+  MEAS_PERIOD,
+  MEAS_COUNT
+};
+constexpr uint8_t MEAS_CELLS[MEAS_COUNT] = {5, 5, 5, 4, 5, 5, 8, 7}; // "3.30V", "1.41", "12.34kHz", "2.27ms"
+constexpr int MEAS_PER_ROW = MEAS_COUNT / 2;
+// Digit pitch; the odd wider letter ('m') just loses its side bearing
+constexpr int MEAS_CELL_W = maxAdvance(aurora_244pt7bGlyphs, 0x20, 0x7E, "0123456789");
+constexpr TextBox MEAS_BOX = textBounds(aurora_244pt7bGlyphs, 0x20, 0x7E, "VpprmsMeanCrestMinaxfT0123456789.-kHzus");
+constexpr int MEAS_ROW_H = PLOT_TOPBANNER / 2;
+static_assert(MEAS_BOX.h <= MEAS_ROW_H, "measurement rows taller than the banner");
+constexpr int measRowWidth(int row)
+{
+  int w = 0;
+  for (int i = row * MEAS_PER_ROW; i < (row + 1) * MEAS_PER_ROW; ++i)
+    w += textBounds(aurora_244pt7bGlyphs, 0x20, 0x7E, LABEL_TEXT[LBL_VPP + i]).advance + MEAS_CELLS[i] * MEAS_CELL_W;
+  return w;
+}
+static_assert(measRowWidth(0) <= PLOT_W && measRowWidth(1) <= PLOT_W, "measurements too wide for the banner");
+bool gShowMeasure = true;
+CellField gMeasFields[MEAS_COUNT];
 
-// Button debounce
-struct Btn
+// Buttons, in ButtonEvents index order
+enum ButtonId : uint8_t
 {
-  uint8_t pin;
-  bool lastStable;     // last debounced state
-  bool lastRaw;        // last read raw
-  uint32_t lastChange; // ms
+  BUTTON_FS_DOWN,
+  BUTTON_FS_UP,
+  BUTTON_PX_DOWN,
+  BUTTON_PX_UP,
+  BUTTON_PAUSE,
+  BUTTON_TRIG,
+  BUTTON_COUNT
 };
-Btn btnFsDown{BTN_FS_DOWN, true, true, 0};
-Btn btnFsUp{BTN_FS_UP, true, true, 0};
-Btn btnPxDown{BTN_PX_DOWN, true, true, 0};
-Btn btnPxUp{BTN_PX_UP, true, true, 0};
-Btn btnPause{BTN_PAUSE, true, true, 0};
-constexpr uint16_t DEBOUNCE_MS = 20;
+const ButtonConfig BUTTONS[BUTTON_COUNT] = {
+    {BTN_FS_DOWN, true, false}, // hold to sweep Fs (or pan the record)
+    {BTN_FS_UP, true, false},
+    {BTN_PX_DOWN, true, false},
+    {BTN_PX_UP, true, false},
+    {BTN_PAUSE, false, true}, // click pauses, hold runs auto-set
+    {BTN_TRIG, false, true}, // click cycles the mode, hold re-arms
+};
+ButtonEvents gButtons;
+constexpr uint32_t FS_STEP = 1000;       // Hz per Fs press or repeat
+constexpr uint32_t FS_STEP_FAST = 10000; // once a hold has repeated FS_FAST_AFTER times
+constexpr uint16_t FS_FAST_AFTER = 10;
 
 // -------------------- HELPERS --------------------
-void measureText(const GFXfont *font, const char *text, int *w, int *h)
+// "0", "500", "1k", "2.5k", "125k"
+void formatHz(char *buf, size_t len, uint32_t hz)
+{
+  if (hz < 1000)
+    snprintf(buf, len, "%lu", (unsigned long)hz);
+  else if (hz % 1000 == 0)
+    snprintf(buf, len, "%luk", (unsigned long)(hz / 1000));
+  else
+    snprintf(buf, len, "%lu.%luk", (unsigned long)(hz / 1000), (unsigned long)(hz % 1000 / 100));
+}
+
+// Record samples the scope view covers at the current timebase
+size_t recordSpan()
+{
+  if (gSamplesPerPx > 1)
+    return (size_t)gSamplesPerPx * (gDecimMode == DECIM_PEAK ? PLOT_W : PLOT_W + 1);
+  return (PLOT_W + pxPerSample - 1) / pxPerSample + 1;
+}
+
+// Paused in the scope view with something recorded at the rate on the axis
+bool browsingRecord()
 {
-  int16_t x1, y1;
-  uint16_t tw, th;
-  tft.setFont(font);
-  tft.getTextBounds(text, 0, 0, &x1, &y1, &tw, &th);
-  *w = (int)tw;
-  *h = (int)th;
+  return gPaused && gView == VIEW_SCOPE && gTraceMode != TRACE_XY && gRecord.length() &&
+         gRecord.sampleRate() == gSampleFreqHz;
 }
 
+// Corrected code -> screen row through the vertical scale; codes off the
+// plot land on its top or bottom row
 static inline int adcToY_raw(int raw)
 {
-  if (raw < 0)
-    raw = 0;
-  if (raw > 4095)
-    raw = 4095;
-  int y = PLOT_Y0 + PLOT_H - 1 - ((uint32_t)raw * PLOT_H >> 12);
-  return y;
+  const int y = PLOT_Y0 + PLOT_H - 1 - ((raw - gVertBottom) * PLOT_H >> (ADC_BITS - gVertGain));
+  return constrain(y, PLOT_Y0, PLOT_Y0 + PLOT_H - 1);
 }
 
-uint16_t estimateDCoffset(int numSamples)
+static inline bool codeInView(int raw)
 {
-  uint32_t sum = 0;
-  for (int i = 0; i < numSamples; ++i)
-  {
-    sum += analogRead(MIC_PIN);
-    delay(2);
-  }
-  return (uint16_t)(sum / (uint32_t)numSamples);
+  return raw >= gVertBottom && raw < gVertBottom + (ADC_CODES >> gVertGain);
+}
+
+// XY: channel A's corrected code -> screen column, 0 V at the left
+static inline int adcToX_xy(int raw)
+{
+  raw = constrain(raw, 0, (int)ADC_CODE_MAX);
+  return PLOT_X0 + (int)((uint32_t)raw * (PLOT_W - 1) / ADC_CODE_MAX);
+}
+
+// Spectrum view: 0.1 dB -> screen row, 0 dB at the top
+static inline int dbToY(int db)
+{
+  if (db > 0)
+    db = 0;
+  if (db < -SPEC_DB_RANGE)
+    db = -SPEC_DB_RANGE;
+  return PLOT_Y0 + (int)((int32_t)-db * (PLOT_H - 1) / SPEC_DB_RANGE);
+}
+
+// Spectrum view: frequency -> screen column, 0..Fs/2 across the plot
+static inline int hzToX(uint32_t hz, uint32_t fs)
+{
+  return PLOT_X0 + (int)((uint64_t)hz * 2 * (PLOT_W - 1) / fs);
 }
 
 // -------------------- VU --------------------
 void initVU()
 {
-  const uint8_t pins[6] = {VU1, VU2, VU3, VU4, VU5, VU6};
-  for (uint8_t i = 0; i < 6; ++i)
-    pinMode(pins[i], OUTPUT);
+  gVuLeds.begin(VU_PINS, VU_LEDS);
 }
 
 void setVU(uint8_t level)
 { // 0..6
-  const uint8_t pins[6] = {VU1, VU2, VU3, VU4, VU5, VU6};
-  for (uint8_t i = 0; i < 6; ++i)
-    digitalWrite(pins[i], (i < level) ? HIGH : LOW);
+  gVuLeds.write((uint8_t)((1u << level) - 1));
 }
 
 void VUdance()
@@ -156,248 +463,575 @@ void VUdance()
   setVU(0);
 }
 
+// -------------------- TEXT --------------------
+// One-off label (changing text): composed off-screen with its background and sent as one window
+void drawText(const GFXfont &font, const char *text, int x, int baseline, uint16_t fg, uint16_t bg)
+{
+  const TextBox b = textBounds(font, text);
+  if (b.w == 0 || (size_t)(b.w * b.h) > sizeof(gTextPixels) / sizeof(gTextPixels[0]))
+    return;
+  TextCanvas c(gTextPixels, b.w, b.h);
+  c.fill(bg);
+  c.print(font, text, -b.x1, -b.y1, fg);
+  c.blit(tft, x + b.x1, baseline + b.y1);
+}
+
+void initLabels()
+{
+  for (int i = 0; i < LBL_COUNT; ++i)
+    gLabelPool.render(gLabels[i], aurora_244pt7b, LABEL_TEXT[i], COL_TEXT, COL_BG);
+}
+
 // -------------------- DRAWING --------------------
 void drawTitle()
 {
-  const char *title = "Audio Signal Visualiser";
-  tft.setFont(&aurora_247pt7b);
-  int16_t x1, y1;
-  uint16_t tw, th;
-  tft.getTextBounds(title, 0, 0, &x1, &y1, &tw, &th);
+  static constexpr char TITLE[] = "Audio Signal Visualiser";
+  constexpr TextBox box = textBounds(aurora_247pt7bGlyphs, 0x20, 0x7E, TITLE);
+  static_assert(box.h <= PLOT_TOPBANNER, "title taller than its banner");
+
+  TextCanvas c(gTextPixels, PLOT_W, PLOT_TOPBANNER);
+  c.fill(COL_BG);
+  c.print(aurora_247pt7b, TITLE, (PLOT_W - box.w) / 2, (PLOT_TOPBANNER - box.h) / 2 + box.h, COL_TITLE);
+  c.blit(tft, PLOT_X0, 0);
+}
+
+bool measurePanelShown()
+{
+  return gShowMeasure && gView == VIEW_SCOPE;
+}
 
-  int x = PLOT_X0 + ((int)PLOT_W - (int)tw) / 2;
-  int baselineY = (PLOT_TOPBANNER - (int)th) / 2 + (int)th;
+// Title, or the measurement labels with every value cell blank and due a redraw
+void drawTopBanner()
+{
+  if (!measurePanelShown())
+  {
+    drawTitle();
+    return;
+  }
+  TextCanvas c(gTextPixels, PLOT_W, PLOT_TOPBANNER);
+  c.fill(COL_BG);
+  for (int row = 0; row < 2; ++row)
+  {
+    const int gap = (PLOT_W - measRowWidth(row)) / MEAS_PER_ROW;
+    const int baseline = row * MEAS_ROW_H + (MEAS_ROW_H - MEAS_BOX.h) / 2 - MEAS_BOX.y1;
+    int x = gap / 2;
+    for (int i = row * MEAS_PER_ROW; i < (row + 1) * MEAS_PER_ROW; ++i)
+    {
+      x += c.draw(gLabels[LBL_VPP + i], x, baseline);
+      gMeasFields[i].place(PLOT_X0 + x, baseline, MEAS_CELLS[i], MEAS_CELL_W, MEAS_BOX.y1, MEAS_BOX.h);
+      x += gMeasFields[i].width() + gap;
+    }
+  }
+  c.blit(tft, PLOT_X0, 0);
+}
 
-  tft.setTextColor(COL_TITLE, COL_BG);
-  tft.setCursor(x, baselineY);
-  tft.print(title);
+// "1.65V" from a code in Q8
+void formatVoltsQ8(char *buf, size_t len, int64_t codeQ8)
+{
+  const long mv = (long)((max(codeQ8, (int64_t)0) * ADC_FULL_SCALE_MV / ADC_CODE_MAX + 128) >> 8);
+  const long cv = (mv + 5) / 10;
+  snprintf(buf, len, "%ld.%02ldV", cv / 100, cv % 100);
 }
 
-void drawBottomBannerHUD()
+// "50.0Hz", "440.0Hz", "12.34kHz", "125.0kHz"
+void formatFreq(char *buf, size_t len, uint64_t centiHz)
+{
+  if (centiHz < 100000)
+    snprintf(buf, len, "%lu.%luHz", (unsigned long)(centiHz / 100), (unsigned long)(centiHz % 100 / 10));
+  else if (centiHz < 10000000)
+    snprintf(buf, len, "%lu.%02lukHz", (unsigned long)(centiHz / 100000), (unsigned long)(centiHz % 100000 / 1000));
+  else
+    snprintf(buf, len, "%lu.%lukHz", (unsigned long)(centiHz / 100000), (unsigned long)(centiHz % 100000 / 10000));
+}
+
+// "8.00us", "227us", "2.27ms", "20.0ms", "500ms", "1.25s"
+void formatPeriod(char *buf, size_t len, uint64_t ns)
+{
+  if (ns < 10000)
+    snprintf(buf, len, "%lu.%02luus", (unsigned long)(ns / 1000), (unsigned long)(ns % 1000 / 10));
+  else if (ns < 1000000)
+    snprintf(buf, len, "%luus", (unsigned long)(ns / 1000));
+  else if (ns < 10000000)
+    snprintf(buf, len, "%lu.%02lums", (unsigned long)(ns / 1000000), (unsigned long)(ns % 1000000 / 10000));
+  else if (ns < 100000000)
+    snprintf(buf, len, "%lu.%lums", (unsigned long)(ns / 1000000), (unsigned long)(ns % 1000000 / 100000));
+  else if (ns < 1000000000)
+    snprintf(buf, len, "%lums", (unsigned long)(ns / 1000000));
+  else
+    snprintf(buf, len, "%lu.%02lus", (unsigned long)(ns / 1000000000), (unsigned long)(ns % 1000000000 / 10000000));
+}
+
+// Formats every value and lets each field resend only the cells that changed
+void showMeasurements(const Measurements &m, uint32_t fs)
+{
+  if (!measurePanelShown())
+    return;
+  char v[MEAS_COUNT][CellField::MAX_CELLS + 1];
+  for (auto &s : v)
+    strcpy(s, "--");
+  if (m.samples)
+  {
+    formatVoltsQ8(v[MEAS_VPP], sizeof(v[0]), (int64_t)(m.max - m.min) << 8);
+    formatVoltsQ8(v[MEAS_RMS], sizeof(v[0]), m.rmsQ8);
+    formatVoltsQ8(v[MEAS_MEAN], sizeof(v[0]), m.meanQ8);
+    formatVoltsQ8(v[MEAS_MIN], sizeof(v[0]), (int64_t)m.min << 8);
+    formatVoltsQ8(v[MEAS_MAX], sizeof(v[0]), (int64_t)m.max << 8);
+    if (m.rmsQ8)
+    {
+      // Crest factor: the larger excursion from the mean over the RMS
+      const int64_t dev = max(((int64_t)m.max << 8) - m.meanQ8, m.meanQ8 - ((int64_t)m.min << 8));
+      const uint16_t cf = (uint16_t)min((dev * 100 + m.rmsQ8 / 2) / m.rmsQ8, (int64_t)9999);
+      snprintf(v[MEAS_CREST], sizeof(v[0]), "%u.%02u", (unsigned)(cf / 100), (unsigned)(cf % 100));
+    }
+    if (m.periodQ8)
+    {
+      formatFreq(v[MEAS_FREQ], sizeof(v[0]), (uint64_t)fs * 25600 / m.periodQ8);
+      formatPeriod(v[MEAS_PERIOD], sizeof(v[0]), (uint64_t)m.periodQ8 * 1000000000ULL / 256 / fs);
+    }
+  }
+  PROFILE_SCOPE(PROF_HUD);
+  for (int i = 0; i < MEAS_COUNT; ++i)
+    gMeasFields[i].update(tft, aurora_244pt7b, v[i], COL_TEXT, COL_BG, gTextPixels);
+}
+
+// Waterfall: everything right of the margin scrolls, so the HUD moves to the margin corners
+void drawWaterfallHUD()
 {
-  // Clear HUD strip
-  tft.fillRect(PLOT_X0, SCREEN_H - PLOT_BOTTOMBANNER, PLOT_W, PLOT_BOTTOMBANNER, COL_BG);
+  const int yBottom = PLOT_Y0 + PLOT_H;
+
+  char lines[4][12];
+  formatHz(lines[0], sizeof(lines[0]) - 2, axisFs());
+  strcat(lines[0], "Hz");
+  snprintf(lines[1], sizeof(lines[1]), "%u pt", (unsigned)gFftSize);
+  snprintf(lines[2], sizeof(lines[2]), "%s", RealFft::windowName(gFftWindow));
+  snprintf(lines[3], sizeof(lines[3]), "%s", gPaused ? "PAUSED" : "");
+
+  TextCanvas top(gTextPixels, PLOT_LMARGIN, PLOT_Y0);
+  top.fill(COL_BG);
+  top.print(aurora_244pt7b, lines[0], 2, 10, COL_TEXT);
+  top.print(aurora_244pt7b, lines[1], 2, 20, COL_TEXT);
+  top.blit(tft, 0, 0);
+
+  TextCanvas bottom(gTextPixels, PLOT_LMARGIN, SCREEN_H - yBottom);
+  bottom.fill(COL_BG);
+  bottom.print(aurora_244pt7b, lines[2], 2, 12, COL_TEXT);
+  bottom.print(aurora_244pt7b, lines[3], 2, 24, COL_TEXT);
+  bottom.blit(tft, 0, yBottom);
+}
 
-  tft.setFont(&aurora_244pt7b);
-  tft.setTextColor(COL_TEXT, COL_BG);
+void formatTime(char *buf, size_t len, uint64_t ns);
 
-  char fsBuf[28];
-  snprintf(fsBuf, sizeof(fsBuf), "Fs: %.1fkHz", gSampleFreqHz / 1000.0f);
-  char pxBuf[28];
-  snprintf(pxBuf, sizeof(pxBuf), "Px/Sample: %u", (unsigned)pxPerSample);
+void drawBottomBannerHUD()
+{
+  if (gView == VIEW_WATERFALL)
+  {
+    drawWaterfallHUD();
+    return;
+  }
 
-  // If paused, append [PAUSED] to the right-most section
-  char statusBuf[32];
-  if (gPaused)
+  // Each field is a cached label sprite followed by its value
+  const uint32_t fs = axisFs();
+  char fsBuf[16];
+  snprintf(fsBuf, sizeof(fsBuf), "%lu.%lukHz", (unsigned long)(fs / 1000), (unsigned long)(fs % 1000 / 100));
+  LabelId pxLabel, trigLabel;
+  char pxBuf[20];
+  char trigBuf[16];
+  if (gView != VIEW_SCOPE)
   {
-    snprintf(statusBuf, sizeof(statusBuf), "[PAUSED]");
+    pxLabel = LBL_FFT;
+    snprintf(pxBuf, sizeof(pxBuf), "%u %s", (unsigned)gFftSize, RealFft::windowName(gFftWindow));
+    trigLabel = LBL_BIN;
+    const uint32_t binTenths = fs * 10UL / gFftSize;
+    snprintf(trigBuf, sizeof(trigBuf), "%lu.%luHz", (unsigned long)(binTenths / 10), (unsigned long)(binTenths % 10));
   }
   else
   {
-    snprintf(statusBuf, sizeof(statusBuf), " "); // empty filler when running
+    if (gSamplesPerPx > 1)
+    {
+      pxLabel = LBL_SPP;
+      snprintf(pxBuf, sizeof(pxBuf), "%u %s", (unsigned)gSamplesPerPx, gDecimMode == DECIM_PEAK ? "Pk" : "Avg");
+    }
+    else
+    {
+      pxLabel = LBL_PXS;
+      snprintf(pxBuf, sizeof(pxBuf), "%u", (unsigned)pxPerSample);
+    }
+    static const char *const trigNames[TRIG_MODE_COUNT] = {"Auto", "Norm", "Single"};
+    trigLabel = LBL_TRIG;
+    snprintf(trigBuf, sizeof(trigBuf), "%s%c", trigNames[gTrig.mode], gTrig.edge == EDGE_RISING ? '/' : '\\');
+  }
+
+  // [PAUSED] is the right-most field, empty while running. Browsing the
+  // record it becomes how far the view's right edge is behind the newest
+  // sample, e.g. [-1.25s].
+  char ageBuf[16] = "";
+  if (browsingRecord())
+  {
+    const size_t end = min(gRecordPos + recordSpan(), gRecord.length());
+    formatTime(ageBuf + 2, sizeof(ageBuf) - 3, (uint64_t)(gRecord.length() - end) * 1000000000ULL / gRecord.sampleRate());
+    ageBuf[0] = '[';
+    ageBuf[1] = '-';
+    strcat(ageBuf, "]");
   }
+  const bool pausedLabel = gPaused && !ageBuf[0];
+  const LabelId labels[4] = {LBL_FS, pxLabel, trigLabel, LBL_PAUSED};
+  const char *values[4] = {fsBuf, pxBuf, trigBuf, ageBuf};
+  int widths[4];
+  int textW = 0;
+  for (int i = 0; i < 4; ++i)
+  {
+    widths[i] = textBounds(aurora_244pt7b, values[i]).advance;
+    if (i < 3 || pausedLabel)
+      widths[i] += gLabels[labels[i]].box.advance;
+    textW += widths[i];
+  }
+  const int gap = constrain((PLOT_W - textW) / 3, 2, 12); // closer up before clipping
+  const int totalW = textW + 3 * gap;
+
+  // Composed off-screen and sent as one window, so nothing is cleared on the panel first
+  TextCanvas hud(gTextPixels, PLOT_W, SCREEN_H - HUD_Y0);
+  hud.fill(COL_BG);
+  int x = (PLOT_W - totalW) / 2;
+  for (int i = 0; i < 4; ++i)
+  {
+    int fx = x;
+    if (i < 3 || pausedLabel)
+      fx += hud.draw(gLabels[labels[i]], fx, HUD_BASELINE - HUD_Y0);
+    hud.print(aurora_244pt7b, values[i], fx, HUD_BASELINE - HUD_Y0, COL_TEXT);
+    x += widths[i] + gap;
+  }
+  hud.blit(tft, PLOT_X0, HUD_Y0);
+}
+
+// Spectrum view: 0 .. -100 dB, labelled every 20 dB
+void drawDbScale()
+{
+  for (int db = 0; db >= -SPEC_DB_RANGE; db -= SPEC_DB_MAJOR / 2)
+  {
+    const int y = dbToY(db);
+    const bool major = (db % SPEC_DB_MAJOR) == 0;
+    const int tickLen = major ? 7 : 4;
+    tft.drawFastHLine(PLOT_LMARGIN - 1 - tickLen, y, tickLen, major ? COL_AXIS : COL_TICKS);
+    if (!major)
+      continue;
+
+    const Sprite &s = gLabels[LBL_DB_0 + (-db / SPEC_DB_MAJOR)];
+    int baselineY = constrain(y + s.box.h / 2, PLOT_Y0 + s.box.h, PLOT_Y0 + PLOT_H - 1);
+    SpritePool::blit(tft, s, (PLOT_LMARGIN - 10) - s.box.w, baselineY);
+  }
+}
 
-  int16_t x1, y1;
-  uint16_t wFs, hFs, wPx, hPx, wStatus, hStatus;
-  tft.getTextBounds(fsBuf, 0, 0, &x1, &y1, &wFs, &hFs);
-  tft.getTextBounds(pxBuf, 0, 0, &x1, &y1, &wPx, &hPx);
-  tft.getTextBounds(statusBuf, 0, 0, &x1, &y1, &wStatus, &hStatus);
+uint32_t computeHzPerMajor(int spanPx);
 
-  const int gap = 16;
-  int totalW = (int)wFs + gap + (int)wPx + gap + (int)wStatus;
-  int startX = PLOT_X0 + (PLOT_W - totalW) / 2;
-  int textH = max(max((int)hFs, (int)hPx), (int)hStatus);
-  int baselineY = SCREEN_H - (PLOT_BOTTOMBANNER - textH) / 2;
+// Waterfall: 0..Fs/2 up the plot, in the fixed margin
+void drawFreqScaleVertical()
+{
+  const uint32_t fs = axisFs();
+  const uint32_t step = computeHzPerMajor(PLOT_H);
+  auto yForHz = [fs](uint32_t hz) -> int
+  {
+    return PLOT_Y0 + PLOT_H - 1 - (int)((uint64_t)hz * 2 * (PLOT_H - 1) / fs);
+  };
 
-  int x = startX;
-  tft.setCursor(x, baselineY);
-  tft.print(fsBuf);
-  x += wFs + gap;
-  tft.setCursor(x, baselineY);
-  tft.print(pxBuf);
-  x += wPx + gap;
-  tft.setCursor(x, baselineY);
-  tft.print(statusBuf);
+  for (uint32_t hz = 0; hz <= fs / 2; hz += step)
+  {
+    const int y = yForHz(hz);
+    tft.drawFastHLine(PLOT_LMARGIN - 8, y, 7, COL_AXIS);
+    if (hz + step / 2 <= fs / 2)
+      tft.drawFastHLine(PLOT_LMARGIN - 5, yForHz(hz + step / 2), 4, COL_TICKS);
+
+    char buf[12];
+    formatHz(buf, sizeof(buf), hz);
+    const TextBox b = textBounds(aurora_244pt7b, buf);
+    int baselineY = constrain(y + b.h / 2, PLOT_Y0 + b.h, PLOT_Y0 + PLOT_H - 1);
+    drawText(aurora_244pt7b, buf, (PLOT_LMARGIN - 10) - b.w, baselineY, COL_TEXT, COL_BG);
+  }
 }
 
 void drawYAxisScale()
 {
   tft.fillRect(0, PLOT_Y0, PLOT_LMARGIN, PLOT_H, COL_BG);
   tft.drawFastVLine(PLOT_LMARGIN - 1, PLOT_Y0, PLOT_H, COL_AXIS);
-
-  auto yForVolt = [](float v) -> int
+  if (gView == VIEW_SPECTRUM)
   {
-    int raw = (int)roundf((v / 3.3f) * 4095.0f);
-    return adcToY_raw(raw);
-  };
-
-  tft.setFont(&aurora_244pt7b);
-  tft.setTextColor(COL_TEXT, COL_BG);
+    drawDbScale();
+    return;
+  }
+  if (gView == VIEW_WATERFALL)
+  {
+    drawFreqScaleVertical();
+    return;
+  }
 
-  for (int i = 0; i <= 33; ++i)
+  const int majorMv = VERT_MAJOR_MV[gVertGain];
+  for (int mv = 0; mv <= ADC_FULL_SCALE_MV; mv += VERT_MINOR_MV[gVertGain])
   {
-    float v = i * 0.1f;
-    int y = yForVolt(v);
-    if (y < PLOT_Y0 || y >= PLOT_Y0 + PLOT_H)
+    const int code = mvToCode(mv);
+    if (!codeInView(code))
       continue;
+    int y = adcToY_raw(code);
 
-    bool major = (i % 5 == 0);
+    bool major = (mv % majorMv == 0);
     int tickLen = major ? 7 : 4;
     int xStart = PLOT_LMARGIN - 1 - tickLen;
     tft.drawFastHLine(xStart, y, tickLen, major ? COL_AXIS : COL_TICKS);
+    if (!major)
+      continue;
 
-    if (major)
+    if (gVertGain == 0)
     {
-      char buf[12];
-      dtostrf(v, 3, 1, buf);
-      strcat(buf, "V");
-      int16_t x1, y1;
-      uint16_t tw, th;
-      tft.getTextBounds(buf, 0, 0, &x1, &y1, &tw, &th);
-
-      int tx = (PLOT_LMARGIN - 3) - (int)tw;
-      int baselineY = y + (int)th / 2;
-
-      int boxX = tx - 2;
-      int boxW = (PLOT_LMARGIN - 2) - boxX;
-      int boxY = baselineY - (int)th - 1;
-      int boxH = (int)th + 2;
-      tft.fillRect(boxX, boxY, boxW, boxH, COL_BG);
-
-      tft.setCursor(tx, baselineY);
-      tft.print(buf);
+      const Sprite &s = gLabels[LBL_VOLT_0 + mv / majorMv];
+      SpritePool::blit(tft, s, (PLOT_LMARGIN - 3) - s.box.w, y + s.box.h / 2);
+      continue;
     }
+    // Finer steps than the boot-time labels: "1.2V", "1.25V"
+    char buf[16];
+    const int cv = mv / 10;
+    if (majorMv % 100 == 0)
+      snprintf(buf, sizeof(buf), "%d.%dV", cv / 100, cv % 100 / 10);
+    else
+      snprintf(buf, sizeof(buf), "%d.%02dV", cv / 100, cv % 100);
+    const TextBox b = textBounds(aurora_244pt7b, buf);
+    int baselineY = constrain(y + b.h / 2, PLOT_Y0 + b.h, PLOT_Y0 + PLOT_H - 1);
+    drawText(aurora_244pt7b, buf, (PLOT_LMARGIN - 3) - b.w, baselineY, COL_TEXT, COL_BG);
   }
 }
 
+// Time per plot column
+float secondsPerPx()
+{
+  if (gSamplesPerPx > 1)
+    return float(gSamplesPerPx) / float(axisFs());
+  return 1.0f / (float(axisFs()) * float(pxPerSample));
+}
+
+// 1-2-5 time step (1 us .. 100 s) closest to 40 px between majors
 int computePxPerMajor()
 {
-  const float dt = 1.0f / (float(gSampleFreqHz) * float(pxPerSample));
-  const float steps[] = {
-      1e-4f, 2e-4f, 5e-4f,
-      1e-3f, 2e-3f, 5e-3f,
-      1e-2f, 2e-2f, 5e-2f,
-      1e-1f, 2e-1f, 5e-1f, 1.0f};
-  float targetPx = 40.0f, bestStep = steps[0], bestDiff = 1e9f;
-  for (size_t i = 0; i < sizeof(steps) / sizeof(steps[0]); ++i)
+  const float dt = secondsPerPx();
+  const float targetPx = 40.0f;
+  float bestStep = 1e-6f, bestDiff = 1e9f;
+  for (float dec = 1e-6f; dec < 200.0f; dec *= 10.0f)
   {
-    float px = steps[i] / dt;
-    float d = fabsf(px - targetPx);
-    if (d < bestDiff)
+    const float steps[3] = {dec, 2.0f * dec, 5.0f * dec};
+    for (float step : steps)
     {
-      bestDiff = d;
-      bestStep = steps[i];
+      float d = fabsf(step / dt - targetPx);
+      if (d < bestDiff)
+      {
+        bestDiff = d;
+        bestStep = step;
+      }
     }
   }
-  return (int)roundf(bestStep / dt);
+  return max(1, (int)roundf(bestStep / dt));
 }
 
-void drawXAxisScale()
+// Spectrum views: 1-2-5 frequency step giving at least ~50 px between majors
+// when 0..Fs/2 spans spanPx pixels
+uint32_t computeHzPerMajor(int spanPx)
 {
-  const int y0 = PLOT_Y0 + PLOT_H;
-  tft.fillRect(PLOT_X0, y0, PLOT_W, XAXIS_HEIGHT, COL_BG);
-  tft.drawFastHLine(PLOT_X0, y0, PLOT_W, COL_AXIS);
+  const uint32_t target = (uint32_t)((uint64_t)axisFs() * 50 / (2 * spanPx));
+  for (uint32_t dec = 1;; dec *= 10)
+  {
+    if (dec >= target)
+      return dec;
+    if (2 * dec >= target)
+      return 2 * dec;
+    if (5 * dec >= target)
+      return 5 * dec;
+  }
+}
 
-  const float dt = 1.0f / (float(gSampleFreqHz) * float(pxPerSample));
-  const int pxPerMajor = computePxPerMajor();
+// "0us", "250us", "5ms", "1.25s", "20s" for a time in ns
+void formatTime(char *buf, size_t len, uint64_t ns)
+{
+  if (ns >= 10000000000ULL)
+    snprintf(buf, len, "%lus", (unsigned long)((ns + 500000000ULL) / 1000000000ULL));
+  else if (ns >= 1000000000ULL)
+  {
+    const unsigned long cs = (unsigned long)((ns + 5000000ULL) / 10000000ULL);
+    snprintf(buf, len, "%lu.%02lus", cs / 100, cs % 100);
+  }
+  else if (ns >= 1000000ULL)
+    snprintf(buf, len, "%lums", (unsigned long)((ns + 500000ULL) / 1000000ULL));
+  else
+    snprintf(buf, len, "%luus", (unsigned long)((ns + 500ULL) / 1000ULL));
+}
 
-  tft.setFont(&aurora_244pt7b);
-  tft.setTextColor(COL_TEXT, COL_BG);
+// Centred under its tick, kept inside the plot width (strip coordinates)
+void printXAxisLabel(TextCanvas &strip, int x, const char *lab)
+{
+  const TextBox b = textBounds(aurora_244pt7b, lab);
+  int tx = x - b.w / 2;
+  if (tx + b.w > PLOT_W)
+    tx = PLOT_W - b.w;
+  if (tx < 0)
+    tx = 0;
+  strip.print(aurora_244pt7b, lab, tx, XAXIS_LABEL_BASELINE, COL_TEXT);
+}
 
-  for (int x = 0; x <= PLOT_W; x += pxPerMajor)
+void drawFreqScale(TextCanvas &strip)
+{
+  const uint32_t fs = axisFs();
+  const uint32_t step = computeHzPerMajor(PLOT_W);
+  for (uint32_t hz = 0; hz <= fs / 2; hz += step)
   {
-    int xx = PLOT_X0 + x;
-    tft.drawFastVLine(xx, y0, 6, COL_TICKS);
+    const int x = hzToX(hz, fs) - PLOT_X0;
+    strip.vLine(x, 0, 6, COL_TICKS);
+    char lab[12];
+    formatHz(lab, sizeof(lab), hz);
+    printXAxisLabel(strip, x, lab);
+
+    const uint32_t hm = hz + step / 2;
+    if (hm <= fs / 2)
+      strip.vLine(hzToX(hm, fs) - PLOT_X0, 0, 3, COL_TICKS);
+  }
+}
 
-    float t = x * dt; // seconds
-    char lab[16];
-    if (t >= 1.0f)
-      snprintf(lab, sizeof(lab), "%.2fs", t);
-    else if (t >= 1e-3f)
-      snprintf(lab, sizeof(lab), "%.0fms", t * 1000.0f);
-    else
-      snprintf(lab, sizeof(lab), "%.0fus", t * 1e6f);
+void drawXAxisScale()
+{
+  if (gView == VIEW_WATERFALL)
+    return; // this strip scrolls with the waterfall, so it stays blank
+
+  // Axis line, ticks and labels composed off-screen, then one window
+  TextCanvas strip(gTextPixels, PLOT_W, XAXIS_STRIP_H);
+  strip.fill(COL_BG);
+  strip.hLine(0, 0, PLOT_W, COL_AXIS);
+
+  if (gView == VIEW_SPECTRUM)
+  {
+    drawFreqScale(strip);
+  }
+  else if (gTraceMode == TRACE_XY)
+  {
+    // Channel A, 0.5 V per major tick as on the Y axis
+    for (int i = 0; i <= 33; i += 5)
+    {
+      const int x = adcToX_xy(mvToCode(i * 100)) - PLOT_X0;
+      strip.vLine(x, 0, 6, COL_TICKS);
+      if (i % 10)
+        continue; // every 1 V is enough room for a label
+      char lab[8];
+      snprintf(lab, sizeof(lab), "%d.0V", i / 10);
+      printXAxisLabel(strip, x, lab);
+    }
+  }
+  else
+  {
+    // Column time in ns: x * samplesPerPx / Fs, or x / (Fs * pxPerSample)
+    const uint64_t num = 1000000000ULL * (gSamplesPerPx > 1 ? gSamplesPerPx : 1);
+    const uint64_t den = (uint64_t)axisFs() * (gSamplesPerPx > 1 ? 1 : pxPerSample);
+    const int pxPerMajor = computePxPerMajor();
 
-    int16_t x1, y1;
-    uint16_t tw, th;
-    tft.getTextBounds(lab, 0, 0, &x1, &y1, &tw, &th);
-    int tx = xx - (int)tw / 2;
-    int ty = y0 + 10 + (int)th / 2;
-    if (tx < PLOT_X0)
-      tx = PLOT_X0;
-    if (tx + (int)tw > PLOT_X0 + PLOT_W)
-      tx = PLOT_X0 + PLOT_W - tw;
-    tft.setCursor(tx, ty);
-    tft.print(lab);
+    for (int x = 0; x <= PLOT_W; x += pxPerMajor)
+    {
+      strip.vLine(x, 0, 6, COL_TICKS);
+
+      char lab[16];
+      formatTime(lab, sizeof(lab), x * num / den);
+      printXAxisLabel(strip, x, lab);
 
-    int xm = xx + pxPerMajor / 2;
-    if (xm < PLOT_X0 + PLOT_W)
-      tft.drawFastVLine(xm, y0, 3, COL_TICKS);
+      int xm = x + pxPerMajor / 2;
+      if (xm < PLOT_W)
+        strip.vLine(xm, 0, 3, COL_TICKS);
+    }
   }
+  strip.blit(tft, PLOT_X0, PLOT_Y0 + PLOT_H);
 }
 
+void updateGridModel();
+
 void clearPlotAndHistory()
 {
-  tft.fillRect(PLOT_X0, PLOT_Y0, PLOT_W, PLOT_H, COL_BG);
+  updateGridModel();
+  gPlotBg.paint(tft);
   for (int i = 0; i < PLOT_W; ++i)
     gLastY[i] = -1;
+  gTrace.reset();
+  gPhosphor.clear(); // a history drawn at the old scale
+  gBands.invalidate();
 }
 
-void drawPausedGrid()
+// Graticule positions for the current view, in screen coordinates
+constexpr int GRID_MAX = 32;
+
+int gridRows(int16_t *rows, int maxRows)
 {
-  // Horizontal gridlines at major Y ticks
-  for (int i = 0; i <= 33; i++)
+  int n = 0;
+  if (gView != VIEW_SCOPE)
   {
-    if (i % 5 == 0)
-    { // major ticks every 0.5V
-      float v = i * 0.1f;
-      int raw = (int)roundf((v / 3.3f) * 4095.0f);
-      int y = adcToY_raw(raw);
-      if (y >= PLOT_Y0 && y < PLOT_Y0 + PLOT_H)
-      {
-        tft.drawFastHLine(PLOT_X0, y, PLOT_W, COL_GRID);
-      }
-    }
+    for (int db = 0; db >= -SPEC_DB_RANGE && n < maxRows; db -= SPEC_DB_MAJOR)
+      rows[n++] = (int16_t)dbToY(db);
+    return n;
   }
-
-  // Vertical gridlines at major X ticks
-  const float dt = 1.0f / (float(gSampleFreqHz) * float(pxPerSample));
-  const float steps[] = {1e-4f, 2e-4f, 5e-4f, 1e-3f, 2e-3f, 5e-3f,
-                         1e-2f, 2e-2f, 5e-2f, 1e-1f, 2e-1f, 5e-1f, 1.0f};
-  float targetPx = 40.0f;
-  float bestStep = steps[0], bestDiff = 1e9f;
-  for (size_t i = 0; i < sizeof(steps) / sizeof(steps[0]); ++i)
+  for (int mv = 0; mv <= ADC_FULL_SCALE_MV && n < maxRows; mv += VERT_MAJOR_MV[gVertGain]) // at the major ticks
   {
-    float px = steps[i] / dt;
-    float d = fabsf(px - targetPx);
-    if (d < bestDiff)
-    {
-      bestDiff = d;
-      bestStep = steps[i];
-    }
+    const int code = mvToCode(mv);
+    if (codeInView(code))
+      rows[n++] = (int16_t)adcToY_raw(code);
   }
-  const int pxPerMajor = (int)roundf(bestStep / dt);
+  return n;
+}
 
-  for (int x = 0; x <= PLOT_W; x += pxPerMajor)
+int gridCols(int16_t *cols, int maxCols)
+{
+  int n = 0;
+  if (gView != VIEW_SCOPE)
+  {
+    const uint32_t fs = axisFs();
+    const uint32_t step = computeHzPerMajor(PLOT_W);
+    for (uint32_t hz = 0; hz <= fs / 2 && n < maxCols; hz += step)
+      cols[n++] = (int16_t)hzToX(hz, fs);
+    return n;
+  }
+  if (gTraceMode == TRACE_XY)
   {
-    int xx = PLOT_X0 + x;
-    tft.drawFastVLine(xx, PLOT_Y0, PLOT_H, COL_GRID);
+    for (int i = 0; i <= 33 && n < maxCols; i += 5)
+      cols[n++] = (int16_t)adcToX_xy(mvToCode(i * 100));
+    return n;
   }
+  const int pxPerMajor = computePxPerMajor();
+  for (int x = 0; x <= PLOT_W && n < maxCols; x += pxPerMajor)
+    cols[n++] = (int16_t)(PLOT_X0 + x);
+  return n;
+}
+
+// Paused: moves the view to start at record sample start, kept inside the record
+void seekRecord(long start)
+{
+  const long last = (long)gRecord.length() - (long)recordSpan();
+  gRecordPos = (size_t)constrain(start, 0L, max(last, 0L));
+  gRecordDirty = true;
+}
+
+// A quarter of the view per step; dir < 0 is back in time
+void panRecord(int dir)
+{
+  if (browsingRecord())
+    seekRecord((long)gRecordPos + dir * (long)(recordSpan() / 4));
 }
 
 void setPaused(bool p)
 {
   if (gPaused == p)
     return;
+  if (!p)
+    gRecord.release(); // capture refills it from the resume
   gPaused = p;
   if (gPaused)
   {
-    drawPausedGrid();
+    // Browsing starts on the frame already on screen
+    gRecord.freeze();
+    const uint32_t oldest = gRecord.total() - (uint32_t)gRecord.length();
+    seekRecord((long)(int32_t)(gLastFrameEnd - oldest) - (long)recordSpan());
+    gRecordDirty = false;
     drawBottomBannerHUD();
     drawXAxisScale();
   }
   else
   {
+    gFrames.drain(); // anything queued predates the pause
     clearPlotAndHistory();
     // Your draw order preference:
     drawBottomBannerHUD();
@@ -405,287 +1039,1953 @@ void setPaused(bool p)
   }
 }
 
+// Graticule and DC/trigger cursors under the traces. Only what moved is
+// marked, and the next frame repaints those rows.
+void updateGridModel()
+{
+  int16_t rows[GRID_MAX], cols[GRID_MAX];
+  const int nRows = gridRows(rows, GRID_MAX);
+  const int nCols = gridCols(cols, GRID_MAX);
+  gPlotBg.setFill(COL_BG);
+  gPlotBg.setGrid(rows, nRows, cols, nCols, COL_GRID);
+  // Scrolled waterfall lines are not redrawn, so nothing may sit under them
+  gPlotBg.setGridVisible(gShowGrid && gView != VIEW_WATERFALL);
+  const bool scope = gView == VIEW_SCOPE && gTraceMode != TRACE_XY; // XY has no time axis to trigger on
+  auto rowOf = [scope](int code) { return scope && codeInView(code) ? adcToY_raw(code) : -1; };
+  gCursorDC = gDCOffsetRaw;
+  gPlotBg.setCursor(0, rowOf(gCursorDC), COL_CURSOR);
+  gPlotBg.setCursor(1, rowOf(gTrig.level), COL_TRIG);
+  gCursorDCB = gDCOffsetRawB;
+  gPlotBg.setCursor(2, gTraceMode == TRACE_AB ? rowOf(gCursorDCB) : -1, COL_TRACE_B);
+}
+
+// The DC cursors follow the tracked offsets once they have moved a few codes
+void followDC()
+{
+  if (abs(gDCOffsetRaw - gCursorDC) >= DC_CURSOR_STEP || abs(gDCOffsetRawB - gCursorDCB) >= DC_CURSOR_STEP)
+    updateGridModel();
+}
+
+void redrawHUDandXAxis();
+
+// Relabels once the source has timed itself, or its measured rate moved
+void followFs()
+{
+  static uint32_t shown = 0;
+  const uint32_t fs = axisFs();
+  if (fs == shown)
+    return;
+  const bool first = !shown;
+  shown = fs;
+  if (!first)
+    redrawHUDandXAxis();
+}
+
 // -------------------- SETTINGS (redraw HUD first, then X axis) --------------------
 void redrawHUDandXAxis()
 {
   drawBottomBannerHUD(); // banner first
   drawXAxisScale();      // then axis
+  updateGridModel();
 }
 
-void setPxPerSample(uint8_t n)
+// Timebase: magnified down to 1 px/sample, then decimated
+void setTimebase(uint8_t pxs, uint16_t spp)
 {
-  if (n < PXS_MIN)
-    n = PXS_MIN;
-  if (n > PXS_MAX)
-    n = PXS_MAX;
-  if (n == pxPerSample)
+  pxs = constrain(pxs, PXS_MIN, PXS_MAX);
+  if (spp > 1)
+    pxs = 1;
+  if (pxs == pxPerSample && spp == gSamplesPerPx)
     return;
-  pxPerSample = n;
+  const long centre = (long)(gRecordPos + recordSpan() / 2);
+  pxPerSample = pxs;
+  gSamplesPerPx = spp;
   clearPlotAndHistory();
-  Serial.print(F("Px/Sample set to "));
-  Serial.println(pxPerSample);
+  if (gPaused)
+    seekRecord(centre - (long)(recordSpan() / 2)); // zoom about the middle of the view
+  if (spp > 1)
+  {
+    Serial.print(F("Samples/Px set to "));
+    Serial.println(spp);
+  }
+  else
+  {
+    Serial.print(F("Px/Sample set to "));
+    Serial.println(pxPerSample);
+  }
   redrawHUDandXAxis();
 }
 
+void slowerTimebase()
+{
+  if (gSamplesPerPx <= 1 && pxPerSample > PXS_MIN)
+  {
+    setTimebase(pxPerSample - 1, 1);
+    return;
+  }
+  for (size_t i = 0; i + 1 < SPP_STEP_COUNT; ++i)
+    if (SPP_STEPS[i] == gSamplesPerPx)
+    {
+      setTimebase(1, SPP_STEPS[i + 1]);
+      return;
+    }
+}
+
+void fasterTimebase()
+{
+  if (gSamplesPerPx <= 1)
+  {
+    setTimebase(pxPerSample + 1, 1);
+    return;
+  }
+  for (size_t i = 1; i < SPP_STEP_COUNT; ++i)
+    if (SPP_STEPS[i] == gSamplesPerPx)
+      setTimebase(1, SPP_STEPS[i - 1]);
+}
+
+void setDecimMode(DecimMode m)
+{
+  gDecimMode = m;
+  Serial.print(F("Decimation: "));
+  Serial.println(m == DECIM_PEAK ? F("peak detect") : F("average"));
+  clearPlotAndHistory();
+  if (gPaused)
+    seekRecord((long)gRecordPos);
+  drawBottomBannerHUD();
+}
+
+uint32_t maxSampleFreq()
+{
+  return gTraceMode == TRACE_A ? FS_MAX : FS_MAX / 2; // two conversions per sample
+}
+
 void setSampleFreq(uint32_t newFs)
 {
+  const uint32_t fsMax = maxSampleFreq();
   if (newFs < FS_MIN)
     newFs = FS_MIN;
-  if (newFs > FS_MAX)
-    newFs = FS_MAX;
+  if (newFs > fsMax)
+    newFs = fsMax;
   if (newFs == gSampleFreqHz)
     return;
-  gSampleFreqHz = newFs;
+  gSampleFreqHz = newFs; // picked up by the capture side before its next frame
   Serial.print(F("Fs set to "));
   Serial.println(gSampleFreqHz);
   redrawHUDandXAxis();
 }
 
-// -------------------- BUTTONS --------------------
-bool debounceEdge(Btn &b)
+// -------------------- TRIGGER --------------------
+void applyTrigger()
 {
-  bool raw = digitalRead(b.pin); // HIGH=not pressed (pull-up), LOW=pressed
-  uint32_t now = millis();
-  if (raw != b.lastRaw)
-  {
-    b.lastRaw = raw;
-    b.lastChange = now;
-  }
-  if ((now - b.lastChange) >= DEBOUNCE_MS)
-  {
-    if (raw != b.lastStable)
-    {
-      b.lastStable = raw;
-      // We detect a *press* edge (HIGH->LOW)
-      if (raw == LOW)
-        return true;
-    }
-  }
-  return false;
+  gTrigGen = gTrigGen + 1; // capture re-configures (and re-arms) before its next frame
+  updateGridModel();
+  drawBottomBannerHUD();
 }
 
-void pollButtons()
+void setTriggerMode(TriggerMode m)
 {
-  if (debounceEdge(btnFsDown))
-    setSampleFreq(gSampleFreqHz >= 2000 ? gSampleFreqHz - 1000 : FS_MIN);
-  if (debounceEdge(btnFsUp))
-    setSampleFreq(gSampleFreqHz + 1000);
-  if (debounceEdge(btnPxDown))
-    setPxPerSample(pxPerSample > PXS_MIN ? pxPerSample - 1 : PXS_MIN);
-  if (debounceEdge(btnPxUp))
-    setPxPerSample(pxPerSample < PXS_MAX ? pxPerSample + 1 : PXS_MAX);
-  if (debounceEdge(btnPause))
-    setPaused(!gPaused);
+  gTrig.mode = m;
+  static const char *const names[TRIG_MODE_COUNT] = {"auto", "normal", "single"};
+  Serial.print(F("Trigger mode: "));
+  Serial.println(names[m]);
+  applyTrigger();
 }
 
-// -------------------- SERIAL CONTROLS --------------------
-void handleSerial()
+void setTriggerEdge(TriggerEdge e)
+{
+  gTrig.edge = e;
+  Serial.print(F("Trigger edge: "));
+  Serial.println(e == EDGE_RISING ? F("rising") : F("falling"));
+  applyTrigger();
+}
+
+void setTriggerLevel(int raw)
+{
+  gTrig.level = (int16_t)constrain(raw, 0, ADC_CODE_MAX);
+  Serial.print(F("Trigger level (V): "));
+  Serial.println(codeToMv(gTrig.level) / 1000.0f, 2);
+  applyTrigger();
+}
+
+void setPreTrigger(int pct)
 {
-  if (!Serial.available())
+  gTrig.preTriggerPct = (uint8_t)constrain(pct, 0, 100);
+  Serial.print(F("Pre-trigger: "));
+  Serial.print(gTrig.preTriggerPct);
+  Serial.println(F("%"));
+  applyTrigger();
+}
+
+// -------------------- VERTICAL --------------------
+// The bottom is kept inside the ADC's range, so the plot never shows codes
+// the input cannot reach
+void setVerticalScale(uint8_t gain, int bottom)
+{
+  gain = min(gain, VERT_GAIN_MAX);
+  bottom = constrain(bottom, 0, ADC_CODES - (ADC_CODES >> gain));
+  if (gain == gVertGain && bottom == gVertBottom)
     return;
+  gVertGain = gain;
+  gVertBottom = (int16_t)bottom;
+  Serial.print(F("Vertical: x"));
+  Serial.print(1u << gain);
+  Serial.print(F(" from "));
+  Serial.print(codeToMv(bottom) / 1000.0f, 2);
+  Serial.println(F(" V"));
+  drawYAxisScale();
+  clearPlotAndHistory();
+  gRecordDirty = gPaused;
+}
 
-  int peekc = Serial.peek();
-  if (peekc == 'f' || peekc == 'F')
-  {
-    String line = Serial.readStringUntil('\n');
-    long val = -1;
-    String num = "";
-    for (size_t i = 0; i < line.length(); ++i)
-    {
-      if (isDigit((unsigned char)line[i]))
-        num += line[i];
-      else if (num.length() && !isDigit((unsigned char)line[i]))
-        break;
-    }
-    if (num.length())
-      val = num.toInt();
-    if (val > 0)
-      setSampleFreq((uint32_t)val);
-    else
-      Serial.println(F("Parse Fs failed. Use: f8000 or fs=12000"));
+// Zooms about the middle of the plot
+void setVerticalGain(uint8_t gain)
+{
+  const int centre = gVertBottom + (ADC_CODES >> gVertGain) / 2;
+  gain = min(gain, VERT_GAIN_MAX);
+  setVerticalScale(gain, centre - (ADC_CODES >> gain) / 2);
+}
+
+// -------------------- AUTO-SET --------------------
+// The UI bumps gAutoSetGen; capture answers with one burst read at the top
+// rate (AutoSet.h), publishes the survey and then gAutoSetDone. The UI turns
+// the survey into settings. The burst bounds the whole thing: the answer is
+// back within AUTOSET_BURST_MS plus one frame.
+volatile uint32_t gAutoSetGen = 0;
+volatile uint32_t gAutoSetDone = 0;
+AutoSetSurvey gAutoSetSurvey; // written by capture before gAutoSetDone
+bool gAutoSetPending = false;
+constexpr uint32_t AUTOSET_BURST_MS = 120;
+constexpr uint32_t AUTOSET_SETTLE_MS = 2; // dropped first: the source and filters restarting
+constexpr uint32_t AUTOSET_LEVEL_MS = 40; // levels only, before the crossings count
+constexpr uint32_t AUTOSET_PERIODS = 3;   // across the plot
+constexpr int AUTOSET_FILL_PCT = 80;      // of the plot height for the swing, at most
+
+void setView(ScopeView v);
+void setTraceMode(TraceMode m);
+
+void startAutoSet()
+{
+  if (gAutoSetPending)
     return;
-  }
+  // Live, triggered waveforms: back to the scope with A on the time axis
+  setPaused(false);
+  setView(VIEW_SCOPE);
+  if (gTraceMode == TRACE_XY)
+    setTraceMode(TRACE_A);
+  Serial.println(F("Auto-set..."));
+  gAutoSetPending = true;
+  gAutoSetGen = gAutoSetGen + 1;
+}
 
-  int c = Serial.read();
-  if (c == ' ')
+// Fs and timebase for AUTOSET_PERIODS periods across the plot: one sample
+// per column where Fs allows, magnified at the top rate, decimated below
+// FS_MIN. Fs is kept to whole FS_STEPs, like the buttons.
+void applyAutoSetTimebase(uint32_t periodQ8, uint32_t fsSurvey)
+{
+  // One sample per column: PLOT_W / (AUTOSET_PERIODS * period)
+  const uint64_t ideal = ((uint64_t)PLOT_W * fsSurvey << 8) / ((uint64_t)AUTOSET_PERIODS * periodQ8);
+  const uint32_t fsMax = maxSampleFreq();
+  uint8_t pxs = 1;
+  uint16_t spp = 1;
+  uint64_t fs = ideal;
+  if (ideal >= fsMax)
   {
-    setPaused(!gPaused);
-    Serial.print(F("Paused: "));
-    Serial.println(gPaused ? F("YES") : F("NO"));
-    return;
+    fs = fsMax;
+    pxs = (uint8_t)constrain(ideal / fsMax, (uint64_t)PXS_MIN, (uint64_t)PXS_MAX);
   }
-  if (c == 'g' || c == 'G')
+  else
   {
-    gShowPausedGrid = !gShowPausedGrid;
-    Serial.print(F("Paused grid: "));
-    Serial.println(gShowPausedGrid ? F("ON") : F("OFF"));
-    if (gPaused)
+    for (size_t i = 0; i < SPP_STEP_COUNT && fs < FS_MIN; ++i)
     {
-      clearPlotAndHistory();
-      if (gShowPausedGrid)
-        drawPausedGrid();
+      spp = SPP_STEPS[i];
+      fs = ideal * spp;
     }
+    fs = max((fs + FS_STEP / 2) / FS_STEP * FS_STEP, (uint64_t)FS_MIN);
+  }
+  setSampleFreq((uint32_t)min(fs, (uint64_t)fsMax));
+  setTimebase(pxs, spp);
+}
+
+void applyAutoSet(const AutoSetSurvey &s)
+{
+  if (!s.samples)
+  {
+    Serial.println(F("Auto-set: no samples"));
     return;
   }
-  if (c == 'p')
-    setPxPerSample(pxPerSample > PXS_MIN ? (uint8_t)(pxPerSample - 1) : PXS_MIN);
-  if (c == 'P')
-    setPxPerSample(pxPerSample < PXS_MAX ? (uint8_t)(pxPerSample + 1) : PXS_MAX);
+  // The largest gain that keeps the swing inside AUTOSET_FILL_PCT, centred
+  const int pp = s.max - s.min;
+  const int centre = (s.min + s.max) / 2;
+  uint8_t gain = 0;
+  while (gain < VERT_GAIN_MAX && pp * 100 <= (ADC_CODES >> (gain + 1)) * AUTOSET_FILL_PCT)
+    ++gain;
+  setVerticalScale(gain, centre - (ADC_CODES >> gain) / 2);
+
+  if (s.periodQ8)
+    applyAutoSetTimebase(s.periodQ8, s.fs);
+
+  gTrig.level = (int16_t)centre;
+  applyTrigger();
+
+  char vpp[12], freq[16];
+  formatVoltsQ8(vpp, sizeof(vpp), (int64_t)pp << 8);
+  Serial.print(F("Auto-set: Vpp "));
+  Serial.print(vpp);
+  if (s.periodQ8)
+  {
+    formatFreq(freq, sizeof(freq), ((uint64_t)s.fs * 100 << 8) / s.periodQ8);
+    Serial.print(F(", f "));
+    Serial.println(freq);
+  }
+  else
+    Serial.println(F(", no period (timebase kept)"));
 }
 
-// -------------------- SETUP / LOOP --------------------
-void setup()
+// From loop(): picks up the capture side's answer
+void followAutoSet()
 {
-  Serial.begin(115200);
-  Serial.println(F("Controls: f8000 | fs=12000 | p/P Px/Sample | <space> pause | g grid toggle"));
-  Serial.println(F("Buttons: Fs-:13 Fs+:12 Px-:14 Px+:27 Pause:15"));
-  Serial.println(F("VU pins: 25,26,32,33,2,4 (34/35 are input-only on ESP32)"));
+  if (!gAutoSetPending || gAutoSetDone != gAutoSetGen)
+    return;
+  gAutoSetPending = false;
+  applyAutoSet(gAutoSetSurvey);
+}
 
-  analogReadResolution(12);
-  analogSetPinAttenuation(MIC_PIN, ADC_11db);
-  pinMode(MIC_PIN, INPUT);
+// -------------------- SPECTRUM --------------------
+void setView(ScopeView v)
+{
+  if (v == gView)
+    return;
+  const ScopeView old = gView;
+  gView = v; // capture switches over before its next frame
+  static const char *const names[VIEW_COUNT] = {"scope", "spectrum", "waterfall"};
+  Serial.print(F("View: "));
+  Serial.println(names[v]);
 
-  // Buttons with internal pull-ups
-  pinMode(BTN_FS_DOWN, INPUT_PULLUP);
-  pinMode(BTN_FS_UP, INPUT_PULLUP);
-  pinMode(BTN_PX_DOWN, INPUT_PULLUP);
-  pinMode(BTN_PX_UP, INPUT_PULLUP);
-  pinMode(BTN_PAUSE, INPUT_PULLUP);
+  if (old == VIEW_WATERFALL)
+  {
+    // Scrolled lines and the margin HUD are left behind: start from a clean frame
+    gWaterfall.stop(tft);
+    tft.fillScreen(COL_BG);
+  }
+  if (v == VIEW_WATERFALL)
+    gWaterfall.start(tft, COL_BG);
+  else
+    drawTopBanner(); // measurements in the scope view only
+  drawYAxisScale();
+  clearPlotAndHistory();
+  gRecordDirty = gPaused;
+  redrawHUDandXAxis();
+}
 
-  // VU LEDs
-  initVU();
-  setVU(0);
+void setFftSize(uint16_t n)
+{
+  if (n < FFT_MIN || n > FFT_MAX)
+    n = FFT_MIN;
+  gFftSize = n;
+  Serial.print(F("FFT size: "));
+  Serial.println(n);
+  drawBottomBannerHUD();
+}
 
-  VUdance();
+void setFftWindow(FftWindow w)
+{
+  gFftWindow = (FftWindow)(w % WIN_COUNT);
+  Serial.print(F("FFT window: "));
+  Serial.println(RealFft::windowName(gFftWindow));
+  drawBottomBannerHUD();
+}
 
-  tft.begin();
-  tft.setRotation(1);
-  tft.fillScreen(COL_BG);
+// -------------------- BUTTONS --------------------
+// Paused, the Fs buttons pan through the record instead
+void stepSampleFreq(int dir, uint16_t repeats)
+{
+  if (browsingRecord())
+  {
+    panRecord(dir);
+    return;
+  }
+  const uint32_t step = repeats >= FS_FAST_AFTER ? FS_STEP_FAST : FS_STEP;
+  if (dir > 0)
+    setSampleFreq(gSampleFreqHz + step);
+  else
+    setSampleFreq(gSampleFreqHz > FS_MIN + step ? gSampleFreqHz - step : FS_MIN);
+}
 
-  drawTitle();
-  drawYAxisScale();
-  drawBottomBannerHUD(); // your order: banner first
-  drawXAxisScale();
+void handleButtons()
+{
+  PROFILE_SCOPE(PROF_BUTTONS);
+  ButtonEvent e;
+  while (gButtons.next(e))
+  {
+    const bool step = e.gesture == BTN_PRESS || e.gesture == BTN_REPEAT;
+    switch (e.button)
+    {
+    case BUTTON_FS_DOWN:
+    case BUTTON_FS_UP:
+      if (step)
+        stepSampleFreq(e.button == BUTTON_FS_UP ? 1 : -1, e.repeats);
+      break;
+    case BUTTON_PX_DOWN:
+      if (step)
+        slowerTimebase();
+      break;
+    case BUTTON_PX_UP:
+      if (step)
+        fasterTimebase();
+      break;
+    case BUTTON_PAUSE:
+      if (e.gesture == BTN_CLICK)
+        setPaused(!gPaused);
+      else if (e.gesture == BTN_LONG)
+        startAutoSet();
+      break;
+    case BUTTON_TRIG:
+      if (e.gesture == BTN_CLICK)
+        setTriggerMode((TriggerMode)((gTrig.mode + 1) % TRIG_MODE_COUNT));
+      else if (e.gesture == BTN_LONG)
+      {
+        Serial.println(F("Trigger re-armed"));
+        applyTrigger();
+      }
+      break;
+    }
+  }
+}
 
-  // DC offset splash
-  {
-    tft.fillRect(PLOT_X0, PLOT_Y0, PLOT_W, PLOT_H, COL_BG);
-    tft.setFont(&aurora_247pt7b);
-    tft.setTextColor(COL_TEXT, COL_BG);
-    const char *msg = "Measuring DC Offset...";
-    int w, h;
-    measureText(&aurora_247pt7b, msg, &w, &h);
-    int msgX = PLOT_X0 + (PLOT_W - w) / 2;
-    int msgY = PLOT_Y0 + (PLOT_H + h) / 2;
-    tft.setCursor(msgX, msgY);
-    tft.print(msg);
-  }
-
-  gDCOffsetRaw = estimateDCoffset(256);
-  float dcV = (gDCOffsetRaw / 4095.0f) * 3.3f;
-  Serial.print(F("DC Offset (raw): "));
-  Serial.println(gDCOffsetRaw);
-  Serial.print(F("DC Offset (V):   "));
-  Serial.println(dcV, 3);
-
-  // Show DC value for 1s
-  tft.fillRect(PLOT_X0, PLOT_Y0, PLOT_W, PLOT_H, COL_BG);
-  {
-    char line[32];
-    snprintf(line, sizeof(line), "DC: %.2f V", dcV);
-    int w, h;
-    measureText(&aurora_247pt7b, line, &w, &h);
-    int x = PLOT_X0 + (PLOT_W - w) / 2;
-    int y = PLOT_Y0 + (PLOT_H + h) / 2;
-    tft.setCursor(x, y);
-    tft.print(line);
-  }
-  delay(1000);
+// -------------------- SERIAL CONTROLS --------------------
+// Lines are assembled a byte at a time (CommandLine.h), so a half-typed
+// command never stalls a frame. A line holds ';'-separated commands: a
+// setting as key=value (or "key value"), or a run of the single-letter
+// keys. A space, ',', '.', '[' or ']' at the start of a line acts at once.
+CommandLine gCmdLine;
 
-  clearPlotAndHistory();
+void setRenderMode(RenderMode m)
+{
+  gRenderMode = m;
+  Serial.print(F("Renderer: "));
+  if (gRenderMode == RENDER_SPANS)
+    Serial.println(F("span bursts"));
+  else if (gRenderMode == RENDER_BANDS)
+    Serial.println(F("RAM bands"));
+  else if (gRenderMode == RENDER_PIXELS)
+    Serial.println(F("per-pixel"));
+  else
+    Serial.println(F("persistence"));
+  if (!gPaused)
+    clearPlotAndHistory();
 }
 
-void loop()
+const char *const TRACE_NAMES[TRACE_MODE_COUNT] = {"a", "ab", "a-b", "xy"};
+
+void setTraceMode(TraceMode m)
 {
-  handleSerial();
-  pollButtons();
+  if (m == gTraceMode)
+    return;
+  gTraceMode = m; // capture switches the source over before its next frame
+  static const char *const names[TRACE_MODE_COUNT] = {"A", "A and B", "A-B", "XY (B against A)"};
+  Serial.print(F("Channels: "));
+  Serial.println(names[m]);
+  setSampleFreq(gSampleFreqHz); // B halves the top rate
+  clearPlotAndHistory();
+  if (gPaused)
+    seekRecord((long)gRecordPos);
+  redrawHUDandXAxis();
+}
 
+void setGrid(bool on)
+{
+  gShowGrid = on;
+  Serial.print(F("Graticule: "));
+  Serial.println(gShowGrid ? F("ON") : F("OFF"));
+  updateGridModel(); // the next frame repaints the plot rows
   if (gPaused)
+    gRecordDirty = true;
+}
+
+void setMeasureShown(bool on)
+{
+  gShowMeasure = on;
+  Serial.print(F("Measurements: "));
+  Serial.println(gShowMeasure ? F("ON") : F("OFF"));
+  if (gView != VIEW_WATERFALL)
+    drawTopBanner();
+}
+
+void setVuMode(VuMode m)
+{
+  gVu.setMode(m);
+  Serial.print(F("VU: "));
+  Serial.println(m == VU_PEAK ? F("peak") : F("RMS"));
+}
+
+void setStreaming(bool on)
+{
+  if (on)
   {
-    delay(5);
+    Serial.println(F("Streaming ON"));
+    Serial.flush(); // the text must not land inside the first packet
+  }
+  gStreaming = on;
+  if (!on)
+    Serial.println(F("Streaming OFF"));
+}
+
+void togglePause()
+{
+  setPaused(!gPaused);
+  Serial.print(F("Paused: "));
+  Serial.println(gPaused ? F("YES") : F("NO"));
+}
+
+void printFrameStats()
+{
+  Serial.print(F("Frames captured: "));
+  Serial.print(gFrames.pushed());
+  Serial.print(F("  dropped: "));
+  Serial.print(gFrames.dropped());
+  Serial.print(F("  ADC overruns: "));
+  Serial.println(gSource.overruns());
+  Serial.print(F("Stream packets sent: "));
+  Serial.print(gStreamSent);
+  Serial.print(F("  dropped (TX full): "));
+  Serial.println(gStreamDropped);
+}
+
+void applyFilters()
+{
+  gFilterGen = gFilterGen + 1; // capture re-designs the chain before its next frame
+}
+
+void printFilterReport()
+{
+  static const char *const BIQUAD_NAMES[BIQUAD_TYPE_COUNT] = {"", "low-pass", "band-pass"};
+  Serial.print(gFilter.dcBlock ? F("Filters: AC coupled") : F("Filters: DC coupled"));
+  if (gFilter.biquad != BIQUAD_OFF)
+  {
+    Serial.print(F(" | "));
+    Serial.print(BIQUAD_NAMES[gFilter.biquad]);
+    Serial.print(' ');
+    Serial.print(gFilter.biquadHz);
+    Serial.print(F(" Hz Q "));
+    Serial.print(gFilter.biquadQ, 2);
+  }
+  if (gFilter.firHz)
+  {
+    Serial.print(F(" | FIR "));
+    Serial.print(FilterChain::FIR_TAPS);
+    Serial.print(F(" taps "));
+    Serial.print(gFilter.firHz);
+    Serial.print(F(" Hz"));
+  }
+  Serial.println();
+  const int16_t dc = gDCInputRaw;
+  const uint32_t budget = cpuHz() / gSampleFreqHz;
+  const uint32_t cycles = gFilterCycles;
+  Serial.print(F("Input DC "));
+  Serial.print(dc);
+  Serial.print(F(" ("));
+  Serial.print(codeToMv(dc) / 1000.0f, 3);
+  Serial.print(F(" V); "));
+  Serial.print(cycles);
+  Serial.print(F(" cycles/sample of "));
+  Serial.print(budget);
+  Serial.print(F(" at this Fs ("));
+  Serial.print(100.0f * cycles / budget, 1);
+  Serial.println(F("%)"));
+}
+
+// Milli-units as whole units with three decimals
+void printMilli(uint64_t milli)
+{
+  const unsigned frac = (unsigned)(milli % 1000);
+  Serial.print((unsigned long)(milli / 1000));
+  Serial.print(frac < 10 ? F(".00") : frac < 100 ? F(".0") : F("."));
+  Serial.print(frac);
+}
+
+// The meter is capture's; read across cores here, which is fine for a report
+void printClockReport()
+{
+  Serial.print(F("Fs set "));
+  Serial.print(gSampleFreqHz);
+  Serial.print(F(" Hz"));
+  const RateMeter *m = gSource.rateMeter();
+  if (!m)
+  {
+    Serial.println(F(", paced by the CPU clock itself"));
+    return;
+  }
+  if (!m->settled())
+  {
+    Serial.println(F(", not timed yet"));
     return;
   }
+  const uint64_t fsMilli = gSource.measuredRateMilliHz();
+  const uint64_t hwMilli = m->rateMilliHz();
+  Serial.print(F(", delivering "));
+  printMilli(fsMilli);
+  Serial.print(F(" Hz | hardware "));
+  printMilli(hwMilli);
+  Serial.print(F(" Hz (asked "));
+  Serial.print(m->nominalHz());
+  Serial.print(F(") | timed over "));
+  Serial.print(m->spanMs() / 1000.0f, 1);
+  Serial.println(F(" s"));
+  Serial.print(F("Arrival jitter:"));
+  for (int i = 0; i < RateMeter::JITTER_BINS; ++i)
+  {
+    const unsigned long us = (unsigned long)RateMeter::JITTER_BIN0_US << min(i, RateMeter::JITTER_BINS - 2);
+    Serial.print(i < RateMeter::JITTER_BINS - 1 ? F(" <") : F(" >="));
+    Serial.print(us);
+    Serial.print(F("us:"));
+    Serial.print(m->jitter(i));
+  }
+  Serial.println();
+}
+
+void printCalibration()
+{
+  Serial.print(F("ADC calibration: "));
+  Serial.print(gCal.sourceName());
+  for (int i = 0; i < gCal.pointCount(); ++i)
+  {
+    Serial.print(i ? F(", raw ") : F(" | raw "));
+    Serial.print(gCal.point(i).raw);
+    Serial.print(F(" = "));
+    Serial.print(gCal.point(i).mv);
+    Serial.print(F(" mV"));
+  }
+  Serial.print(F("\r\n  raw -> mV:"));
+  for (int raw = 0; raw <= ADC_CODE_MAX; raw += 512)
+  {
+    Serial.print(' ');
+    Serial.print(raw);
+    Serial.print(':');
+    Serial.print(gCal.toMv((uint16_t)raw));
+  }
+  Serial.print(' ');
+  Serial.print(ADC_CODE_MAX);
+  Serial.print(':');
+  Serial.println(gCal.toMv(ADC_CODE_MAX));
+}
+
+// The single-letter keys
+void handleKey(char c)
+{
+  switch (c)
+  {
+  case ' ':
+    togglePause();
+    break;
+  case 'g':
+  case 'G':
+    setGrid(!gShowGrid);
+    break;
+  case 'q':
+  case 'Q':
+    printFrameStats();
+    break;
+  case 't':
+  case 'T':
+    setTriggerMode((TriggerMode)((gTrig.mode + 1) % TRIG_MODE_COUNT));
+    break;
+  case 'e':
+  case 'E':
+    setTriggerEdge(gTrig.edge == EDGE_RISING ? EDGE_FALLING : EDGE_RISING);
+    break;
+  case 'l':
+    setTriggerLevel(gTrig.level - mvToCode(100));
+    break;
+  case 'L':
+    setTriggerLevel(gTrig.level + mvToCode(100));
+    break;
+  case '[':
+    setPreTrigger(gTrig.preTriggerPct - 10);
+    break;
+  case ']':
+    setPreTrigger(gTrig.preTriggerPct + 10);
+    break;
+  case 'a':
+  case 'A':
+    Serial.println(F("Trigger re-armed"));
+    applyTrigger();
+    break;
+  case 'r':
+  case 'R':
+    setRenderMode((RenderMode)((gRenderMode + 1) % RENDER_MODE_COUNT));
+    break;
+  case 'i':
+  case 'I':
+    gShowRenderStats = !gShowRenderStats;
+    gStatFrames = gStatBytes = gStatPixels = 0;
+    gStatStartMs = millis();
+    break;
+  case 'm':
+  case 'M':
+    setView((ScopeView)((gView + 1) % VIEW_COUNT));
+    break;
+  case 'n':
+  case 'N':
+    setFftSize((uint16_t)(gFftSize * 2)); // wraps to FFT_MIN past FFT_MAX
+    break;
+  case 'w':
+  case 'W':
+    setFftWindow((FftWindow)(gFftWindow + 1));
+    break;
+  case 'u':
+  case 'U':
+    setVuMode((VuMode)((gVu.mode() + 1) % VU_MODE_COUNT));
+    break;
+  case 'v':
+  case 'V':
+    setMeasureShown(!gShowMeasure);
+    break;
+  case 'd':
+  case 'D':
+    setDecimMode(gDecimMode == DECIM_PEAK ? DECIM_AVERAGE : DECIM_PEAK);
+    break;
+  case 'p':
+    slowerTimebase();
+    break;
+  case 'P':
+    fasterTimebase();
+    break;
+  case ',':
+    panRecord(-1);
+    break;
+  case '.':
+    panRecord(1);
+    break;
+  default:
+    Serial.print(F("Unknown key: "));
+    Serial.println(c);
+    break;
+  }
+}
+
+// ---- values ----
+// Whole number in lo..hi, with an optional k (x1000) suffix
+bool parseUint(const char *v, long lo, long hi, long &out)
+{
+  char *end;
+  const double d = strtod(v, &end);
+  if (end == v)
+    return false;
+  const bool kilo = *end == 'k' || *end == 'K';
+  if (*(end + kilo))
+    return false;
+  out = lround(kilo ? d * 1000.0 : d);
+  return out >= lo && out <= hi;
+}
+
+// Index of v in names (case-insensitive), or -1
+int parseName(const char *v, const char *const *names, int n)
+{
+  for (int i = 0; i < n; ++i)
+    if (!strcasecmp(v, names[i]))
+      return i;
+  return -1;
+}
+
+// on/off, 1/0, yes/no; -1 if neither
+int parseSwitch(const char *v)
+{
+  static const char *const NAMES[] = {"off", "on", "0", "1", "no", "yes"};
+  const int i = parseName(v, NAMES, 6);
+  return i < 0 ? -1 : i & 1;
+}
 
-  // ---- sample capture timed by micros() ----
-  int Nsamples = (PLOT_W + pxPerSample - 1) / pxPerSample + 1; // +1 for segment end
-  static int16_t buffer[SCREEN_W + 4];                         // generous
+// One key=value setting; false if the value did not parse
+struct Setting
+{
+  const char *key;
+  const char *alias; // nullptr if none
+  const char *usage;
+  bool (*apply)(const char *value);
+};
 
-  uint32_t period_us = (uint32_t)(1000000UL / gSampleFreqHz);
-  uint32_t t = micros();
+const char *const TRIG_MODE_NAMES[TRIG_MODE_COUNT] = {"auto", "normal", "single"};
+const char *const EDGE_NAMES[] = {"rising", "falling"};
+const char *const VIEW_NAMES[VIEW_COUNT] = {"scope", "spectrum", "waterfall"};
+const char *const RENDER_NAMES[RENDER_MODE_COUNT] = {"spans", "bands", "pixels", "phosphor"};
+const char *const DECIM_NAMES[DECIM_MODE_COUNT] = {"peak", "avg"};
+const char *const VU_NAMES[VU_MODE_COUNT] = {"peak", "rms"};
+const char *const COUPLING_NAMES[] = {"dc", "ac"};
 
-  int16_t peak = 0; // for VU
-  for (int i = 0; i < Nsamples; ++i)
+// "efuse", "nominal", "clear" or the millivolts now on the input
+bool applyCalibration(const char *v)
+{
+  if (!strcasecmp(v, "efuse"))
+  {
+    if (!gCal.useEfuse())
+    {
+      Serial.println(F("No eFuse calibration on this chip"));
+      return true;
+    }
+  }
+  else if (!strcasecmp(v, "nominal"))
+    gCal.useNominal();
+  else if (!strcasecmp(v, "clear"))
+    gCal.clearPoints();
+  else
   {
-    t += period_us;
-    while ((int32_t)(micros() - t) < 0)
-    { /* spin to keep cadence */
+    long mv;
+    if (!parseUint(v, 0, ADC_FULL_SCALE_MV, mv))
+      return false;
+    // Points are taken on a steady input: the level is averaged over ~16 reads
+    const uint16_t raw = (uint16_t)((gCal.rawLevelQ4() + 8) >> 4);
+    if (!gCal.addPoint(raw, (uint16_t)mv))
+    {
+      Serial.print(F("Already "));
+      Serial.print(AdcCalibration::MAX_POINTS);
+      Serial.println(F(" points; cal=clear to start over"));
+      return true;
     }
-    int16_t v = analogRead(MIC_PIN);
-    buffer[i] = v;
-    int16_t centered = (int16_t)v - (int16_t)gDCOffsetRaw;
-    if (abs(centered) > peak)
-      peak = abs(centered);
   }
+  if (!gCal.save())
+    Serial.println(F("Calibration not saved (no NVS)"));
+  return true;
+}
 
-  // ---- render (erase-then-draw per column, 1px stroke) ----
-  int xcol = 0; // 0..PLOT_W-1
-  for (int i = 1; i < Nsamples && xcol < PLOT_W; ++i)
+// A corner in Hz (12k allowed) for the biquad as type t, or "off"
+bool setBiquad(BiquadType t, const char *v)
+{
+  long hz = 0;
+  if (strcasecmp(v, "off") && !parseUint(v, 1, FS_MAX / 2, hz))
+    return false;
+  if (hz)
   {
-    int y0 = adcToY_raw(buffer[i - 1]);
-    int y1 = adcToY_raw(buffer[i]);
+    gFilter.biquad = t;
+    gFilter.biquadHz = (uint32_t)hz;
+    gFilter.biquadQ = t == BIQUAD_LOWPASS ? 0.7071f : max(gFilter.biquadQ, 1.0f);
+  }
+  else if (gFilter.biquad == t)
+    gFilter.biquad = BIQUAD_OFF;
+  applyFilters();
+  printFilterReport();
+  return true;
+}
+
+const Setting SETTINGS[] = {
+    {"fs", "f", "fs=1000..500000 (or 12k)", [](const char *v)
+     {
+       long hz;
+       if (!parseUint(v, FS_MIN, FS_MAX, hz))
+         return false;
+       setSampleFreq((uint32_t)hz);
+       return true;
+     }},
+    {"px", nullptr, "px=1..10 (px per sample)", [](const char *v)
+     {
+       long n;
+       if (!parseUint(v, PXS_MIN, PXS_MAX, n))
+         return false;
+       setTimebase((uint8_t)n, 1);
+       return true;
+     }},
+    {"spp", nullptr, "spp=1|2|5|10|20|50|100|200|500|1000", [](const char *v)
+     {
+       long n;
+       if (!parseUint(v, 1, SPP_STEPS[SPP_STEP_COUNT - 1], n))
+         return false;
+       for (uint16_t s : SPP_STEPS)
+         if (s == n)
+         {
+           setTimebase(1, s);
+           return true;
+         }
+       return false;
+     }},
+    {"decim", nullptr, "decim=peak|avg", [](const char *v)
+     {
+       const int i = parseName(v, DECIM_NAMES, DECIM_MODE_COUNT);
+       if (i >= 0)
+         setDecimMode((DecimMode)i);
+       return i >= 0;
+     }},
+    {"trig", nullptr, "trig=auto|normal|single", [](const char *v)
+     {
+       const int i = parseName(v, TRIG_MODE_NAMES, TRIG_MODE_COUNT);
+       if (i >= 0)
+         setTriggerMode((TriggerMode)i);
+       return i >= 0;
+     }},
+    {"edge", nullptr, "edge=rising|falling", [](const char *v)
+     {
+       const int i = parseName(v, EDGE_NAMES, 2);
+       if (i >= 0)
+         setTriggerEdge((TriggerEdge)i);
+       return i >= 0;
+     }},
+    {"autoset", nullptr, "autoset (Fs, timebase, vertical scale, trigger level from the input)", [](const char *v)
+     {
+       if (*v)
+         return false;
+       startAutoSet();
+       return true;
+     }},
+    {"vgain", nullptr, "vgain=1|2|4|8|16 (vertical, about the plot's middle)", [](const char *v)
+     {
+       long g;
+       if (!parseUint(v, 1, 1 << VERT_GAIN_MAX, g) || (g & (g - 1)))
+         return false;
+       uint8_t shift = 0;
+       while ((1L << shift) < g)
+         ++shift;
+       setVerticalGain(shift);
+       return true;
+     }},
+    {"level", nullptr, "level=0..3.3 (V)", [](const char *v)
+     {
+       char *end;
+       const float volts = strtof(v, &end);
+       if (end == v || *end || volts < 0.0f || volts * 1000.0f > ADC_FULL_SCALE_MV)
+         return false;
+       setTriggerLevel(mvToCode(lroundf(volts * 1000.0f)));
+       return true;
+     }},
+    {"pre", nullptr, "pre=0..100 (% pre-trigger)", [](const char *v)
+     {
+       long pct;
+       if (!parseUint(v, 0, 100, pct))
+         return false;
+       setPreTrigger((int)pct);
+       return true;
+     }},
+    {"mode", "view", "mode=scope|spectrum|waterfall", [](const char *v)
+     {
+       const int i = parseName(v, VIEW_NAMES, VIEW_COUNT);
+       if (i >= 0)
+         setView((ScopeView)i);
+       return i >= 0;
+     }},
+    {"fft", nullptr, "fft=256|512|1024|2048", [](const char *v)
+     {
+       long n;
+       if (!parseUint(v, FFT_MIN, FFT_MAX, n) || (n & (n - 1)))
+         return false;
+       setFftSize((uint16_t)n);
+       return true;
+     }},
+    {"window", nullptr, "window=hann|blackman|flat-top", [](const char *v)
+     {
+       for (int w = 0; w < WIN_COUNT; ++w)
+         if (!strcasecmp(v, RealFft::windowName((FftWindow)w)))
+         {
+           setFftWindow((FftWindow)w);
+           return true;
+         }
+       return false;
+     }},
+    {"render", nullptr, "render=spans|bands|pixels|phosphor", [](const char *v)
+     {
+       const int i = parseName(v, RENDER_NAMES, RENDER_MODE_COUNT);
+       if (i >= 0)
+         setRenderMode((RenderMode)i);
+       return i >= 0;
+     }},
+    {"ch", nullptr, "ch=a|ab|a-b|xy (channel B on GPIO39: overlay, difference, XY)", [](const char *v)
+     {
+       const int i = parseName(v, TRACE_NAMES, TRACE_MODE_COUNT);
+       if (i >= 0)
+         setTraceMode((TraceMode)i);
+       return i >= 0;
+     }},
+    {"decay", nullptr, "decay=1..6 (persistence: 1 short, 6 long)", [](const char *v)
+     {
+       long shift;
+       if (!parseUint(v, Phosphor::DECAY_MIN, Phosphor::DECAY_MAX, shift))
+         return false;
+       gPhosphor.setDecay((uint8_t)shift);
+       Serial.print(F("Persistence decay: 1/"));
+       Serial.println(1 << shift);
+       return true;
+     }},
+    {"coupling", nullptr, "coupling=ac|dc (ac tracks and removes the DC offset)", [](const char *v)
+     {
+       const int i = parseName(v, COUPLING_NAMES, 2);
+       if (i < 0)
+         return false;
+       gFilter.dcBlock = i;
+       applyFilters();
+       printFilterReport();
+       return true;
+     }},
+    {"lp", nullptr, "lp=<Hz>|off (biquad low-pass)", [](const char *v)
+     { return setBiquad(BIQUAD_LOWPASS, v); }},
+    {"bp", nullptr, "bp=<Hz>|off (biquad band-pass)", [](const char *v)
+     { return setBiquad(BIQUAD_BANDPASS, v); }},
+    {"qf", nullptr, "qf=0.5..20 (biquad Q factor)", [](const char *v)
+     {
+       char *end;
+       const float q = strtof(v, &end);
+       if (end == v || *end || q < 0.5f || q > 20.0f)
+         return false;
+       gFilter.biquadQ = q;
+       applyFilters();
+       printFilterReport();
+       return true;
+     }},
+    {"fir", nullptr, "fir=<Hz>|off (FIR low-pass)", [](const char *v)
+     {
+       long hz = 0;
+       if (strcasecmp(v, "off") && !parseUint(v, 1, FS_MAX / 2, hz))
+         return false;
+       gFilter.firHz = (uint32_t)hz;
+       applyFilters();
+       printFilterReport();
+       return true;
+     }},
+    {"filter", nullptr, "filter (chain, input DC and cost)", [](const char *v)
+     {
+       if (*v)
+         return false;
+       printFilterReport();
+       return true;
+     }},
+    {"clock", nullptr, "clock (measured Fs and jitter)", [](const char *v)
+     {
+       if (*v)
+         return false;
+       printClockReport();
+       return true;
+     }},
+    {"cal", nullptr, "cal | cal=<mV> (input held at mV) | cal=efuse|nominal|clear", [](const char *v)
+     {
+       if (*v && !applyCalibration(v))
+         return false;
+       printCalibration();
+       return true;
+     }},
+    {"pause", nullptr, "pause=on|off", [](const char *v)
+     {
+       const int on = parseSwitch(v);
+       if (on >= 0 && (bool)on != gPaused)
+         togglePause();
+       return on >= 0;
+     }},
+    {"grid", nullptr, "grid=on|off", [](const char *v)
+     {
+       const int on = parseSwitch(v);
+       if (on >= 0)
+         setGrid(on);
+       return on >= 0;
+     }},
+    {"meas", nullptr, "meas=on|off", [](const char *v)
+     {
+       const int on = parseSwitch(v);
+       if (on >= 0)
+         setMeasureShown(on);
+       return on >= 0;
+     }},
+    {"vu", nullptr, "vu=peak|rms", [](const char *v)
+     {
+       const int i = parseName(v, VU_NAMES, VU_MODE_COUNT);
+       if (i >= 0)
+         setVuMode((VuMode)i);
+       return i >= 0;
+     }},
+    {"stream", nullptr, "stream=on|off", [](const char *v)
+     {
+       const int on = parseSwitch(v);
+       if (on >= 0)
+         setStreaming(on);
+       return on >= 0;
+     }},
+    {"baud", nullptr, "baud=9600..", [](const char *v)
+     {
+       long baud;
+       if (!parseUint(v, 9600, 8000000, baud))
+         return false;
+       Serial.print(F("Baud set to "));
+       Serial.println(baud);
+       Serial.flush();
+       Serial.updateBaudRate((unsigned long)baud);
+       return true;
+     }},
+    {"stats", nullptr, "stats | stats=reset", [](const char *v)
+     {
+#if defined(SCOPE_PROFILE)
+       if (!*v)
+         profDump(Serial);
+       else if (!strcasecmp(v, "reset"))
+       {
+         profReset();
+         Serial.println(F("Profiler reset"));
+       }
+       else
+         return false;
+#else
+       (void)v;
+       Serial.println(F("Profiler not built; add -DSCOPE_PROFILE to build_flags"));
+#endif
+       return true;
+     }},
+};
 
-    for (int k = 0; k < pxPerSample && xcol < PLOT_W; ++k, ++xcol)
+void printSettingsHelp()
+{
+  Serial.println(F("Settings (key=value, ';' between commands):"));
+  for (const Setting &s : SETTINGS)
+  {
+    Serial.print(F("  "));
+    Serial.println(s.usage);
+  }
+}
+
+void runCommand(char *text)
+{
+  const Command cmd = splitCommand(text);
+  for (const Setting &s : SETTINGS)
+  {
+    if (!cmd.keyIs(s.key) && !(s.alias && cmd.keyIs(s.alias)))
+      continue;
+    if (!s.apply(cmd.value))
     {
-      int num = k;
-      int den = pxPerSample;
-      int y = y0 + (((y1 - y0) * num + den / 2) / den);
+      Serial.print(F("Bad value. Use: "));
+      Serial.println(s.usage);
+    }
+    return;
+  }
+  if (cmd.keyIs("help") || cmd.keyIs("?"))
+  {
+    printSettingsHelp();
+    return;
+  }
+  if (*cmd.value)
+  {
+    Serial.print(F("Unknown setting. "));
+    printSettingsHelp();
+    return;
+  }
+  for (const char *k = text; *k; ++k) // "pp", "t", "a"
+    handleKey(*k);
+}
 
-      int lastY = gLastY[xcol];
-      if (lastY >= PLOT_Y0 && lastY < (PLOT_Y0 + PLOT_H))
+void handleSerial()
+{
+  PROFILE_SCOPE(PROF_SERIAL);
+  // Only what has already arrived: a partial line waits for the next loop()
+  for (int n = Serial.available(); n > 0; --n)
+  {
+    const char c = (char)Serial.read();
+    if (c && gCmdLine.empty() && strchr(" ,.[]", c)) // strchr() also finds the NUL
+    {
+      handleKey(c);
+      continue;
+    }
+    if (!gCmdLine.push(c))
+      continue;
+    if (gCmdLine.overflowed())
+    {
+      Serial.println(F("Command line too long; ignored"));
+      continue;
+    }
+    char *rest = gCmdLine.line();
+    while (char *text = nextCommand(rest))
+      runCommand(text);
+  }
+}
+
+// -------------------- CAPTURE --------------------
+// Packets go out only when the TX ring has room for them whole, so capture
+// never blocks on the UART; a dropped packet still uses up its sequence
+// number, which is how the receiver counts the loss.
+void streamSamples(const int16_t *s, size_t n, uint32_t fs)
+{
+  for (size_t i = 0; i < n; i += STREAM_MAX_SAMPLES)
+  {
+    const uint16_t k = (uint16_t)min(n - i, (size_t)STREAM_MAX_SAMPLES);
+    const size_t len = gStreamEnc.encode(s + i, k, fs, gStreamFrame);
+    if ((size_t)Serial.availableForWrite() < len)
+    {
+      gStreamDropped = gStreamDropped + 1;
+      continue;
+    }
+    Serial.write(gStreamFrame, len);
+    gStreamSent = gStreamSent + 1;
+  }
+}
+
+// Publishes the source's own timing, when it moved enough to change a label
+// (0.05%), so the axes are not redrawn for every refinement
+void publishMeasuredFs()
+{
+  const uint32_t fs = gSource.sampleRate();
+  const uint32_t hz = (uint32_t)((gSource.measuredRateMilliHz() + 500) / 1000);
+  const uint32_t shown = gMeasuredFsFor == fs ? gMeasuredFsHz : 0;
+  if (hz && shown && (uint32_t)abs((int32_t)(hz - shown)) <= max(1u, hz / 2000))
+    return;
+  gMeasuredFsHz = hz;
+  gMeasuredFsFor = fs; // after the rate: the UI checks this one to trust it
+}
+
+// Every source read goes through here so the record, measurements and stream see all samples.
+// The stream gets them as read; everything else after calibration and filtering.
+// dstB, if given, gets channel B at the same instants, corrected and filtered on its own.
+size_t readSource(int16_t *dst, int16_t *dstB, uint32_t timeoutMs)
+{
+  const size_t got = dstB ? gSource.readPair(dst, dstB, CAPTURE_CHUNK, timeoutMs)
+                          : gSource.read(dst, CAPTURE_CHUNK, timeoutMs);
+  const uint32_t overruns = gSource.overruns();
+  if (overruns != gCap.overruns)
+  {
+    // The source dropped samples before these: nothing carries across the gap
+    gCap.overruns = overruns;
+    gStreamEnc.markDiscontinuity();
+    gCap.meas.restart();
+    gCap.decim.reset();
+    gCap.decimB.reset();
+    gCap.trigger.discardHistory();
+  }
+  if (gStreaming && got)
+    streamSamples(dst, got, gSource.sampleRate()); // raw codes, for offline analysis
+  {
+    PROFILE_SCOPE(PROF_FILTER);
+    gCal.apply(dst, got);
+    gCap.filter.process(dst, got);
+    if (dstB)
+    {
+      gCal.apply(dstB, got, false);
+      gCap.filterB.process(dstB, got);
+    }
+  }
+  gDCOffsetRaw = gCap.filter.outputDC();
+  gDCInputRaw = gCap.filter.inputDC();
+  if (dstB)
+    gDCOffsetRawB = gCap.filterB.outputDC();
+  gRecord.append(dst, got);
+  {
+    PROFILE_SCOPE(PROF_MEASURE);
+    gCap.meas.add(dst, got);
+  }
+  publishMeasuredFs();
+  return got;
+}
+
+// The larger swing from the DC offset over the frame's window (VU peak mode)
+int16_t peakAboutDC(const Measurements &m)
+{
+  if (!m.samples)
+    return 0;
+  const int dc = gDCOffsetRaw;
+  return (int16_t)max(m.max - dc, dc - m.min);
+}
+
+// Spectrum view: one contiguous block of gFftSize samples, untriggered,
+// transformed in place. The FFT runs here so the render core only draws.
+bool captureSpectrum(ScopeFrame &f, uint32_t fs, ScopeView view)
+{
+  const uint16_t n = gFftSize;
+  const FftWindow win = gFftWindow;
+  const uint32_t timeoutMs = (uint32_t)((uint64_t)CAPTURE_CHUNK * 1000UL / fs) + 50;
+  size_t got = 0;
+  while (got < n)
+  {
+    if (gCap.chunkPos == gCap.chunkLen)
+    {
+      gCap.chunkLen = readSource(gCap.chunk, nullptr, timeoutMs);
+      gCap.chunkPos = 0;
+      if (gCap.chunkLen == 0)
+        return false;
+    }
+    const size_t take = min(gCap.chunkLen - gCap.chunkPos, n - got);
+    memcpy(f.samples + got, gCap.chunk + gCap.chunkPos, take * sizeof(int16_t));
+    gCap.chunkPos += take;
+    got += take;
+    if (gView != view || gFftSize != n || gSampleFreqHz != fs || gPaused)
+      return false;
+  }
+
+  {
+    PROFILE_SCOPE(PROF_FFT);
+    gCap.fft.run(f.samples, n, (int16_t)gDCOffsetRaw, win, f.samples);
+  }
+  gFftCycles = gCap.fft.lastCycles();
+
+  f.seq = ++gCap.seq;
+  f.fs = fs;
+  f.view = view;
+  f.traces = gCap.traceMode;
+  f.pxPerSample = pxPerSample;
+  f.samplesPerPx = 1;
+  f.envelope = false;
+  f.count = (uint16_t)(n / 2 + 1); // bins 0..Fs/2
+  f.meas = gCap.meas.take();
+  gFilterCycles = gCap.filter.takeCyclesPerSample();
+  f.triggered = false;
+  f.endSample = gRecord.total() - (uint32_t)(gCap.chunkLen - gCap.chunkPos);
+  return true;
+}
+
+// XY: one contiguous block of XY_POINTS pairs, untriggered like the spectrum
+bool captureXY(ScopeFrame &f, uint32_t fs)
+{
+  const uint32_t timeoutMs = (uint32_t)((uint64_t)CAPTURE_CHUNK * 1000UL / fs) + 50;
+  size_t got = 0;
+  while (got < XY_POINTS)
+  {
+    if (gCap.chunkPos == gCap.chunkLen)
+    {
+      gCap.chunkLen = readSource(gCap.chunk, gCap.chunkB, timeoutMs);
+      gCap.chunkPos = 0;
+      if (gCap.chunkLen == 0)
+        return false;
+    }
+    const size_t take = min(gCap.chunkLen - gCap.chunkPos, XY_POINTS - got);
+    memcpy(f.samples + got, gCap.chunk + gCap.chunkPos, take * sizeof(int16_t));
+    memcpy(f.samplesB + got, gCap.chunkB + gCap.chunkPos, take * sizeof(int16_t));
+    gCap.chunkPos += take;
+    got += take;
+    if (gTraceMode != TRACE_XY || gView != VIEW_SCOPE || gSampleFreqHz != fs || gPaused)
+      return false;
+  }
+
+  f.seq = ++gCap.seq;
+  f.fs = fs;
+  f.view = VIEW_SCOPE;
+  f.traces = TRACE_XY;
+  f.pxPerSample = pxPerSample;
+  f.samplesPerPx = 1;
+  f.envelope = false;
+  f.count = (uint16_t)XY_POINTS;
+  f.meas = gCap.meas.take();
+  gFilterCycles = gCap.filter.takeCyclesPerSample();
+  f.triggered = false;
+  f.endSample = gRecord.total() - (uint32_t)(gCap.chunkLen - gCap.chunkPos);
+  return true;
+}
+
+// A-B in place, re-centred on ADC_MID so no difference sits mid-plot
+void subtractB(int16_t *a, const int16_t *b, size_t n)
+{
+  for (size_t i = 0; i < n; ++i)
+    a[i] = (int16_t)constrain(a[i] - b[i] + ADC_MID, 0, (int)ADC_CODE_MAX);
+}
+
+// Next chunk of trigger input: source samples, or their decimated form when
+// a column covers several samples (which may leave it empty). Channel B is
+// staged alongside in chunkB when it is drawn, or taken off A for A-B.
+// Returns false if the source timed out.
+bool refillChunk(uint32_t timeoutMs)
+{
+  const TraceMode mode = gCap.traceMode;
+  const bool decimated = gCap.spp > 1;
+  int16_t *a = decimated ? gCap.raw : gCap.chunk;
+  int16_t *b = decimated ? gCap.rawB : gCap.chunkB;
+  gCap.chunkPos = 0;
+  const size_t got = readSource(a, mode == TRACE_A ? nullptr : b, timeoutMs);
+  if (mode == TRACE_A_MINUS_B)
+    subtractB(a, b, got);
+  if (!decimated)
+  {
+    gCap.chunkLen = got;
+    return got > 0;
+  }
+  gCap.chunkLen = gCap.decim.process(gCap.raw, got, gCap.chunk);
+  if (mode == TRACE_AB)
+    gCap.decimB.process(gCap.rawB, got, gCap.chunkB); // same input count, so the same outputs
+  return got > 0;
+}
+
+// The source at a new rate: nothing staged or remembered follows on
+void restartSource(uint32_t fs)
+{
+  gSource.setSampleRate(fs);
+  gStreamEnc.markDiscontinuity();
+  gRecord.reset(gSource.sampleRate());
+  gCap.meas.restart();
+  gCap.chunkLen = gCap.chunkPos = 0;
+  gCap.decim.reset();
+  gCap.trigger.discardHistory();
+  gCap.pxs = 0;
+  gCap.filterGen = ~0u; // coefficients follow Fs
+}
+
+// Auto-set's burst, at the top rate for the channels in use, of what the
+// trace would show (A, or A-B). It is read here rather than through
+// readSource(): corrected and filtered, but kept out of the record,
+// measurements and stream, which only ever see the rate on the axis. The
+// source is left at the burst's rate; the next frame finds it off
+// gSampleFreqHz and restarts at whatever the UI picked, marking the gap.
+void surveyForAutoSet()
+{
+  const TraceMode mode = gCap.traceMode;
+  restartSource(mode == TRACE_A ? FS_MAX : FS_MAX / 2);
+  const uint32_t fs = gSource.sampleRate();
+  gCap.filter.configure(gFilter, fs);
+  gCap.filterB.configure(gFilter, fs);
+
+  const uint32_t settle = (uint32_t)((uint64_t)fs * AUTOSET_SETTLE_MS / 1000);
+  const uint32_t want = (uint32_t)((uint64_t)fs * AUTOSET_BURST_MS / 1000);
+  gCap.autoSet.begin(fs, (uint32_t)((uint64_t)fs * AUTOSET_LEVEL_MS / 1000));
+  const uint32_t timeoutMs = (uint32_t)((uint64_t)CAPTURE_CHUNK * 1000UL / fs) + 50;
+  const uint32_t startMs = millis();
+  uint32_t got = 0;
+  while (got < settle + want && (uint32_t)(millis() - startMs) < AUTOSET_BURST_MS + AUTOSET_SETTLE_MS)
+  {
+    int16_t *b = mode == TRACE_A_MINUS_B ? gCap.rawB : nullptr;
+    const size_t n = b ? gSource.readPair(gCap.raw, b, CAPTURE_CHUNK, timeoutMs)
+                       : gSource.read(gCap.raw, CAPTURE_CHUNK, timeoutMs);
+    if (!n)
+      break;
+    gCal.apply(gCap.raw, n, false);
+    gCap.filter.process(gCap.raw, n);
+    if (b)
+    {
+      gCal.apply(b, n, false);
+      gCap.filterB.process(b, n);
+      subtractB(gCap.raw, b, n);
+    }
+    const size_t skip = got < settle ? min((size_t)(settle - got), n) : 0;
+    gCap.autoSet.add(gCap.raw + skip, n - skip);
+    got += (uint32_t)n;
+  }
+  gAutoSetSurvey = gCap.autoSet.result();
+  gAutoSetDone = gCap.autoSetGen; // after the survey: the UI checks this one to trust it
+}
+
+// Streams samples through the trigger engine and fills one frame. Runs on the
+// capture core when there is one, so it only reads the shared settings,
+// never the display. Returns false if no frame completed (yet).
+bool captureFrame(ScopeFrame &f)
+{
+  PROFILE_SCOPE(PROF_CAPTURE);
+  const uint8_t pxs = pxPerSample;
+  const uint16_t spp = gSamplesPerPx;
+  const DecimMode decimMode = gDecimMode;
+  const TraceMode traceMode = gTraceMode;
+  bool restart = gSource.sampleRate() != gSampleFreqHz;
+  if (traceMode != gCap.traceMode)
+  {
+    // B takes a slot in the conversion sequence, which re-clocks the source
+    if (!gSource.setChannelB(traceMode != TRACE_A))
+    {
+      gTraceMode = TRACE_A; // a source with one input
+      return false;
+    }
+    gCap.traceMode = traceMode;
+    gCap.decimB.reset();
+    restart = true;
+  }
+  if (restart)
+    restartSource(gSampleFreqHz);
+  if (gAutoSetGen != gCap.autoSetGen)
+  {
+    gCap.autoSetGen = gAutoSetGen;
+    surveyForAutoSet();
+    return false;
+  }
+  const uint32_t fs = gSource.sampleRate();
+  if (gFilterGen != gCap.filterGen)
+  {
+    gCap.filterGen = gFilterGen;
+    gCap.filter.configure(gFilter, fs);
+    gCap.filterB.configure(gFilter, fs);
+  }
+
+  const ScopeView view = gView;
+  if (view != gCap.view)
+  {
+    // Not contiguous with what the other view consumed
+    gCap.chunkLen = gCap.chunkPos = 0;
+    gCap.decim.reset();
+    gCap.trigger.discardHistory();
+    gCap.view = view;
+  }
+  if (view != VIEW_SCOPE)
+    return captureSpectrum(f, fs, view);
+  if (traceMode == TRACE_XY)
+    return captureXY(f, fs);
+
+  // Decimated frames are one plot wide: a min/max pair or one mean per column
+  const bool envelope = spp > 1 && decimMode == DECIM_PEAK;
+  int Nsamples = (PLOT_W + pxs - 1) / pxs + 1; // +1 for segment end
+  if (spp > 1)
+    Nsamples = envelope ? 2 * PLOT_W : PLOT_W + 1;
+
+  const uint32_t gen = gTrigGen;
+  if (gen != gCap.trigGen || pxs != gCap.pxs || spp != gCap.spp || decimMode != gCap.decimMode)
+  {
+    if (spp != gCap.spp || decimMode != gCap.decimMode)
+    {
+      // Staged values and history are in the old units
+      gCap.chunkLen = gCap.chunkPos = 0;
+      gCap.trigger.discardHistory();
+      gCap.decim.configure(spp, decimMode);
+      gCap.decimB.configure(spp, decimMode);
+    }
+    // The trigger counts its auto timeout in the values it is fed
+    const uint32_t rate = spp > 1 ? fs * gCap.decim.outputsPerGroup() / spp : fs;
+    TriggerSettings ts = gTrig;
+    gCap.trigger.configure(ts, (uint16_t)Nsamples, rate);
+    gCap.trigGen = gen;
+    gCap.pxs = pxs;
+    gCap.spp = spp;
+    gCap.decimMode = decimMode;
+  }
+  if (gCap.trigger.holding())
+  {
+    gCap.held = true;
+    return false; // single shot taken; wait for re-arm
+  }
+  if (gCap.held)
+  {
+    gRecord.reset(fs); // the source overran while we held
+    gCap.held = false;
+  }
+
+  const uint32_t timeoutMs = (uint32_t)((uint64_t)CAPTURE_CHUNK * 1000UL / fs) + 50;
+  const uint32_t startMs = millis();
+  for (;;)
+  {
+    if (gCap.chunkPos == gCap.chunkLen && !refillChunk(timeoutMs))
+      return false;
+    size_t used = 0;
+    const int16_t *b = traceMode == TRACE_AB ? gCap.chunkB + gCap.chunkPos : nullptr;
+    bool done = gCap.trigger.feed(gCap.chunk + gCap.chunkPos, gCap.chunkLen - gCap.chunkPos, &used, b);
+    gCap.chunkPos += used;
+    if (done)
+      break;
+    if (gTrigGen != gen || pxPerSample != pxs || gSamplesPerPx != spp || gDecimMode != decimMode ||
+        gSampleFreqHz != fs || gView != view || gTraceMode != traceMode || gPaused ||
+        gAutoSetGen != gCap.autoSetGen || (uint32_t)(millis() - startMs) >= CAPTURE_MAX_WAIT_MS)
+      return false;
+  }
+  gCap.trigger.extract(f.samples, traceMode == TRACE_AB ? f.samplesB : nullptr);
+
+  f.seq = ++gCap.seq;
+  f.fs = fs;
+  f.view = VIEW_SCOPE;
+  f.traces = traceMode;
+  f.pxPerSample = pxs;
+  f.samplesPerPx = spp;
+  f.envelope = envelope;
+  f.count = (uint16_t)Nsamples;
+  f.meas = gCap.meas.take();
+  gFilterCycles = gCap.filter.takeCyclesPerSample();
+  f.triggered = gCap.trigger.lastWasTriggered();
+  // Staged values not yet fed stand for whole groups of spp samples, after
+  // any partial group still in the decimator
+  uint32_t unfed = (uint32_t)(gCap.chunkLen - gCap.chunkPos);
+  if (spp > 1)
+    unfed = gCap.decim.pending() + (unfed + gCap.decim.outputsPerGroup() - 1) / gCap.decim.outputsPerGroup() * spp;
+  f.endSample = gRecord.total() - unfed;
+  return true;
+}
+
+// Drops buffered samples and trigger history (after a gap in the stream).
+void restartCapture()
+{
+  gSource.flush();
+  gStreamEnc.markDiscontinuity();
+  gCap.meas.restart();
+  gCap.chunkLen = gCap.chunkPos = 0;
+  gCap.decim.reset();
+  gCap.decimB.reset();
+  gCap.trigger.discardHistory();
+}
+
+#if SCOPE_DUAL_CORE
+void captureTask(void *)
+{
+  bool wasPaused = false;
+  for (;;)
+  {
+    if (gPaused)
+    {
+      wasPaused = true;
+      vTaskDelay(pdMS_TO_TICKS(5));
+      continue;
+    }
+    if (wasPaused)
+    {
+      restartCapture(); // don't resume with samples from before the pause
+      wasPaused = false;
+    }
+    if (captureFrame(gFrames.writeFrame()))
+      gFrames.push();
+    else
+      vTaskDelay(1); // holding a single shot, or the source timed out
+  }
+}
+#endif
+
+// -------------------- RENDER --------------------
+void noteRenderStats(uint32_t bytes, uint32_t pixels)
+{
+  if (!gShowRenderStats)
+    return;
+  gStatFrames++;
+  gStatBytes += bytes;
+  gStatPixels += pixels;
+  uint32_t elapsed = millis() - gStatStartMs;
+  if (elapsed < 1000)
+    return;
+
+  if (gView == VIEW_WATERFALL)
+    Serial.print(F("[waterfall] "));
+  else if (gRenderMode == RENDER_SPANS)
+    Serial.print(F("[spans] "));
+  else if (gRenderMode == RENDER_BANDS)
+    Serial.print(F("[bands] "));
+  else if (gRenderMode == RENDER_PIXELS)
+    Serial.print(F("[pixels] "));
+  else
+    Serial.print(F("[phosphor] "));
+  Serial.print(gStatFrames * 1000.0f / elapsed, 1);
+  Serial.print(F(" fps, "));
+  Serial.print(gStatBytes / gStatFrames);
+  Serial.print(F(" SPI bytes/frame, "));
+  Serial.print(gStatPixels / gStatFrames);
+  Serial.print(F(" px/frame, "));
+  Serial.print(gStatBytes / 1024.0f * 1000.0f / elapsed, 1);
+  Serial.println(F(" kB/s"));
+  if (gView != VIEW_SCOPE)
+  {
+    // Budget: the time it takes to acquire the next block
+    const uint32_t cycles = gFftCycles;
+    const uint32_t budget = (uint32_t)((uint64_t)gFftSize * cpuHz() / gSampleFreqHz);
+    Serial.print(F("  FFT "));
+    Serial.print(gFftSize);
+    Serial.print(F(": "));
+    Serial.print(cycles);
+    Serial.print(F(" cycles ("));
+    Serial.print(cycles / (cpuHz() / 1000000UL));
+    Serial.print(F(" us), "));
+    Serial.print(100.0f * cycles / budget, 1);
+    Serial.println(F("% of the block time"));
+  }
+  gStatFrames = gStatBytes = gStatPixels = 0;
+  gStatStartMs = millis();
+}
+
+// Spectrum view: each column is a bar down from the loudest bin it covers.
+void spectrumToSpans(const int16_t *db, int bins, int16_t *top, int16_t *bot)
+{
+  for (int x = 0; x < PLOT_W; ++x)
+  {
+    top[x] = (int16_t)dbToY(fftPeakAt(db, bins, x, PLOT_W));
+    bot[x] = PLOT_Y0 + PLOT_H - 1;
+  }
+}
+
+// Scope frame samples -> column spans, as polyline or envelope
+void samplesToTrace(const ScopeFrame &f, const int16_t *samples, int16_t *top, int16_t *bot)
+{
+  static int16_t ys[2 * PLOT_W];
+  const int n = f.count;
+  for (int i = 0; i < n; ++i)
+    ys[i] = (int16_t)adcToY_raw(samples[i]);
+  if (f.envelope)
+    envelopeToSpans(ys, n / 2, top, bot);
+  else
+    samplesToSpans(ys, n, f.pxPerSample, top, bot);
+}
+
+// XY: each pair is one point, A across and B up, with persistence so the
+// figure builds up over frames like a beam's
+void renderXY(const ScopeFrame &f)
+{
+  static int16_t xs[XY_POINTS], ys[XY_POINTS];
+  {
+    PROFILE_SCOPE(PROF_MAP);
+    for (int i = 0; i < f.count; ++i)
+    {
+      xs[i] = (int16_t)adcToX_xy(f.samples[i]);
+      ys[i] = (int16_t)adcToY_raw(f.samplesB[i]);
+    }
+  }
+  PROFILE_SCOPE(PROF_DRAW);
+  gPhosphor.decay();
+  gPhosphor.addPoints(xs, ys, f.count);
+  gBands.drawPhosphor(tft, gPhosphor, gPlotBg);
+}
+
+void renderFrame(const ScopeFrame &f)
+{
+  const int16_t *buffer = f.samples;
+  const int Nsamples = f.count;
+  const uint8_t pxs = f.pxPerSample;
+
+  // ---- render ----
+  uint32_t bytes, pixels = 0;
+  if (f.view == VIEW_SCOPE && f.traces == TRACE_XY)
+  {
+    renderXY(f);
+    bytes = gBands.lastFrame().bytes;
+    pixels = gBands.lastFrame().pixels;
+  }
+  else if (f.view == VIEW_WATERFALL)
+  {
+    PROFILE_SCOPE(PROF_DRAW);
+    gWaterfall.pushLine(tft, buffer, Nsamples, SPEC_DB_RANGE);
+    bytes = gWaterfall.lastFrame().bytes;
+    pixels = gWaterfall.lastFrame().pixels;
+  }
+  else if (gRenderMode != RENDER_PIXELS || f.view == VIEW_SPECTRUM || f.envelope ||
+           f.traces == TRACE_AB) // per-pixel is one polyline only
+  {
+    static int16_t top[PLOT_W], bot[PLOT_W];
+    static int16_t topB[PLOT_W], botB[PLOT_W];
+    const bool withB = f.view == VIEW_SCOPE && f.traces == TRACE_AB;
+    if (f.view == VIEW_SPECTRUM)
+    {
+      PROFILE_SCOPE(PROF_MAP);
+      spectrumToSpans(buffer, Nsamples, top, bot);
+    }
+    else
+    {
+      PROFILE_SCOPE(PROF_MAP);
+      samplesToTrace(f, buffer, top, bot);
+      if (withB)
+        samplesToTrace(f, f.samplesB, topB, botB);
+    }
+    // A over B where they cross
+    const TraceSpans traces[2] = {{top, bot, COL_TRACE}, {topB, botB, COL_TRACE_B}};
+    const int traceCount = withB ? 2 : 1;
+
+    // A paused record view is one trace, not a history
+    const RenderMode mode = (gRenderMode == RENDER_PHOSPHOR && gPaused) ? RENDER_BANDS : gRenderMode;
+    const SpiStats &st = (mode == RENDER_BANDS || mode == RENDER_PHOSPHOR) ? gBands.lastFrame() : gTrace.lastFrame();
+    {
+      PROFILE_SCOPE(PROF_DRAW);
+      if (mode == RENDER_PHOSPHOR)
       {
-        tft.drawPixel(PLOT_X0 + xcol, lastY, COL_BG);
+        gPhosphor.decay();
+        for (int t = 0; t < traceCount; ++t)
+          gPhosphor.addSpans(traces[t].top, traces[t].bot);
+        gBands.drawPhosphor(tft, gPhosphor, gPlotBg);
       }
+      else if (mode == RENDER_BANDS)
+        gBands.draw(tft, traces, traceCount, gPlotBg);
+      else
+        gTrace.draw(tft, traces, traceCount, gPlotBg);
+    }
+    bytes = st.bytes;
+    pixels = st.pixels;
+  }
+  else
+  {
+    // erase-then-draw per column, 1px stroke, one address window per pixel
+    // (mapping is interleaved with the pushes, so it all counts as draw)
+    PROFILE_SCOPE(PROF_DRAW);
+    if (gPlotBg.changed())
+      clearPlotAndHistory(); // no row repaint here: start over on the new background
+    int xcol = 0; // 0..PLOT_W-1
+    for (int i = 1; i < Nsamples && xcol < PLOT_W; ++i)
+    {
+      int y0 = adcToY_raw(buffer[i - 1]);
+      int y1 = adcToY_raw(buffer[i]);
 
-      if (y >= PLOT_Y0 && y < PLOT_Y0 + PLOT_H)
+      for (int k = 0; k < pxs && xcol < PLOT_W; ++k, ++xcol)
       {
-        tft.drawPixel(PLOT_X0 + xcol, y, COL_TRACE);
-        gLastY[xcol] = y;
+        int num = k;
+        int den = pxs;
+        int y = y0 + (((y1 - y0) * num + den / 2) / den);
+
+        int lastY = gLastY[xcol];
+        if (lastY >= PLOT_Y0 && lastY < (PLOT_Y0 + PLOT_H))
+        {
+          tft.drawPixel(PLOT_X0 + xcol, lastY, gPlotBg.at(xcol, lastY));
+          ++pixels;
+        }
+
+        if (y >= PLOT_Y0 && y < PLOT_Y0 + PLOT_H)
+        {
+          tft.drawPixel(PLOT_X0 + xcol, y, COL_TRACE);
+          ++pixels;
+          gLastY[xcol] = y;
+        }
+        else
+        {
+          gLastY[xcol] = -1;
+        }
       }
-      else
+    }
+    bytes = pixels * (SPI_WINDOW_BYTES + SPI_PIXEL_BYTES);
+  }
+  noteRenderStats(bytes, pixels);
+}
+
+// Meter from a frame's measurements, advanced by the wall-clock time since
+// the last frame (so a slow frame does not slow the meter down)
+void updateVU(const Measurements &m)
+{
+  PROFILE_SCOPE(PROF_VU);
+  static uint32_t lastUs = micros();
+  const uint32_t now = micros();
+  const float level = gVu.mode() == VU_PEAK ? (float)peakAboutDC(m) : m.rmsQ8 * (1.41421356f / 256.0f);
+  gVuLeds.write(gVu.update(level, now - lastUs));
+  lastUs = now;
+}
+
+// Paused scope view: the slice of the record in view, decimated as live
+// frames would be, drawn over a clean plot
+void renderRecordView()
+{
+  static ScopeFrame f;
+  gRecordDirty = false;
+  const uint16_t spp = gSamplesPerPx;
+  const bool envelope = spp > 1 && gDecimMode == DECIM_PEAK;
+  size_t n = 0;
+  MeasureAccumulator meas;
+  if (browsingRecord())
+  {
+    const size_t span = recordSpan();
+    if (spp <= 1)
+    {
+      n = gRecord.copy(gRecordPos, span, f.samples);
+      meas.add(f.samples, n);
+    }
+    else
+    {
+      Decimator decim;
+      decim.configure(spp, gDecimMode);
+      int16_t raw[CAPTURE_CHUNK];
+      for (size_t done = 0; done < span;)
       {
-        gLastY[xcol] = -1;
+        const size_t got = gRecord.copy(gRecordPos + done, min(span - done, CAPTURE_CHUNK), raw);
+        if (!got)
+          break;
+        meas.add(raw, got);
+        n += decim.process(raw, got, f.samples + n);
+        done += got;
       }
+      if (envelope)
+        n &= ~(size_t)1;
     }
   }
 
-  // ---- 6-level VU from peak amplitude ----
-  // Simple thresholds tuned for 12-bit ADC, scale down to 6 steps
-  // (feel free to tweak empirically)
-  uint8_t level = 0;
-  if (peak > 768)
-    level = 6;
-  else if (peak > 640)
-    level = 5;
-  else if (peak > 512)
-    level = 4;
-  else if (peak > 384)
-    level = 3;
-  else if (peak > 256)
-    level = 2;
-  else if (peak > 128)
-    level = 1;
-  else
-    level = 0;
-  setVU(level);
+  f.meas = meas.take();
+  f.fs = gSampleFreqHz;
+  f.view = VIEW_SCOPE;
+  f.traces = TRACE_A; // the record holds channel A only
+  f.pxPerSample = pxPerSample;
+  f.samplesPerPx = spp;
+  f.envelope = envelope;
+  f.count = (uint16_t)n;
+  f.triggered = false;
+
+  clearPlotAndHistory();
+  if (n > 1)
+    renderFrame(f);
+  drawBottomBannerHUD();
+  showMeasurements(f.meas, axisFs()); // of the samples in view
+}
+
+// -------------------- SETUP / LOOP --------------------
+void setup()
+{
+#if defined(ARDUINO_ARCH_ESP32)
+  Serial.setTxBufferSize(STREAM_TX_BUFFER);
+#endif
+  Serial.begin(115200);
+  Serial.println(F("Commands end with Enter; ';' separates several, e.g. fs=20000; px=4; trig=normal (help lists all)"));
+  Serial.println(F("Keys: p/P timebase | d peak/avg | v measurements | u VU peak/RMS | g grid toggle | q frame stats | r renderer | i fps/SPI"));
+  Serial.println(F("Filters: coupling=ac|dc | lp=3000 | bp=1000; qf=5 | fir=8000 | filter (cost report)"));
+  Serial.println(F("Calibration: cal (table) | cal=1000 with 1.000 V on the input | cal=efuse | cal=clear | clock (measured Fs)"));
+  Serial.println(F("Stream: baud=2000000 | stream=on | stream=off (binary, see SampleStream.h)"));
+  Serial.println(F("At once, on an empty line: <space> pause | ,/. pan | [/] pre-trigger"));
+  Serial.println(F("Paused: p/P or Px buttons zoom | ,/. or Fs buttons pan the record"));
+  Serial.println(F("Trigger: t mode | e edge | l/L level | [/] pre-trigger | a re-arm single"));
+  Serial.println(F("Spectrum: m scope/spectrum/waterfall | n FFT size | w window"));
+  Serial.println(F("Channels: ch=a | ch=ab overlay | ch=a-b | ch=xy (B on GPIO39; Fs up to 250 kHz)"));
+  Serial.println(F("Buttons: Fs-:12 Fs+:13 Px-:15 Px+:2 (hold to repeat) Pause:0 (hold for auto-set) Trig:4 (hold to re-arm)"));
+  Serial.println(F("VU pins: 25,26,32,33,2,4 (34/35 are input-only on ESP32)"));
+
+  pinMode(MIC_PIN, INPUT);
+  gCal.begin(SOURCE_IS_ADC);
+#if defined(ARDUINO_ARCH_ESP32) && defined(SCOPE_SYNTH_SOURCE)
+  gAdcSource.setRealtime(true);
+#endif
+  if (!gSource.begin(gSampleFreqHz))
+    Serial.println(F("Sample source failed to start"));
+
+  // Buttons with internal pull-ups, on edge interrupts
+  gButtons.begin(BUTTONS, BUTTON_COUNT);
+
+  // VU LEDs
+  initVU();
+  setVU(0);
+
+  VUdance();
+
+  tft.begin(ScopeDisplay::SPI_HZ);
+  tft.setRotation(1);
+  tft.fillScreen(COL_BG);
+  initLabels();
+
+  drawTopBanner();
+  drawYAxisScale();
+  drawBottomBannerHUD(); // your order: banner first
+  drawXAxisScale();
+
+  clearPlotAndHistory();
+
+  if (!gPhosphor.allocate())
+    Serial.println(F("No memory for the persistence image"));
+
+  // Deep memory from whatever the drivers, sprites and frames left over
+  const size_t depth = gRecord.allocate(RECORD_MAX_SAMPLES, RECORD_KEEP_FREE);
+  gRecord.reset(gSource.sampleRate());
+  Serial.print(F("Record depth: "));
+  Serial.print(depth);
+  Serial.print(F(" samples ("));
+  Serial.print((float)depth / gSampleFreqHz, 2);
+  Serial.println(F(" s at this Fs)"));
+
+#if SCOPE_DUAL_CORE
+  xTaskCreatePinnedToCore(captureTask, "capture", 4096, nullptr, CAPTURE_PRIORITY, &gCaptureTask, CAPTURE_CORE);
+#endif
+}
+
+void loop()
+{
+  PROFILE_SCOPE(PROF_LOOP);
+  handleSerial();
+  handleButtons();
+
+  if (gPaused)
+  {
+    if (gRecordDirty && gView == VIEW_SCOPE)
+      renderRecordView();
+    delay(5);
+    return;
+  }
+
+#if !SCOPE_DUAL_CORE
+  // Nothing captures while we draw. Capture carries on from where it stopped,
+  // so the trigger keeps its history and a single shot its hold; if drawing
+  // outlasted the source's buffers, readSource() sees the overrun and starts
+  // over after the gap.
+  if (captureFrame(gFrames.writeFrame()))
+    gFrames.push();
+#endif
+  followAutoSet();
+
+  const ScopeFrame *f = gFrames.pop();
+  if (!f)
+  {
+#if SCOPE_DUAL_CORE
+    delay(1);
+#endif
+    return;
+  }
+  // Frames captured before a settings change would be drawn against the wrong axis.
+  if (f->fs != gSampleFreqHz || f->view != gView || f->traces != gTraceMode)
+    return;
+  if (f->view == VIEW_SCOPE ? f->traces != TRACE_XY &&
+                                  (f->pxPerSample != pxPerSample || f->samplesPerPx != gSamplesPerPx ||
+                                   f->envelope != (gSamplesPerPx > 1 && gDecimMode == DECIM_PEAK))
+                             : f->count != gFftSize / 2 + 1)
+    return;
+
+  renderFrame(*f);
+  followDC();
+  followFs();
+  updateVU(f->meas);
+  showMeasurements(f->meas, axisFs());
+  gLastFrameEnd = f->endSample;
 }
 // ==================== end main.cpp ====================
@@ -0,0 +1,113 @@
+// ==================== test_command_line (serial command lines) ====================
+// pio test -e native -f test_command_line
+#include <Arduino.h>
+#include <unity.h>
+#include <string.h>
+#include "CommandLine.h"
+
+void setUp() {}
+void tearDown() {}
+
+namespace
+{
+// Pushes text; returns how many lines it completed
+int type(CommandLine &cl, const char *text, size_t len = 0)
+{
+  if (!len)
+    len = strlen(text);
+  int lines = 0;
+  for (size_t i = 0; i < len; ++i)
+    lines += cl.push(text[i]);
+  return lines;
+}
+
+void expectCommand(char *cmd, const char *key, const char *value)
+{
+  TEST_ASSERT_NOT_NULL(cmd);
+  const Command c = splitCommand(cmd);
+  TEST_ASSERT_EQUAL(strlen(key), c.keyLen);
+  TEST_ASSERT_EQUAL_STRING_LEN(key, c.key, c.keyLen);
+  TEST_ASSERT_EQUAL_STRING(value, c.value);
+}
+} // namespace
+
+// -------------------- line assembly --------------------
+void test_line_ends_at_cr_or_lf()
+{
+  CommandLine cl;
+  TEST_ASSERT_EQUAL(0, type(cl, "fs=2000"));
+  TEST_ASSERT_FALSE(cl.empty());
+  TEST_ASSERT_EQUAL(1, type(cl, "0\r"));
+  TEST_ASSERT_EQUAL_STRING("fs=20000", cl.line());
+  TEST_ASSERT_TRUE(cl.empty());
+  TEST_ASSERT_EQUAL(0, type(cl, "\n")); // the LF of a CRLF is a blank line
+  TEST_ASSERT_EQUAL(1, type(cl, "q\n"));
+  TEST_ASSERT_EQUAL_STRING("q", cl.line());
+}
+
+void test_backspace_and_nul()
+{
+  CommandLine cl;
+  const char keys[] = {'p', 'x', '=', '3', '\b', '4', 0x7F, '5', 0, '\r'};
+  TEST_ASSERT_EQUAL(1, type(cl, keys, sizeof(keys)));
+  TEST_ASSERT_EQUAL_STRING("px=5", cl.line());
+}
+
+void test_overflow_is_cut_and_flagged()
+{
+  CommandLine cl;
+  char longLine[CommandLine::MAX_LEN + 20];
+  memset(longLine, 'a', sizeof(longLine));
+  TEST_ASSERT_EQUAL(0, type(cl, longLine, sizeof(longLine)));
+  TEST_ASSERT_EQUAL(1, type(cl, "\n"));
+  TEST_ASSERT_TRUE(cl.overflowed());
+  TEST_ASSERT_EQUAL(CommandLine::MAX_LEN, strlen(cl.line()));
+  TEST_ASSERT_EQUAL(1, type(cl, "q\n"));
+  TEST_ASSERT_FALSE(cl.overflowed());
+}
+
+// -------------------- splitting --------------------
+void test_split_commands()
+{
+  char line[] = " fs=20000; px 4 ;;trig = normal ;  help";
+  char *s = line;
+  expectCommand(nextCommand(s), "fs", "20000");
+  expectCommand(nextCommand(s), "px", "4");
+  expectCommand(nextCommand(s), "trig", "normal");
+  expectCommand(nextCommand(s), "help", "");
+  TEST_ASSERT_NULL(nextCommand(s));
+}
+
+// The old forms: a number straight after the letters, "key value"
+void test_split_legacy_forms()
+{
+  char a[] = "f8000";
+  expectCommand(a, "f", "8000");
+  char b[] = "baud 2000000";
+  expectCommand(b, "baud", "2000000");
+  char c[] = "stream on";
+  expectCommand(c, "stream", "on");
+  char d[] = "ppP";
+  expectCommand(d, "ppP", "");
+}
+
+void test_key_is_case_insensitive()
+{
+  char cmd[] = "FS=1000";
+  const Command c = splitCommand(cmd);
+  TEST_ASSERT_TRUE(c.keyIs("fs"));
+  TEST_ASSERT_FALSE(c.keyIs("f"));
+  TEST_ASSERT_FALSE(c.keyIs("fsx"));
+}
+
+int main(int argc, char **argv)
+{
+  UNITY_BEGIN();
+  RUN_TEST(test_line_ends_at_cr_or_lf);
+  RUN_TEST(test_backspace_and_nul);
+  RUN_TEST(test_overflow_is_cut_and_flagged);
+  RUN_TEST(test_split_commands);
+  RUN_TEST(test_split_legacy_forms);
+  RUN_TEST(test_key_is_case_insensitive);
+  return UNITY_END();
+}
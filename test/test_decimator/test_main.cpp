@@ -0,0 +1,99 @@
+// ==================== test_decimator (many samples per plot column) ====================
+// pio test -e native -f test_decimator
+#include <Arduino.h>
+#include <unity.h>
+#include "Decimator.h"
+
+void setUp() {}
+void tearDown() {}
+
+// -------------------- peak --------------------
+// Each group gives its min and max in the order they occurred
+void test_peak_keeps_time_order()
+{
+  Decimator d;
+  d.configure(4, DECIM_PEAK);
+  TEST_ASSERT_EQUAL(2, d.outputsPerGroup());
+  const int16_t in[] = {0, 10, -5, 3, /**/ 7, -2, 1, 9};
+  int16_t out[8];
+  TEST_ASSERT_EQUAL(4, d.process(in, 8, out));
+  const int16_t expect[] = {10, -5, -2, 9}; // falling, then rising
+  TEST_ASSERT_EQUAL_INT16_ARRAY(expect, out, 4);
+}
+
+// A one-sample glitch still reaches its column
+void test_peak_keeps_glitch()
+{
+  Decimator d;
+  d.configure(100, DECIM_PEAK);
+  int16_t in[100];
+  for (int16_t &v : in)
+    v = 2048;
+  in[63] = 4000;
+  int16_t out[2];
+  TEST_ASSERT_EQUAL(2, d.process(in, 100, out));
+  TEST_ASSERT_EQUAL(2048, out[0]);
+  TEST_ASSERT_EQUAL(4000, out[1]);
+}
+
+// Groups straddle process() calls and come out the same
+void test_peak_group_straddles_calls()
+{
+  int16_t in[60];
+  for (int i = 0; i < 60; ++i)
+    in[i] = (int16_t)((i * 37) % 101);
+
+  Decimator whole, split;
+  whole.configure(6, DECIM_PEAK);
+  split.configure(6, DECIM_PEAK);
+  int16_t a[20], b[20];
+  TEST_ASSERT_EQUAL(20, whole.process(in, 60, a));
+  size_t got = 0;
+  for (size_t at = 0; at < 60; at += 7)
+  {
+    const size_t n = at + 7 <= 60 ? 7 : 60 - at;
+    got += split.process(in + at, n, b + got);
+  }
+  TEST_ASSERT_EQUAL(20, got);
+  TEST_ASSERT_EQUAL(0, split.pending());
+  TEST_ASSERT_EQUAL_INT16_ARRAY(a, b, 20);
+}
+
+// -------------------- average --------------------
+void test_average_rounds_the_mean()
+{
+  Decimator d;
+  d.configure(4, DECIM_AVERAGE);
+  TEST_ASSERT_EQUAL(1, d.outputsPerGroup());
+  const int16_t in[] = {100, 101, 102, 104, /**/ 2000, 2000, 2001, 2001};
+  int16_t out[2];
+  TEST_ASSERT_EQUAL(2, d.process(in, 8, out));
+  TEST_ASSERT_EQUAL(102, out[0]);  // 101.75
+  TEST_ASSERT_EQUAL(2001, out[1]); // 2000.5 rounds up
+}
+
+// reset() drops a partly accumulated group
+void test_reset_drops_partial_group()
+{
+  Decimator d;
+  d.configure(4, DECIM_AVERAGE);
+  const int16_t stale[] = {4000, 4000, 4000};
+  int16_t out[2];
+  TEST_ASSERT_EQUAL(0, d.process(stale, 3, out));
+  TEST_ASSERT_EQUAL(3, d.pending());
+  d.reset();
+  const int16_t fresh[] = {10, 10, 10, 10};
+  TEST_ASSERT_EQUAL(1, d.process(fresh, 4, out));
+  TEST_ASSERT_EQUAL(10, out[0]);
+}
+
+int main(int argc, char **argv)
+{
+  UNITY_BEGIN();
+  RUN_TEST(test_peak_keeps_time_order);
+  RUN_TEST(test_peak_keeps_glitch);
+  RUN_TEST(test_peak_group_straddles_calls);
+  RUN_TEST(test_average_rounds_the_mean);
+  RUN_TEST(test_reset_drops_partial_group);
+  return UNITY_END();
+}
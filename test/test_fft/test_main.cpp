@@ -0,0 +1,139 @@
+// ==================== test_fft (fixed-point real FFT) ====================
+// pio test -e native -f test_fft
+#include <Arduino.h>
+#include <unity.h>
+#include <math.h>
+#include "Fft.h"
+
+void setUp() {}
+void tearDown() {}
+
+namespace
+{
+RealFft gFft;
+int16_t gIn[FFT_MAX];
+int16_t gDb[FFT_MAX / 2 + 1];
+
+// n samples of a sine at `bin` bins (may be fractional) about mid-scale
+void sine(int n, double bin, double amp)
+{
+  for (int i = 0; i < n; ++i)
+    gIn[i] = (int16_t)lround(2048 + amp * sin(2 * M_PI * bin * i / n));
+}
+
+int loudestBin(int n)
+{
+  int pk = 0;
+  for (int k = 1; k <= n / 2; ++k)
+    if (gDb[k] > gDb[pk])
+      pk = k;
+  return pk;
+}
+
+// Loudest bin further than `guard` bins from `bin`, in 0.1 dB
+int16_t loudestAwayFrom(int n, int bin, int guard)
+{
+  int16_t far = FFT_DB_FLOOR;
+  for (int k = 0; k <= n / 2; ++k)
+    if (abs(k - bin) > guard && gDb[k] > far)
+      far = gDb[k];
+  return far;
+}
+
+// Level of bin k in 0.1 dB from a plain double DFT of the Blackman-windowed
+// samples, relative to a full-scale sine on a bin
+int refBlackmanDb(int n, int k, int16_t dc)
+{
+  double re = 0, im = 0;
+  for (int i = 0; i < n; ++i)
+  {
+    const double a = 2 * M_PI * i / n;
+    const double v = (gIn[i] - dc) * (0.42 - 0.5 * cos(a) + 0.08 * cos(2 * a));
+    re += v * cos(a * k);
+    im -= v * sin(a * k);
+  }
+  return (int)lround(100 * log10((re * re + im * im) / pow(1024.0 * n * 0.42, 2)));
+}
+} // namespace
+
+// A full-scale sine on a bin reads 0 dB in that bin for every size and
+// window, with everything away from it down in the noise
+void test_full_scale_sine_per_window()
+{
+  for (int n : {FFT_MIN, 1024, FFT_MAX})
+  {
+    for (int w = 0; w < WIN_COUNT; ++w)
+    {
+      sine(n, n / 8, 2047);
+      gFft.run(gIn, n, 2048, (FftWindow)w, gDb);
+      char what[48];
+      snprintf(what, sizeof(what), "n %d, %s", n, RealFft::windowName((FftWindow)w));
+      TEST_ASSERT_EQUAL_INT_MESSAGE(n / 8, loudestBin(n), what);
+      TEST_ASSERT_INT_WITHIN_MESSAGE(3, 0, gDb[n / 8], what); // within 0.3 dB
+      TEST_ASSERT_LESS_THAN_INT(-600, loudestAwayFrom(n, n / 8, 8));
+    }
+  }
+}
+
+// Levels are relative: a sine a tenth of full scale reads -20 dB
+void test_level_is_relative_to_full_scale()
+{
+  for (int w = 0; w < WIN_COUNT; ++w)
+  {
+    sine(1024, 128, 204.8);
+    gFft.run(gIn, 1024, 2048, (FftWindow)w, gDb);
+    TEST_ASSERT_INT_WITHIN(3, -200, gDb[128]);
+  }
+}
+
+// Flat-top keeps the level of a sine that falls between bins
+void test_flat_top_between_bins()
+{
+  sine(1024, 100.37, 1000);
+  gFft.run(gIn, 1024, 2048, WIN_FLATTOP, gDb);
+  TEST_ASSERT_EQUAL(100, loudestBin(1024));
+  TEST_ASSERT_INT_WITHIN(2, (int)lround(200 * log10(1000 / 2048.0)), gDb[100]);
+}
+
+// Full scale near Fs/2 or DC with Blackman, where a bin's real and imaginary
+// parts pass 2^15 and their squares do not fit an int32_t: the peak bin still
+// reads what a double-precision DFT says. Near Fs/2 the sine's image lands in
+// the same bins, so that can be above 0 dB.
+void test_full_scale_near_band_edges()
+{
+  for (int n : {FFT_MIN, 512, FFT_MAX})
+  {
+    for (double bin : {n / 2 - 0.5, n / 2 - 0.44, 2.48})
+    {
+      sine(n, bin, 2047);
+      gFft.run(gIn, n, 2048, WIN_BLACKMAN, gDb);
+      char what[48];
+      snprintf(what, sizeof(what), "n %d, bin %.2f", n, bin);
+      const int pk = loudestBin(n);
+      TEST_ASSERT_INT_WITHIN_MESSAGE(1, (int)bin, pk, what);
+      TEST_ASSERT_INT_WITHIN_MESSAGE(3, refBlackmanDb(n, pk, 2048), gDb[pk], what);
+    }
+  }
+}
+
+// The dc given is taken out before the transform
+void test_dc_removed()
+{
+  sine(1024, 64, 500);
+  for (int i = 0; i < 1024; ++i)
+    gIn[i] = (int16_t)(gIn[i] + 700); // centred on 2748
+  gFft.run(gIn, 1024, 2748, WIN_HANN, gDb);
+  TEST_ASSERT_EQUAL(64, loudestBin(1024));
+  TEST_ASSERT_LESS_THAN_INT(-600, gDb[0]);
+}
+
+int main(int argc, char **argv)
+{
+  UNITY_BEGIN();
+  RUN_TEST(test_full_scale_sine_per_window);
+  RUN_TEST(test_level_is_relative_to_full_scale);
+  RUN_TEST(test_flat_top_between_bins);
+  RUN_TEST(test_full_scale_near_band_edges);
+  RUN_TEST(test_dc_removed);
+  return UNITY_END();
+}
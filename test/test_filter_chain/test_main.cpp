@@ -0,0 +1,163 @@
+// ==================== test_filter_chain (fixed-point sample filters) ====================
+// pio test -e native -f test_filter_chain
+#include <Arduino.h>
+#include <unity.h>
+#include <math.h>
+#include "FilterChain.h"
+
+void setUp() {}
+void tearDown() {}
+
+namespace
+{
+constexpr double AMP = 1000; // codes, about mid-scale
+
+// Gain of the chain for a sine at f, from the output's peak-to-peak once
+// the filter has settled
+double gain(const FilterSettings &s, uint32_t fs, double f)
+{
+  static FilterChain chain;
+  chain.configure(s, fs);
+  constexpr size_t BLOCK = 4096;
+  static int16_t buf[BLOCK];
+  const uint32_t settle = fs / 4;
+  const uint32_t measure = max((uint32_t)(8 * fs / f), (uint32_t)BLOCK);
+  int lo = 0x7FFF, hi = -0x7FFF;
+  for (uint32_t at = 0; at < settle + measure; at += BLOCK)
+  {
+    for (size_t i = 0; i < BLOCK; ++i)
+      buf[i] = (int16_t)lround(ADC_MID + AMP * sin(2 * M_PI * f * (at + i) / fs));
+    chain.process(buf, BLOCK);
+    if (at < settle)
+      continue;
+    for (int16_t v : buf)
+    {
+      lo = min(lo, (int)v);
+      hi = max(hi, (int)v);
+    }
+  }
+  return (hi - lo) / (2 * AMP);
+}
+
+double gainDb(const FilterSettings &s, uint32_t fs, double f)
+{
+  return 20 * log10(gain(s, fs, f));
+}
+
+FilterSettings lowpass(uint32_t hz)
+{
+  FilterSettings s;
+  s.biquad = BIQUAD_LOWPASS;
+  s.biquadHz = hz; // default Q 0.7071: Butterworth
+  return s;
+}
+} // namespace
+
+// -------------------- pass-through --------------------
+// DC coupling with no filters leaves the codes untouched
+void test_defaults_pass_codes_through()
+{
+  FilterSettings s;
+  TEST_ASSERT_FALSE(s.dcBlock);
+  FilterChain chain;
+  chain.configure(s, 48000);
+  int16_t buf[256], ref[256];
+  for (int i = 0; i < 256; ++i)
+    buf[i] = ref[i] = (int16_t)((i * 997) % 4096);
+  chain.process(buf, 256);
+  TEST_ASSERT_EQUAL_INT16_ARRAY(ref, buf, 256);
+}
+
+// -------------------- biquad --------------------
+// Butterworth low-pass: -3.0 dB at its corner, at an ordinary rate and at
+// a corner of Fs/2000, where the Q2.30 coefficients earn their keep
+void test_lowpass_corner()
+{
+  TEST_ASSERT_FLOAT_WITHIN(0.1f, -3.0f, gainDb(lowpass(1000), 48000, 1000));
+  TEST_ASSERT_FLOAT_WITHIN(0.1f, -3.0f, gainDb(lowpass(250), 500000, 250));
+
+  TEST_ASSERT_FLOAT_WITHIN(0.02f, 1.0f, gain(lowpass(1000), 48000, 100));
+  TEST_ASSERT_TRUE(gainDb(lowpass(1000), 48000, 10000) < -40.0); // 2nd order: 40 dB a decade, or more near Fs/2
+}
+
+// Band-pass with Q 5: unity at the centre, 0.13 an octave either side
+void test_bandpass_q5()
+{
+  FilterSettings s;
+  s.biquad = BIQUAD_BANDPASS;
+  s.biquadHz = 1000;
+  s.biquadQ = 5.0f;
+  TEST_ASSERT_FLOAT_WITHIN(0.02f, 1.0f, gain(s, 48000, 1000));
+  TEST_ASSERT_FLOAT_WITHIN(0.01f, 0.13f, gain(s, 48000, 500));
+  TEST_ASSERT_FLOAT_WITHIN(0.01f, 0.13f, gain(s, 48000, 2000));
+}
+
+// -------------------- FIR --------------------
+// Windowed sinc: 0.5 at its corner, unity well inside the passband
+void test_fir_corner()
+{
+  FilterSettings s;
+  s.firHz = 4000;
+  TEST_ASSERT_FLOAT_WITHIN(0.02f, 0.5f, gain(s, 48000, 4000));
+  TEST_ASSERT_FLOAT_WITHIN(0.02f, 1.0f, gain(s, 48000, 1000));
+  TEST_ASSERT_FLOAT_WITHIN(0.01f, 0.0f, gain(s, 48000, 12000));
+}
+
+// -------------------- DC tracking --------------------
+// A 50 codes/s drift under a 440 Hz tone is tracked within 8 codes
+void test_dc_ramp_tracked()
+{
+  constexpr uint32_t FS = 20000;
+  FilterChain chain;
+  chain.configure(FilterSettings(), FS);
+  int16_t buf[1000];
+  double worst = 0;
+  for (int k = 0; k < 200; ++k) // 10 s, 1800 -> 2300
+  {
+    for (int i = 0; i < 1000; ++i)
+    {
+      const uint32_t n = k * 1000 + i;
+      const double dc = 1800 + 50.0 * n / FS;
+      buf[i] = (int16_t)lround(dc + 800 * sin(2 * M_PI * 440 * n / FS));
+    }
+    chain.process(buf, 1000);
+    const double truth = 1800 + 50.0 * (k + 1) * 1000 / FS;
+    if (k > 20) // past the first second, while the estimate catches up
+      worst = max(worst, fabs(chain.inputDC() - truth));
+  }
+  TEST_ASSERT_FLOAT_WITHIN(8.0f, 0.0f, worst);
+}
+
+// AC coupling takes the tracked DC off and re-centres on mid-scale
+void test_dc_block_recentres()
+{
+  FilterSettings s;
+  s.dcBlock = true;
+  FilterChain chain;
+  chain.configure(s, 48000);
+  TEST_ASSERT_EQUAL(ADC_MID, chain.outputDC());
+  int16_t buf[4800];
+  long sum = 0;
+  for (int k = 0; k < 30; ++k) // 3 s at a 1500-code offset
+  {
+    for (int i = 0; i < 4800; ++i)
+      buf[i] = (int16_t)lround(1500 + AMP * sin(2 * M_PI * 1000 * i / 48000));
+    chain.process(buf, 4800);
+  }
+  for (int16_t v : buf)
+    sum += v;
+  TEST_ASSERT_INT_WITHIN(2, 1500, chain.inputDC());
+  TEST_ASSERT_INT_WITHIN(4, ADC_MID, sum / 4800);
+}
+
+int main(int argc, char **argv)
+{
+  UNITY_BEGIN();
+  RUN_TEST(test_defaults_pass_codes_through);
+  RUN_TEST(test_lowpass_corner);
+  RUN_TEST(test_bandpass_q5);
+  RUN_TEST(test_fir_corner);
+  RUN_TEST(test_dc_ramp_tracked);
+  RUN_TEST(test_dc_block_recentres);
+  return UNITY_END();
+}
@@ -0,0 +1,182 @@
+// ==================== test_frame_queue (capture -> render hand-off) ====================
+// pio test -e native -f test_frame_queue
+//
+// A producer and a consumer std::thread hammer one queue, the consumer
+// slower so the queue overflows and drops the oldest frames all the time.
+#include <Arduino.h>
+#include <unity.h>
+#include <atomic>
+#include <thread>
+#include "FrameQueue.h"
+
+void setUp() {}
+void tearDown() {}
+
+namespace
+{
+// Enough that even a one-core host switches threads inside push() and pop()
+// many times over
+constexpr uint32_t FRAMES = 10000000;
+
+// Each frame is stamped throughout with its sequence number. users counts
+// the parties inside the buffer: anything but 1 while one of them is in it
+// means the producer and the consumer shared it.
+struct TestFrame
+{
+  uint32_t seq;
+  uint32_t stamp[61];
+  mutable std::atomic<int> users{0};
+};
+
+template <size_t DEPTH>
+struct Run
+{
+  FrameQueue<TestFrame, DEPTH> q;
+  std::atomic<bool> done{false};
+  std::atomic<uint32_t> shared{0};
+  uint32_t popped = 0;
+  uint32_t outOfOrder = 0;
+  uint32_t torn = 0;
+
+  void produce()
+  {
+    for (uint32_t seq = 1; seq <= FRAMES; ++seq)
+    {
+      TestFrame &f = q.writeFrame();
+      if (f.users.fetch_add(1) != 0)
+        shared++;
+      f.seq = seq;
+      for (uint32_t &w : f.stamp)
+        w = seq;
+      if (f.users.fetch_sub(1) != 1)
+        shared++;
+      q.push();
+    }
+    done.store(true);
+  }
+
+  void consume()
+  {
+    uint32_t last = 0;
+    for (;;)
+    {
+      const bool finished = done.load(); // before pop(), so nothing pushed after it is missed
+      const TestFrame *f = q.pop();
+      if (!f)
+      {
+        if (finished)
+          break;
+        std::this_thread::yield();
+        continue;
+      }
+      if (f->users.fetch_add(1) != 0)
+        shared++;
+      if (f->seq <= last)
+        outOfOrder++;
+      last = f->seq;
+      // A few passes: slower than the producer, and a longer window for a
+      // writer to show up in
+      for (int pass = 0; pass < 4; ++pass)
+        for (uint32_t w : f->stamp)
+          torn += w != f->seq;
+      if (f->users.fetch_sub(1) != 1)
+        shared++;
+      popped++;
+    }
+    q.release();
+  }
+
+  void run()
+  {
+    std::thread consumer([this] { consume(); });
+    std::thread producer([this] { produce(); });
+    producer.join();
+    consumer.join();
+  }
+};
+
+template <size_t DEPTH>
+void checkUnderOverflow()
+{
+  static Run<DEPTH> r;
+  r.run();
+  TEST_ASSERT_EQUAL(FRAMES, r.q.pushed());
+  TEST_ASSERT_EQUAL(r.q.pushed(), r.popped + r.q.dropped());
+  TEST_ASSERT_EQUAL(0, r.q.size());
+  TEST_ASSERT_EQUAL(0, r.outOfOrder);
+  TEST_ASSERT_EQUAL(0, r.torn);
+  TEST_ASSERT_EQUAL(0, r.shared.load());
+  TEST_ASSERT_GREATER_THAN(0, r.popped);
+  TEST_ASSERT_GREATER_THAN(0, r.q.dropped());
+}
+} // namespace
+
+// -------------------- single thread --------------------
+// Drop-oldest: a full queue gives up its oldest frame for the newest
+void test_drops_oldest_when_full()
+{
+  static FrameQueue<TestFrame, 3> q;
+  for (uint32_t seq = 1; seq <= 5; ++seq)
+  {
+    q.writeFrame().seq = seq;
+    q.push();
+  }
+  TEST_ASSERT_EQUAL(5, q.pushed());
+  TEST_ASSERT_EQUAL(2, q.dropped());
+  TEST_ASSERT_EQUAL(3, q.size());
+  for (uint32_t seq = 3; seq <= 5; ++seq)
+  {
+    const TestFrame *f = q.pop();
+    TEST_ASSERT_NOT_NULL(f);
+    TEST_ASSERT_EQUAL(seq, f->seq);
+  }
+  TEST_ASSERT_NULL(q.pop());
+}
+
+// The producer never writes into the frame the consumer holds
+void test_held_frame_not_reused()
+{
+  static FrameQueue<TestFrame, 2> q;
+  q.writeFrame().seq = 1;
+  q.push();
+  const TestFrame *held = q.pop();
+  TEST_ASSERT_NOT_NULL(held);
+  for (uint32_t seq = 2; seq < 50; ++seq)
+  {
+    TEST_ASSERT_TRUE(&q.writeFrame() != held);
+    q.writeFrame().seq = seq;
+    q.push();
+  }
+  TEST_ASSERT_EQUAL(1, held->seq);
+  q.drain();
+  TEST_ASSERT_EQUAL(0, q.size());
+}
+
+// -------------------- two threads --------------------
+// Sequence numbers arrive in order, every frame pushed is either popped or
+// counted as dropped, and no frame is read while it is being written
+void test_threads_depth_1()
+{
+  checkUnderOverflow<1>();
+}
+
+void test_threads_depth_2()
+{
+  checkUnderOverflow<2>();
+}
+
+void test_threads_depth_4()
+{
+  checkUnderOverflow<4>();
+}
+
+int main(int argc, char **argv)
+{
+  UNITY_BEGIN();
+  RUN_TEST(test_drops_oldest_when_full);
+  RUN_TEST(test_held_frame_not_reused);
+  RUN_TEST(test_threads_depth_1);
+  RUN_TEST(test_threads_depth_2);
+  RUN_TEST(test_threads_depth_4);
+  return UNITY_END();
+}
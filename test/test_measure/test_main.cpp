@@ -0,0 +1,129 @@
+// ==================== test_measure (running waveform measurements) ====================
+// pio test -e native -f test_measure
+#include <Arduino.h>
+#include <unity.h>
+#include <math.h>
+#include "Measure.h"
+
+void setUp() {}
+void tearDown() {}
+
+namespace
+{
+// n samples of a sine with the given period (in samples), continuing from `from`
+void sine(int16_t *s, size_t n, uint32_t from, double period, double amp, double mid = 2048)
+{
+  for (size_t i = 0; i < n; ++i)
+    s[i] = (int16_t)lround(mid + amp * sin(2 * M_PI * (from + i) / period));
+}
+} // namespace
+
+// Mean, AC RMS, min/max and period of a sine, a window at a time
+void test_sine_window()
+{
+  MeasureAccumulator acc;
+  static int16_t s[4000];
+  Measurements m{};
+  // The first window only sets the pivot and hysteresis the next one uses
+  for (uint32_t w = 0; w < 3; ++w)
+  {
+    sine(s, 4000, w * 4000, 100.0, 1000, 1500);
+    acc.add(s, 4000);
+    m = acc.take();
+  }
+  TEST_ASSERT_EQUAL(4000, m.samples);
+  TEST_ASSERT_EQUAL(500, m.min);
+  TEST_ASSERT_EQUAL(2500, m.max);
+  TEST_ASSERT_INT_WITHIN(64, 1500 * 256, m.meanQ8);               // within a quarter code
+  TEST_ASSERT_INT_WITHIN(128, lround(1000 / sqrt(2.0) * 256), m.rmsQ8); // 707.1 within half a code
+  TEST_ASSERT_INT_WITHIN(2, 100 * 256, m.periodQ8);
+}
+
+// Periods that are not a whole number of samples average out over the window
+void test_fractional_period()
+{
+  MeasureAccumulator acc;
+  static int16_t s[8000];
+  Measurements m{};
+  for (uint32_t w = 0; w < 3; ++w)
+  {
+    sine(s, 8000, w * 8000, 37.3, 800);
+    acc.add(s, 8000);
+    m = acc.take();
+  }
+  TEST_ASSERT_INT_WITHIN(26, lround(37.3 * 256), m.periodQ8); // 0.1 sample
+}
+
+// A period longer than a window is timed across windows, and kept through
+// the windows with no crossing in them. Once a cycle has set the level, the
+// partial cycle in each window does not move it, so every interval is whole.
+void test_period_spans_windows()
+{
+  MeasureAccumulator acc;
+  static int16_t s[300];
+  uint32_t at = 0;
+  Measurements m{};
+  for (int w = 0; w < 40; ++w, at += 300)
+  {
+    sine(s, 300, at, 1000.0, 1000);
+    acc.add(s, 300);
+    m = acc.take();
+    if (w >= 16) // two periods past the first crossing
+      TEST_ASSERT_INT_WITHIN(256, 1000 * 256, m.periodQ8);
+  }
+}
+
+// A square wave's RMS about its mean is half its swing
+void test_square_rms()
+{
+  MeasureAccumulator acc;
+  static int16_t s[1000];
+  for (int i = 0; i < 1000; ++i)
+    s[i] = (i % 50) < 25 ? 1000 : 3000;
+  acc.add(s, 1000);
+  acc.take();
+  acc.add(s, 1000);
+  const Measurements m = acc.take();
+  TEST_ASSERT_EQUAL(2000 * 256, m.meanQ8);
+  TEST_ASSERT_EQUAL(1000 * 256, m.rmsQ8);
+  TEST_ASSERT_EQUAL(50 * 256, m.periodQ8);
+}
+
+// A flat line has no period; restart() forgets the old one
+void test_no_period_without_crossings()
+{
+  MeasureAccumulator acc;
+  static int16_t s[1000];
+  sine(s, 1000, 0, 50.0, 1000);
+  acc.add(s, 1000);
+  acc.take();
+  acc.add(s, 1000);
+  TEST_ASSERT_TRUE(acc.take().periodQ8 != 0);
+
+  acc.restart();
+  for (int16_t &v : s)
+    v = 2048;
+  acc.add(s, 1000);
+  const Measurements m = acc.take();
+  TEST_ASSERT_EQUAL(0, m.periodQ8);
+  TEST_ASSERT_EQUAL(0, m.rmsQ8);
+  TEST_ASSERT_EQUAL(2048 * 256, m.meanQ8);
+}
+
+void test_empty_window()
+{
+  MeasureAccumulator acc;
+  TEST_ASSERT_EQUAL(0, acc.take().samples);
+}
+
+int main(int argc, char **argv)
+{
+  UNITY_BEGIN();
+  RUN_TEST(test_sine_window);
+  RUN_TEST(test_fractional_period);
+  RUN_TEST(test_period_spans_windows);
+  RUN_TEST(test_square_rms);
+  RUN_TEST(test_no_period_without_crossings);
+  RUN_TEST(test_empty_window);
+  return UNITY_END();
+}
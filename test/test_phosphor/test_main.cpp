@@ -0,0 +1,132 @@
+// ==================== test_phosphor (intensity-graded persistence) ====================
+// pio test -e native -f test_phosphor
+#include <Arduino.h>
+#include <unity.h>
+#include "Phosphor.h"
+
+void setUp() {}
+void tearDown() {}
+
+namespace
+{
+Phosphor gPh;
+uint8_t gRef[PLOT_H][PLOT_W];
+int16_t gTop[PLOT_W], gBot[PLOT_W];
+
+// Spans of 1..5 rows walking down the plot, so neighbouring bytes of a
+// word hold different counts
+void spans()
+{
+  for (int x = 0; x < PLOT_W; ++x)
+  {
+    gTop[x] = (int16_t)(PLOT_Y0 + (x * 7) % PLOT_H);
+    gBot[x] = (int16_t)(gTop[x] + x % 5);
+  }
+}
+
+// One decay step of one count, the plain way
+uint8_t decayed(uint8_t v, uint8_t shift)
+{
+  v -= v >> shift;
+  return v ? v - 1 : 0;
+}
+} // namespace
+
+// Hits add HIT per frame and saturate at 255
+void test_hits_saturate()
+{
+  TEST_ASSERT_TRUE(gPh.allocate());
+  gPh.clear();
+  spans();
+  for (int k = 1; k <= 5; ++k)
+  {
+    gPh.addSpans(gTop, gBot);
+    const int expect = min(k * Phosphor::HIT, 255);
+    TEST_ASSERT_EQUAL(expect, gPh.row(gTop[0] - PLOT_Y0)[0]);
+    TEST_ASSERT_EQUAL(expect, gPh.row(gBot[4] - PLOT_Y0)[4]);
+  }
+  TEST_ASSERT_EQUAL(0, gPh.row(gBot[4] - PLOT_Y0 + 1)[4]);
+}
+
+// Four counts a word decay exactly as one byte at a time would, at every
+// shift, down to dark; a band is lit while any count in it is
+void test_decay_matches_bytewise()
+{
+  TEST_ASSERT_TRUE(gPh.allocate());
+  spans();
+  for (uint8_t shift = Phosphor::DECAY_MIN; shift <= Phosphor::DECAY_MAX; ++shift)
+  {
+    gPh.clear();
+    gPh.setDecay(shift);
+    // 1..4 hits by column: 64, 128, 192 and 255 side by side
+    for (int k = 0; k < 4; ++k)
+    {
+      for (int x = 0; x < PLOT_W; ++x)
+        if (x % 4 < k)
+          gTop[x] = PLOT_Y0 + PLOT_H; // off the plot: no hit this frame
+      gPh.addSpans(gTop, gBot);
+      spans();
+    }
+    for (int y = 0; y < PLOT_H; ++y)
+      memcpy(gRef[y], gPh.row(y), PLOT_W);
+
+    int frames = 0;
+    for (bool any = true; any; ++frames)
+    {
+      TEST_ASSERT_LESS_THAN(600, frames);
+      gPh.decay();
+      any = false;
+      for (int b = 0; b < BandCompositor::BAND_COUNT; ++b)
+      {
+        bool lit = false;
+        for (int y = b * BandCompositor::BAND_ROWS; y < min((b + 1) * BandCompositor::BAND_ROWS, PLOT_H); ++y)
+        {
+          for (int x = 0; x < PLOT_W; ++x)
+          {
+            gRef[y][x] = decayed(gRef[y][x], shift);
+            lit |= gRef[y][x] != 0;
+            if (gPh.row(y)[x] != gRef[y][x])
+            {
+              char at[64];
+              snprintf(at, sizeof(at), "shift %u frame %d x %d y %d", shift, frames, x, y);
+              TEST_ASSERT_EQUAL_INT_MESSAGE(gRef[y][x], gPh.row(y)[x], at);
+            }
+          }
+        }
+        TEST_ASSERT_EQUAL(lit, gPh.bandLit(b));
+        any |= lit;
+      }
+    }
+    // decay=1 fades within a few frames, decay=6 keeps a trace for a hundred or more
+    if (shift == Phosphor::DECAY_MIN)
+      TEST_ASSERT_LESS_OR_EQUAL(8, frames);
+    if (shift == Phosphor::DECAY_MAX)
+      TEST_ASSERT_GREATER_OR_EQUAL(100, frames);
+  }
+}
+
+// Points off the plot are dropped
+void test_points_clip()
+{
+  TEST_ASSERT_TRUE(gPh.allocate());
+  gPh.clear();
+  const int16_t xs[] = {PLOT_X0 - 1, PLOT_X0, PLOT_X0 + PLOT_W - 1, PLOT_X0 + PLOT_W, PLOT_X0};
+  const int16_t ys[] = {PLOT_Y0, PLOT_Y0, PLOT_Y0 + PLOT_H - 1, PLOT_Y0, PLOT_Y0 + PLOT_H};
+  gPh.addPoints(xs, ys, 5);
+  TEST_ASSERT_EQUAL(Phosphor::HIT, gPh.row(0)[0]);
+  TEST_ASSERT_EQUAL(Phosphor::HIT, gPh.row(PLOT_H - 1)[PLOT_W - 1]);
+  int lit = 0;
+  for (int y = 0; y < PLOT_H; ++y)
+    for (int x = 0; x < PLOT_W; ++x)
+      lit += gPh.row(y)[x] != 0;
+  TEST_ASSERT_EQUAL(2, lit);
+}
+
+int main(int argc, char **argv)
+{
+  UNITY_BEGIN();
+  RUN_TEST(test_hits_saturate);
+  RUN_TEST(test_decay_matches_bytewise);
+  RUN_TEST(test_points_clip);
+  return UNITY_END();
+}
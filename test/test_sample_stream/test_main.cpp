@@ -0,0 +1,191 @@
+// ==================== test_sample_stream (COBS/CRC sample packets) ====================
+// pio test -e native -f test_sample_stream
+#include <Arduino.h>
+#include <unity.h>
+#include "SampleStream.h"
+
+void setUp() {}
+void tearDown() {}
+
+namespace
+{
+constexpr uint32_t FS = 48000;
+
+struct Link
+{
+  SampleStreamEncoder enc;
+  SampleStreamDecoder dec;
+  uint8_t frame[STREAM_FRAME_MAX];
+  size_t len = 0;
+
+  void encode(const int16_t *s, uint16_t n) { len = enc.encode(s, n, FS, frame); }
+
+  // Feeds the frame; returns how many packets came out of it
+  int deliver()
+  {
+    int packets = 0;
+    for (size_t i = 0; i < len; ++i)
+      packets += dec.push(frame[i]);
+    return packets;
+  }
+};
+
+// Codes across the 12-bit range, with zeros so COBS has bytes to stuff
+void pattern(int16_t *s, uint16_t n, int salt)
+{
+  for (uint16_t i = 0; i < n; ++i)
+    s[i] = (int16_t)(i % 7 == 0 ? 0 : (i * 1361 + salt * 97) & 0xFFF);
+}
+} // namespace
+
+// -------------------- round trip --------------------
+void test_round_trip()
+{
+  Link l;
+  int16_t s[STREAM_MAX_SAMPLES];
+  for (uint16_t n : {STREAM_MAX_SAMPLES, (uint16_t)77, (uint16_t)1})
+  {
+    pattern(s, n, n);
+    l.encode(s, n);
+    TEST_ASSERT_TRUE(l.len <= STREAM_FRAME_MAX);
+    TEST_ASSERT_EQUAL(0, l.frame[l.len - 1]); // the delimiter, and the only zero
+    for (size_t i = 0; i + 1 < l.len; ++i)
+      TEST_ASSERT_TRUE(l.frame[i] != 0);
+
+    TEST_ASSERT_EQUAL(1, l.deliver());
+    const StreamPacket &p = l.dec.packet();
+    TEST_ASSERT_EQUAL(n, p.count);
+    TEST_ASSERT_EQUAL(FS, p.fs);
+    TEST_ASSERT_EQUAL_INT16_ARRAY(s, p.samples, n);
+  }
+  const StreamCounters &c = l.dec.counters();
+  TEST_ASSERT_EQUAL(3, c.packets);
+  TEST_ASSERT_EQUAL(0, c.lost);
+  TEST_ASSERT_EQUAL(0, c.corrupt);
+  TEST_ASSERT_EQUAL(1, c.discontinuities); // only the first packet is marked
+}
+
+// An all-zero packet is the worst case for COBS
+void test_all_zero_samples()
+{
+  Link l;
+  int16_t s[STREAM_MAX_SAMPLES] = {};
+  l.encode(s, STREAM_MAX_SAMPLES);
+  TEST_ASSERT_EQUAL(1, l.deliver());
+  TEST_ASSERT_EQUAL_INT16_ARRAY(s, l.dec.packet().samples, STREAM_MAX_SAMPLES);
+}
+
+// -------------------- damage --------------------
+// A flipped bit anywhere in a frame fails its CRC; the packet counts as
+// corrupt and lost, and the next one decodes
+void test_corruption_detected()
+{
+  int16_t s[STREAM_MAX_SAMPLES];
+  pattern(s, 90, 1);
+  Link ref;
+  ref.encode(s, 90);
+
+  for (size_t at = 0; at + 1 < ref.len; ++at)
+  {
+    for (uint8_t bit : {0x01, 0x10, 0x80})
+    {
+      Link l;
+      l.encode(s, 90);
+      TEST_ASSERT_EQUAL(1, l.deliver());
+      l.encode(s, 90);
+      if (!(l.frame[at] ^ bit))
+        continue; // would split the frame in two instead
+      l.frame[at] ^= bit;
+      TEST_ASSERT_EQUAL(0, l.deliver());
+      l.encode(s, 90);
+      TEST_ASSERT_EQUAL(1, l.deliver());
+
+      const StreamCounters &c = l.dec.counters();
+      TEST_ASSERT_EQUAL(2, c.packets);
+      TEST_ASSERT_EQUAL(1, c.corrupt);
+      TEST_ASSERT_EQUAL(1, c.lost);
+      TEST_ASSERT_EQUAL_INT16_ARRAY(s, l.dec.packet().samples, 90);
+    }
+  }
+}
+
+// Text between frames spoils only the frame it runs into; a lost
+// delimiter costs both frames it joined
+void test_resync_after_noise()
+{
+  int16_t s[STREAM_MAX_SAMPLES];
+  pattern(s, 64, 2);
+  Link l;
+  const char *text = "Fs set 48000 Hz\r\n";
+  for (const char *c = text; *c; ++c)
+    TEST_ASSERT_FALSE(l.dec.push((uint8_t)*c));
+  l.encode(s, 64);
+  TEST_ASSERT_EQUAL(0, l.deliver());
+  l.encode(s, 64);
+  TEST_ASSERT_EQUAL(1, l.deliver());
+
+  l.encode(s, 64);
+  l.len--; // delimiter lost
+  TEST_ASSERT_EQUAL(0, l.deliver());
+  l.encode(s, 64);
+  TEST_ASSERT_EQUAL(0, l.deliver());
+  l.encode(s, 64);
+  TEST_ASSERT_EQUAL(1, l.deliver());
+
+  const StreamCounters &c = l.dec.counters();
+  TEST_ASSERT_EQUAL(2, c.packets);
+  TEST_ASSERT_EQUAL(2, c.corrupt);
+  TEST_ASSERT_EQUAL(2, c.lost); // counted from the first good packet
+}
+
+// -------------------- sequence --------------------
+// Skipped sequence numbers count as lost; a discontinuity marks one packet
+void test_skips_and_discontinuities()
+{
+  int16_t s[8];
+  pattern(s, 8, 3);
+  Link l;
+  l.encode(s, 8);
+  l.deliver();
+  l.enc.skip();
+  l.enc.skip();
+  l.encode(s, 8);
+  TEST_ASSERT_EQUAL(1, l.deliver());
+  TEST_ASSERT_EQUAL(3, l.dec.packet().seq);
+  TEST_ASSERT_EQUAL(0, l.dec.packet().flags & STREAM_FLAG_DISCONTINUITY);
+
+  l.enc.markDiscontinuity();
+  l.encode(s, 8);
+  l.deliver();
+  TEST_ASSERT_TRUE(l.dec.packet().flags & STREAM_FLAG_DISCONTINUITY);
+  l.encode(s, 8);
+  l.deliver();
+  TEST_ASSERT_FALSE(l.dec.packet().flags & STREAM_FLAG_DISCONTINUITY);
+
+  const StreamCounters &c = l.dec.counters();
+  TEST_ASSERT_EQUAL(4, c.packets);
+  TEST_ASSERT_EQUAL(2, c.lost);
+  TEST_ASSERT_EQUAL(2, c.discontinuities);
+}
+
+// -------------------- CRC --------------------
+// CRC-16/CCITT-FALSE check value
+void test_crc_check_value()
+{
+  uint16_t crc = 0xFFFF;
+  for (const char *c = "123456789"; *c; ++c)
+    crc = crc16Ccitt(crc, (uint8_t)*c);
+  TEST_ASSERT_EQUAL_UINT16(0x29B1, crc);
+}
+
+int main(int argc, char **argv)
+{
+  UNITY_BEGIN();
+  RUN_TEST(test_round_trip);
+  RUN_TEST(test_all_zero_samples);
+  RUN_TEST(test_corruption_detected);
+  RUN_TEST(test_resync_after_noise);
+  RUN_TEST(test_skips_and_discontinuities);
+  RUN_TEST(test_crc_check_value);
+  return UNITY_END();
+}
@@ -0,0 +1,200 @@
+// ==================== test_trigger (edge trigger with pre-trigger history) ====================
+// pio test -e native -f test_trigger
+#include <Arduino.h>
+#include <unity.h>
+#include "Trigger.h"
+
+void setUp() {}
+void tearDown() {}
+
+namespace
+{
+constexpr uint16_t FRAME = 100;
+constexpr uint32_t FS = 1000;
+
+TriggerSettings settings(TriggerMode mode, uint8_t prePct)
+{
+  TriggerSettings s;
+  s.mode = mode;
+  s.edge = EDGE_RISING;
+  s.level = 2048;
+  s.hysteresis = 32;
+  s.preTriggerPct = prePct;
+  return s;
+}
+
+// Feeds n samples in chunks until a frame is ready; returns how many were consumed.
+size_t feedUntilReady(TriggerEngine &t, const int16_t *s, size_t n, size_t chunk = 64)
+{
+  size_t used = 0;
+  while (used < n)
+  {
+    const size_t len = used + chunk <= n ? chunk : n - used;
+    size_t consumed = 0;
+    const bool ready = t.feed(s + used, len, &consumed);
+    used += consumed;
+    if (ready)
+      return used;
+    if (consumed < len)
+      break; // holding
+  }
+  return used;
+}
+
+// A square wave: low for half a period, then high, starting low
+void squareWave(int16_t *s, size_t n, size_t period)
+{
+  for (size_t i = 0; i < n; ++i)
+    s[i] = (i % period) < period / 2 ? 1000 : 3000;
+}
+} // namespace
+
+// -------------------- pre-trigger --------------------
+// The trigger sample lands preTriggerPct into the frame, with the samples
+// before it taken from history
+void test_pre_trigger_placement()
+{
+  static int16_t ramp[1000];
+  for (int i = 0; i < 1000; ++i)
+    ramp[i] = (int16_t)(4 * i); // crosses 2048 at 512
+
+  for (uint8_t pct : {0, 25, 50, 99})
+  {
+    TriggerEngine t;
+    t.configure(settings(TRIG_NORMAL, pct), FRAME, FS);
+    const uint16_t pre = t.preTriggerSamples();
+    TEST_ASSERT_EQUAL(pct, pre); // FRAME is 100, so a percent is a sample
+
+    const size_t used = feedUntilReady(t, ramp, 1000);
+    // Nothing past the frame's last sample is taken
+    TEST_ASSERT_EQUAL(512 + (FRAME - pre), used);
+
+    int16_t frame[FRAME];
+    t.extract(frame);
+    TEST_ASSERT_TRUE(t.lastWasTriggered());
+    TEST_ASSERT_EQUAL(2048, frame[pre]);
+    for (uint16_t k = 0; k < FRAME; ++k)
+      TEST_ASSERT_EQUAL(ramp[512 - pre + k], frame[k]);
+  }
+}
+
+// The second channel is cut from the same instants
+void test_second_channel_follows()
+{
+  static int16_t a[1000], b[1000];
+  for (int i = 0; i < 1000; ++i)
+  {
+    a[i] = (int16_t)(4 * i);
+    b[i] = (int16_t)(-i);
+  }
+  TriggerEngine t;
+  t.configure(settings(TRIG_NORMAL, 50), FRAME, FS);
+  size_t consumed = 0;
+  TEST_ASSERT_TRUE(t.feed(a, 1000, &consumed, b));
+  int16_t fa[FRAME], fb[FRAME];
+  t.extract(fa, fb);
+  for (uint16_t k = 0; k < FRAME; ++k)
+    TEST_ASSERT_EQUAL(-(fa[k] / 4), fb[k]);
+}
+
+// A frame never starts before the history has pre-trigger samples in it
+void test_early_edge_waits_for_history()
+{
+  static int16_t s[400];
+  squareWave(s, 400, 20); // first rising edge at 10
+  TriggerEngine t;
+  t.configure(settings(TRIG_NORMAL, 50), FRAME, FS);
+  const size_t used = feedUntilReady(t, s, 400);
+  int16_t frame[FRAME];
+  t.extract(frame);
+  // Edges before 50 samples of history are passed over, and the one at 50
+  // comes before the signal was seen low: the frame is cut around 70
+  TEST_ASSERT_EQUAL(70 + 50, used);
+  TEST_ASSERT_EQUAL(1000, frame[49]);
+  TEST_ASSERT_EQUAL(3000, frame[50]);
+}
+
+// -------------------- modes --------------------
+void test_auto_free_runs_after_timeout()
+{
+  static int16_t flat[1000];
+  for (int16_t &v : flat)
+    v = 1000;
+  TriggerEngine t;
+  t.configure(settings(TRIG_AUTO, 50), FRAME, FS);
+  // 100 ms at 1 kHz is 100 samples, but never less than two frames; the
+  // frame is then cut around the sample that timed out
+  const size_t used = feedUntilReady(t, flat, 1000);
+  TEST_ASSERT_EQUAL(2 * FRAME + 50, used);
+  int16_t frame[FRAME];
+  t.extract(frame);
+  TEST_ASSERT_FALSE(t.lastWasTriggered());
+
+  TriggerEngine n;
+  n.configure(settings(TRIG_NORMAL, 50), FRAME, FS);
+  TEST_ASSERT_EQUAL(1000, feedUntilReady(n, flat, 1000));
+}
+
+// One triggered frame, then nothing until re-armed; losing the history
+// does not release the hold
+void test_single_shot_holds()
+{
+  static int16_t s[2000];
+  squareWave(s, 2000, 40);
+  TriggerEngine t;
+  t.configure(settings(TRIG_SINGLE, 50), FRAME, FS);
+
+  size_t consumed = 0;
+  TEST_ASSERT_TRUE(t.feed(s, 2000, &consumed));
+  int16_t frame[FRAME];
+  t.extract(frame);
+  TEST_ASSERT_TRUE(t.lastWasTriggered());
+  TEST_ASSERT_TRUE(t.holding());
+
+  TEST_ASSERT_FALSE(t.feed(s, 2000, &consumed));
+  TEST_ASSERT_EQUAL(0, consumed);
+
+  t.discardHistory();
+  TEST_ASSERT_TRUE(t.holding());
+  TEST_ASSERT_FALSE(t.feed(s, 2000, &consumed));
+  TEST_ASSERT_EQUAL(0, consumed);
+
+  t.arm();
+  TEST_ASSERT_FALSE(t.holding());
+  TEST_ASSERT_TRUE(t.feed(s, 2000, &consumed));
+  t.extract(frame);
+  TEST_ASSERT_TRUE(t.holding());
+}
+
+// Auto and normal re-arm after every frame; discarding history restarts the search
+void test_discard_history_rearms()
+{
+  static int16_t s[2000];
+  squareWave(s, 2000, 40);
+  TriggerEngine t;
+  t.configure(settings(TRIG_NORMAL, 50), FRAME, FS);
+  size_t consumed = 0;
+  TEST_ASSERT_TRUE(t.feed(s, 2000, &consumed));
+  int16_t frame[FRAME];
+  t.extract(frame);
+  TEST_ASSERT_FALSE(t.holding());
+
+  t.discardHistory();
+  const size_t used = feedUntilReady(t, s, 2000);
+  t.extract(frame);
+  TEST_ASSERT_TRUE(t.lastWasTriggered());
+  TEST_ASSERT_EQUAL(60 + 50, used); // first edge with 50 samples of history behind it
+  TEST_ASSERT_EQUAL(3000, frame[50]);
+}
+
+int main(int argc, char **argv)
+{
+  UNITY_BEGIN();
+  RUN_TEST(test_pre_trigger_placement);
+  RUN_TEST(test_second_channel_follows);
+  RUN_TEST(test_early_edge_waits_for_history);
+  RUN_TEST(test_auto_free_runs_after_timeout);
+  RUN_TEST(test_single_shot_holds);
+  RUN_TEST(test_discard_history_rearms);
+  return UNITY_END();
+}